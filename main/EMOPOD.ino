@@ -3,7 +3,7 @@
  * Main Arduino Sketch
  * 
  * This sketch controls all sensors and actuators for the EMOPOD project:
- * - Pulse Sensor (MAX30102)
+ * - Pulse Oximeter (MAX30100)
  * - GSR Sensor
  * - Temperature Sensor (DS18B20)
  * - CO2 Sensor (SCD30)
@@ -25,12 +25,11 @@
 #include <OneWire.h>
 #include <DallasTemperature.h>
 #include <Adafruit_NeoPixel.h>
-#include <MAX30105.h>
-#include <heartRate.h>
 #include <SparkFun_SCD30_Arduino_Library.h>
 #include "sensors/SensorManager.h"
 #include "models/EmotionModel.h"
 #include "network/NetworkManager.h"
+#include "utils/TaskPipeline.h"
 
 // WiFi credentials
 const char* WIFI_SSID = "your_wifi_ssid";
@@ -48,9 +47,28 @@ const unsigned long SENSOR_READ_INTERVAL = 1000; // 1 second
 unsigned long lastDataSendTime = 0;
 const unsigned long DATA_SEND_INTERVAL = 5000; // 5 seconds
 
-// Sensor objects
-Adafruit_MPU6050 mpu;
-MAX30105 particleSensor;
+// Acquisition and analysis run as separate tasks on separate cores. The
+// acquisition task resamples every field onto one timeline, one frame per
+// FRAME_INTERVAL and ALIGNMENT_DELAY behind real time so slow fields can be
+// interpolated; the queue holds 6.4 s of frames, longer than one HTTP timeout.
+struct SensorFrame {
+  unsigned long timestamp;  // the instant every field was resampled to
+  uint16_t freshFields; // SensorManager::FreshField bits since the previous frame
+  SensorManager::SensorData data;
+  uint16_t ages[SensorManager::ALIGNED_FIELD_COUNT]; // ms since each field was sampled
+};
+
+const unsigned long FRAME_INTERVAL = 100; // ms
+const int FRAME_QUEUE_DEPTH = 64;
+Emopod::Utils::TaskPipeline<SensorFrame, FRAME_QUEUE_DEPTH> pipeline;
+
+unsigned long lastFrameTime = 0;          // acquisition task only
+unsigned long lastSchedulerStatsTime = 0; // acquisition task only
+SensorFrame latestFrame;                  // analysis task only
+bool hasFrame = false;                    // analysis task only
+
+// Sensor objects; the MPU6050 and MAX30100 belong to SensorManager, which
+// runs their FIFOs
 SCD30 airSensor;
 OneWire oneWire(4); // DS18B20 on pin 4
 DallasTemperature tempSensor(&oneWire);
@@ -94,22 +112,75 @@ void setup() {
   pixels.begin();
   pixels.show();
   
+  // Hand sampling and analysis to their own tasks
+  if (!pipeline.begin(acquireFrame, receiveFrame, analysisTick, nullptr)) {
+    Serial.println("[ERROR] Failed to start acquisition pipeline");
+    while (1);
+  }
+  
+  // From here on log calls only enqueue; the analysis task prints them
+  Emopod::Utils::Logger::setMode(Emopod::Utils::Logger::DEFERRED);
+  
   Serial.println("\n[EMOPOD] Initialization complete");
 }
 
 void loop() {
+  // All work runs in the pipeline tasks
+  vTaskDelete(NULL);
+}
+
+// Acquisition task: drain sensor FIFOs and capture buffers on every pass so
+// nothing overflows, and emit a frame every FRAME_INTERVAL
+bool acquireFrame(SensorFrame& frame, void* context) {
+  sensorManager.update();
+  
+  unsigned long currentMillis = millis();
+  
+  // Per-sensor jitter and overrun figures from the acquisition scheduler
+  if (currentMillis - lastSchedulerStatsTime >= DATA_SEND_INTERVAL) {
+    lastSchedulerStatsTime = currentMillis;
+    sensorManager.getScheduler().logStats();
+    LOG_INFO(SENSOR, "Sound meter load: %.3f%% of one core", sensorManager.getSoundMeterLoad() * 100);
+  }
+  
+  if (currentMillis - lastFrameTime < FRAME_INTERVAL) {
+    return false;
+  }
+  lastFrameTime = currentMillis;
+  
+  frame.timestamp = currentMillis - SensorManager::ALIGNMENT_DELAY;
+  frame.freshFields = sensorManager.takeFreshFields();
+  sensorManager.alignedSnapshot(frame.timestamp, frame.data, frame.ages);
+  return true;
+}
+
+// Analysis task: keep the newest frame
+void receiveFrame(const SensorFrame& frame, void* context) {
+  latestFrame = frame;
+  hasFrame = true;
+}
+
+// Analysis task: runs after every queue drain; a blocked upload here only
+// backs up the queue
+void analysisTick(void* context) {
   unsigned long currentMillis = millis();
   
   // Update network connection
   networkManager.update();
   
-  // Read sensors periodically
+  // Idle time: format and print deferred log messages
+  Emopod::Utils::Logger::drain();
+  
+  if (!hasFrame) {
+    return;
+  }
+  
+  // Analyze periodically
   if (currentMillis - lastSensorReadTime >= SENSOR_READ_INTERVAL) {
     lastSensorReadTime = currentMillis;
     
-    // Update sensor readings
-    sensorManager.update();
-    SensorManager::SensorData sensorData = sensorManager.readSensors();
+    const SensorManager::SensorData& sensorData = latestFrame.data;
+    SensorManager::printData(sensorData);
     
     // Analyze emotional state
     EmotionModel::EmotionState state = emotionModel.analyze({
@@ -118,10 +189,16 @@ void loop() {
       sensorData.temperature,
       sensorData.co2,
       sensorData.breathingRate,
-      sensorData.motion,
-      sensorData.motion,
-      sensorData.motion,
-      sensorData.soundLevel
+      sensorData.motionX,
+      sensorData.motionY,
+      sensorData.motionZ,
+      sensorData.soundLevel,
+      sensorData.rmssd,
+      sensorData.sdnn,
+      sensorData.pnn50,
+      sensorData.lfHfRatio,
+      sensorData.scrRate,
+      sensorData.scrAmplitude
     });
     
     // Print emotional state
@@ -148,23 +225,18 @@ void loop() {
   if (currentMillis - lastDataSendTime >= DATA_SEND_INTERVAL) {
     lastDataSendTime = currentMillis;
     
+    // Queue depth and drops between the two tasks
+    pipeline.logStats();
+    
     if (networkManager.isWiFiConnected()) {
       // Create JSON document
       StaticJsonDocument<512> doc;
       
-      // Add sensor data
-      SensorManager::SensorData data = sensorManager.readSensors();
-      doc["heartRate"] = data.heartRate;
-      doc["spO2"] = data.spO2;
-      doc["gsr"] = data.gsr;
-      doc["temperature"] = data.temperature;
-      doc["co2"] = data.co2;
-      doc["motion"] = data.motion;
-      doc["breathingRate"] = data.breathingRate;
-      doc["soundLevel"] = data.soundLevel;
+      // Add sensor data, one field per registered driver
+      SensorManager::serialize(latestFrame.data, doc);
       
-      // Add timestamp
-      doc["timestamp"] = millis();
+      // Add timestamp of the reading, not of the upload
+      doc["timestamp"] = latestFrame.timestamp;
       
       // Send data
       if (!networkManager.sendData(doc)) {
@@ -174,23 +246,11 @@ void loop() {
       Serial.println("[WARNING] Skipping data send - WiFi not connected");
     }
   }
-  
-  // Small delay to prevent watchdog reset
-  delay(10);
 }
 
 void initializeSensors() {
-  // Initialize MPU6050
-  if (!mpu.begin()) {
-    Serial.println("Failed to find MPU6050 chip");
-    while (1);
-  }
-  
-  // Initialize MAX30102
-  if (!particleSensor.begin(Wire, I2C_SPEED_FAST)) {
-    Serial.println("MAX30102 was not found. Please check wiring/power.");
-    while (1);
-  }
+  // The MPU6050 and MAX30100 are started by sensorManager.begin(); a second
+  // begin() here would reset the FIFOs it configured
   
   // Initialize SCD30
   if (!airSensor.begin()) {
@@ -206,16 +266,6 @@ void initializeSensors() {
 }
 
 void configureSensors() {
-  // Configure MPU6050
-  mpu.setAccelerometerRange(MPU6050_RANGE_8_G);
-  mpu.setGyroRange(MPU6050_RANGE_500_DEG);
-  mpu.setFilterBandwidth(MPU6050_BAND_21_HZ);
-  
-  // Configure MAX30102
-  particleSensor.setup();
-  particleSensor.setPulseAmplitudeRed(0x0A);
-  particleSensor.setPulseAmplitudeGreen(0);
-  
   // Configure SCD30
   airSensor.setMeasurementInterval(2);
   airSensor.setAutoSelfCalibration(true);
@@ -2,38 +2,83 @@
 #define EMOTION_MODEL_H
 
 #include <Arduino.h>
+#include "models/StressNetwork.h"
 
 /*
  * EmotionModel - Analyzes sensor data to determine emotional state
  * 
  * Input Parameters:
  * - Heart Rate (BPM): Normal range 60-100, elevated indicates stress
- * - GSR (microsiemens): Higher values indicate stress
+ * - GSR (microsiemens): Tonic skin conductance level, higher indicates stress
+ * - SCR rate (per minute), SCR amplitude (microsiemens): Phasic responses;
+ *   frequent or large responses indicate arousal
  * - Temperature (C): Normal range 36.5-37.5, elevated may indicate stress
  * - CO2 (ppm): Normal range 400-1000, higher values may affect mood
  * - Breathing Rate (BPM): Normal range 12-20, rapid breathing indicates stress
- * - Motion (accel/gyro): High movement indicates agitation
+ * - Motion (m/s^2): RMS linear acceleration per axis, gravity removed;
+ *   high movement indicates agitation
  * - Sound Level (dB): Elevated levels may indicate distress
+ * - RMSSD (ms): Beat-to-beat variability; low values indicate stress
+ * - SDNN (ms), pNN50 (%): Overall and vagal variability, for consumers
+ * - LF/HF ratio: Sympathetic balance, above ~2 indicates stress
+ * HRV inputs are NAN until enough clean beats are collected and are then
+ * left out of the score; so is any other NAN input.
+ *
+ * Each input adds weight * (excess over its threshold) / scale, with no
+ * branches, so analyzeBatch() scores struct-of-arrays input in loops the
+ * compiler vectorizes. analyze() runs the same per-frame code, so both
+ * give identical scores. Comparisons are the quiet kind (isgreater),
+ * which cannot trap and so can be vectorized under default math flags;
+ * sqrtf() may set errno, so motion magnitudes get a pass of their own.
+ *
+ * With the NETWORK classifier the state comes from the int8 network in
+ * src/models/StressNetwork.h instead, fed the same normalized excesses;
+ * scores stay the weighted sum.
  */
 class EmotionModel {
 private:
     // Thresholds for stress detection
-    const float STRESS_HR_THRESHOLD = 90.0;    // BPM
-    const float STRESS_GSR_THRESHOLD = 5.0;    // microsiemens
-    const float STRESS_TEMP_THRESHOLD = 37.5;  // C
-    const float STRESS_CO2_THRESHOLD = 1000.0; // ppm
-    const float STRESS_BREATH_THRESHOLD = 20.0; // BPM
-    const float STRESS_MOTION_THRESHOLD = 2.0;  // m/s^2
-    const float STRESS_SOUND_THRESHOLD = 70.0;  // dB
+    static constexpr float STRESS_HR_THRESHOLD = 90.0f;    // BPM
+    static constexpr float STRESS_GSR_THRESHOLD = 5.0f;    // microsiemens
+    static constexpr float STRESS_TEMP_THRESHOLD = 37.5f;  // C
+    static constexpr float STRESS_CO2_THRESHOLD = 1000.0f; // ppm
+    static constexpr float STRESS_BREATH_THRESHOLD = 20.0f; // BPM
+    static constexpr float STRESS_MOTION_THRESHOLD = 2.0f;  // m/s^2
+    static constexpr float STRESS_SOUND_THRESHOLD = 70.0f;  // dB
+    static constexpr float STRESS_RMSSD_THRESHOLD = 25.0f;  // ms, stress below
+    static constexpr float STRESS_LF_HF_THRESHOLD = 2.0f;
+    static constexpr float STRESS_SCR_RATE_THRESHOLD = 5.0f;      // per minute
+    static constexpr float STRESS_SCR_AMPLITUDE_THRESHOLD = 0.3f; // microsiemens
 
     // Weights for each parameter in stress calculation
-    const float HR_WEIGHT = 0.25;
-    const float GSR_WEIGHT = 0.20;
-    const float TEMP_WEIGHT = 0.15;
-    const float CO2_WEIGHT = 0.10;
-    const float BREATH_WEIGHT = 0.15;
-    const float MOTION_WEIGHT = 0.10;
-    const float SOUND_WEIGHT = 0.05;
+    static constexpr float HR_WEIGHT = 0.25f;
+    static constexpr float GSR_WEIGHT = 0.20f;
+    static constexpr float TEMP_WEIGHT = 0.15f;
+    static constexpr float CO2_WEIGHT = 0.10f;
+    static constexpr float BREATH_WEIGHT = 0.15f;
+    static constexpr float MOTION_WEIGHT = 0.10f;
+    static constexpr float SOUND_WEIGHT = 0.05f;
+    static constexpr float RMSSD_WEIGHT = 0.20f;
+    static constexpr float LF_HF_WEIGHT = 0.10f;
+    static constexpr float SCR_RATE_WEIGHT = 0.10f;
+    static constexpr float SCR_AMPLITUDE_WEIGHT = 0.05f;
+
+    // Score boundaries between states
+    static constexpr float MILD_STRESS_SCORE = 0.3f;
+    static constexpr float MODERATE_STRESS_SCORE = 0.5f;
+    static constexpr float HIGH_STRESS_SCORE = 0.7f;
+
+    // Frames scored per pass when the caller wants states only
+    static const int BATCH_CHUNK = 64;
+
+    // Network work bound, and cycles per inference before it counts as an
+    // overrun (100 us at 240 MHz). The budget is a monitoring threshold:
+    // an inference over it still completes and only increments
+    // getNetworkStats().overruns
+    static const int NETWORK_MAX_MACS = 1024;
+    static const uint32_t NETWORK_BUDGET_CYCLES = 24000;
+    static_assert(Emopod::Models::StressNetwork::MAC_COUNT <= NETWORK_MAX_MACS,
+                  "stress network over its latency budget");
 
 public:
     enum EmotionState {
@@ -44,6 +89,11 @@ public:
         UNKNOWN
     };
 
+    enum Classifier {
+        WEIGHTED_SUM,
+        NETWORK
+    };
+
     struct SensorData {
         float heartRate;
         float gsr;
@@ -54,65 +104,199 @@ public:
         float motionY;
         float motionZ;
         float soundLevel;
+        float rmssd;
+        float sdnn;
+        float pnn50;
+        float lfHfRatio;
+        float scrRate;
+        float scrAmplitude;
     };
 
-    EmotionModel() {}
+    // The same fields as one array each, for analyzeBatch()
+    struct SensorBatch {
+        const float* heartRate;
+        const float* gsr;
+        const float* temperature;
+        const float* co2;
+        const float* breathingRate;
+        const float* motionX;
+        const float* motionY;
+        const float* motionZ;
+        const float* soundLevel;
+        const float* rmssd;
+        const float* lfHfRatio;
+        const float* scrRate;
+        const float* scrAmplitude;
+    };
+
+private:
+    Classifier classifier;
+    Emopod::Models::StressNetwork network;
+
+public:
+    EmotionModel()
+        : classifier(WEIGHTED_SUM),
+          network(Emopod::Models::STRESS_INPUT, Emopod::Models::STRESS_LAYERS, NETWORK_BUDGET_CYCLES) {}
 
     EmotionState analyze(const SensorData& data) {
-        float stressScore = calculateStressScore(data);
-        
-        if (stressScore < 0.3) return CALM;
-        else if (stressScore < 0.5) return MILD_STRESS;
-        else if (stressScore < 0.7) return MODERATE_STRESS;
-        else return HIGH_STRESS;
+        if (classifier == NETWORK) {
+            return classifyNetwork(data.heartRate, data.gsr, data.temperature, data.co2,
+                                   data.breathingRate,
+                                   motionMagnitude(data.motionX, data.motionY, data.motionZ),
+                                   data.soundLevel, data.rmssd, data.lfHfRatio,
+                                   data.scrRate, data.scrAmplitude);
+        }
+        return classify(calculateStressScore(data));
     }
 
-private:
-    float calculateStressScore(const SensorData& data) {
-        float score = 0.0;
-        
-        // Heart Rate contribution
-        if (data.heartRate > STRESS_HR_THRESHOLD) {
-            score += HR_WEIGHT * (data.heartRate - STRESS_HR_THRESHOLD) / 20.0;
+    // Scores frames [0, count) of the batch; states gets one entry per
+    // frame and scores, when given, the 0..1 stress score. The network
+    // classifier skips the weighted sum unless scores are asked for
+    void analyzeBatch(const SensorBatch& batch, int count, EmotionState* states,
+                      float* scores = nullptr) {
+        if (classifier == WEIGHTED_SUM || scores != nullptr) {
+            float chunk[BATCH_CHUNK];
+            for (int start = 0; start < count; start += BATCH_CHUNK) {
+                float* out = scores != nullptr ? scores + start : chunk;
+                // A constant trip count lets -O2 vectorize without an epilogue
+                if (count - start >= BATCH_CHUNK) {
+                    scoreChunk(batch, start, BATCH_CHUNK, out, states + start);
+                } else {
+                    scoreChunk(batch, start, count - start, out, states + start);
+                }
+            }
         }
-        
-        // GSR contribution
-        if (data.gsr > STRESS_GSR_THRESHOLD) {
-            score += GSR_WEIGHT * (data.gsr - STRESS_GSR_THRESHOLD) / 5.0;
+        if (classifier == NETWORK) {
+            for (int i = 0; i < count; i++) {
+                states[i] = classifyNetwork(batch.heartRate[i], batch.gsr[i], batch.temperature[i],
+                                            batch.co2[i], batch.breathingRate[i],
+                                            motionMagnitude(batch.motionX[i], batch.motionY[i],
+                                                            batch.motionZ[i]),
+                                            batch.soundLevel[i], batch.rmssd[i], batch.lfHfRatio[i],
+                                            batch.scrRate[i], batch.scrAmplitude[i]);
+            }
         }
-        
-        // Temperature contribution
-        if (data.temperature > STRESS_TEMP_THRESHOLD) {
-            score += TEMP_WEIGHT * (data.temperature - STRESS_TEMP_THRESHOLD) / 0.5;
-        }
-        
-        // CO2 contribution
-        if (data.co2 > STRESS_CO2_THRESHOLD) {
-            score += CO2_WEIGHT * (data.co2 - STRESS_CO2_THRESHOLD) / 500.0;
+    }
+
+    void setClassifier(Classifier value) { classifier = value; }
+    Classifier getClassifier() const { return classifier; }
+
+    // Inference count, cycles and budget overruns
+    const Emopod::Models::StressNetwork::Stats& getNetworkStats() const { return network.getStats(); }
+    void resetNetworkStats() { network.resetStats(); }
+
+    // Cycles per inference counted as an overrun
+    static uint32_t getNetworkBudget() { return NETWORK_BUDGET_CYCLES; }
+
+private:
+    // weight * (x - threshold) / scale above the threshold, else 0; NAN
+    // compares false, so a missing input adds nothing. Weighting before the
+    // select keeps every operation unconditional
+    static float term(float weight, float x, float threshold, float scale) {
+        float e = weight * ((x - threshold) / scale);
+        return __builtin_isgreater(e, 0.0f) ? e : 0.0f;
+    }
+
+    // Motion contribution uses the magnitude
+    static float motionMagnitude(float x, float y, float z) {
+        return sqrtf(x * x + y * y + z * z);
+    }
+
+    static float stressScore(float heartRate, float gsr, float temperature, float co2,
+                             float breathingRate, float motion, float soundLevel,
+                             float rmssd, float lfHfRatio, float scrRate, float scrAmplitude) {
+        float score = term(HR_WEIGHT, heartRate, STRESS_HR_THRESHOLD, 20.0f);
+        score += term(GSR_WEIGHT, gsr, STRESS_GSR_THRESHOLD, 5.0f);
+        score += term(SCR_RATE_WEIGHT, scrRate, STRESS_SCR_RATE_THRESHOLD, 5.0f);
+        score += term(SCR_AMPLITUDE_WEIGHT, scrAmplitude, STRESS_SCR_AMPLITUDE_THRESHOLD, 0.5f);
+        score += term(TEMP_WEIGHT, temperature, STRESS_TEMP_THRESHOLD, 0.5f);
+        score += term(CO2_WEIGHT, co2, STRESS_CO2_THRESHOLD, 500.0f);
+        score += term(BREATH_WEIGHT, breathingRate, STRESS_BREATH_THRESHOLD, 10.0f);
+        score += term(MOTION_WEIGHT, motion, STRESS_MOTION_THRESHOLD, 2.0f);
+        score += term(SOUND_WEIGHT, soundLevel, STRESS_SOUND_THRESHOLD, 30.0f);
+
+        // HRV: low RMSSD and high LF/HF indicate stress
+        score += term(RMSSD_WEIGHT, -rmssd, -STRESS_RMSSD_THRESHOLD, STRESS_RMSSD_THRESHOLD);
+        score += term(LF_HF_WEIGHT, lfHfRatio, STRESS_LF_HF_THRESHOLD, 2.0f);
+
+        // Every term is >= 0
+        return __builtin_isless(score, 1.0f) ? score : 1.0f;
+    }
+
+    // Counts the boundaries the score reaches; the states are in order
+    static EmotionState classify(float score) {
+        return (EmotionState)(__builtin_isgreaterequal(score, MILD_STRESS_SCORE) +
+                              __builtin_isgreaterequal(score, MODERATE_STRESS_SCORE) +
+                              __builtin_isgreaterequal(score, HIGH_STRESS_SCORE));
+    }
+
+    static void scoreChunk(const SensorBatch& batch, int start, int n,
+                           float* __restrict out, EmotionState* __restrict state) {
+        float motion[BATCH_CHUNK];
+        const float* __restrict hr = batch.heartRate + start;
+        const float* __restrict gsr = batch.gsr + start;
+        const float* __restrict temperature = batch.temperature + start;
+        const float* __restrict co2 = batch.co2 + start;
+        const float* __restrict breathing = batch.breathingRate + start;
+        const float* __restrict motionX = batch.motionX + start;
+        const float* __restrict motionY = batch.motionY + start;
+        const float* __restrict motionZ = batch.motionZ + start;
+        const float* __restrict sound = batch.soundLevel + start;
+        const float* __restrict rmssd = batch.rmssd + start;
+        const float* __restrict lfHf = batch.lfHfRatio + start;
+        const float* __restrict scrRate = batch.scrRate + start;
+        const float* __restrict scrAmplitude = batch.scrAmplitude + start;
+        for (int i = 0; i < n; i++) {
+            motion[i] = motionMagnitude(motionX[i], motionY[i], motionZ[i]);
         }
-        
-        // Breathing Rate contribution
-        if (data.breathingRate > STRESS_BREATH_THRESHOLD) {
-            score += BREATH_WEIGHT * (data.breathingRate - STRESS_BREATH_THRESHOLD) / 10.0;
+        for (int i = 0; i < n; i++) {
+            out[i] = stressScore(hr[i], gsr[i], temperature[i], co2[i], breathing[i],
+                                 motion[i], sound[i], rmssd[i], lfHf[i],
+                                 scrRate[i], scrAmplitude[i]);
         }
-        
-        // Motion contribution (using magnitude)
-        float motionMagnitude = sqrt(
-            data.motionX * data.motionX + 
-            data.motionY * data.motionY + 
-            data.motionZ * data.motionZ
-        );
-        if (motionMagnitude > STRESS_MOTION_THRESHOLD) {
-            score += MOTION_WEIGHT * (motionMagnitude - STRESS_MOTION_THRESHOLD) / 2.0;
+        for (int i = 0; i < n; i++) {
+            state[i] = classify(out[i]);
         }
-        
-        // Sound Level contribution
-        if (data.soundLevel > STRESS_SOUND_THRESHOLD) {
-            score += SOUND_WEIGHT * (data.soundLevel - STRESS_SOUND_THRESHOLD) / 30.0;
+    }
+
+    // (x - threshold) / scale per feature; NAN is left to the network, which reads it as 0
+    static float normalize(float x, float threshold, float scale) {
+        return (x - threshold) / scale;
+    }
+
+    EmotionState classifyNetwork(float heartRate, float gsr, float temperature, float co2,
+                                 float breathingRate, float motion, float soundLevel,
+                                 float rmssd, float lfHfRatio, float scrRate, float scrAmplitude) {
+        using namespace Emopod::Models;
+        float features[STRESS_FEATURE_COUNT];
+        features[FEATURE_HEART_RATE] = normalize(heartRate, STRESS_HR_THRESHOLD, 20.0f);
+        features[FEATURE_GSR] = normalize(gsr, STRESS_GSR_THRESHOLD, 5.0f);
+        features[FEATURE_SCR_RATE] = normalize(scrRate, STRESS_SCR_RATE_THRESHOLD, 5.0f);
+        features[FEATURE_SCR_AMPLITUDE] = normalize(scrAmplitude, STRESS_SCR_AMPLITUDE_THRESHOLD, 0.5f);
+        features[FEATURE_TEMPERATURE] = normalize(temperature, STRESS_TEMP_THRESHOLD, 0.5f);
+        features[FEATURE_CO2] = normalize(co2, STRESS_CO2_THRESHOLD, 500.0f);
+        features[FEATURE_BREATHING_RATE] = normalize(breathingRate, STRESS_BREATH_THRESHOLD, 10.0f);
+        features[FEATURE_MOTION] = normalize(motion, STRESS_MOTION_THRESHOLD, 2.0f);
+        features[FEATURE_SOUND_LEVEL] = normalize(soundLevel, STRESS_SOUND_THRESHOLD, 30.0f);
+        features[FEATURE_RMSSD] = normalize(-rmssd, -STRESS_RMSSD_THRESHOLD, STRESS_RMSSD_THRESHOLD);
+        features[FEATURE_LF_HF_RATIO] = normalize(lfHfRatio, STRESS_LF_HF_THRESHOLD, 2.0f);
+
+        int8_t logits[STRESS_LOGITS];
+        network.infer(features, logits);
+        int32_t zero = network.getOutputQuantization().zeroPoint;
+        int state = 0;
+        for (int k = 0; k < STRESS_LOGITS; k++) {
+            state += logits[k] >= zero;
         }
-        
-        return constrain(score, 0.0, 1.0);
+        return (EmotionState)state;
+    }
+
+    float calculateStressScore(const SensorData& data) const {
+        return stressScore(data.heartRate, data.gsr, data.temperature, data.co2, data.breathingRate,
+                           motionMagnitude(data.motionX, data.motionY, data.motionZ),
+                           data.soundLevel, data.rmssd, data.lfHfRatio,
+                           data.scrRate, data.scrAmplitude);
     }
 };
 
-#endif 
\ No newline at end of file
+#endif
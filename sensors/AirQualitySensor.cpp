@@ -0,0 +1,37 @@
+#include "AirQualitySensor.h"
+
+bool AirQualitySensor::acquire(float& ppm) {
+    float value;
+    if (capture != nullptr && capture->isRunning()) {
+        // The gas level changes over minutes; the newest block stands for the period
+        bool fresh = false;
+        Emopod::Sensors::AdcBlock block;
+        while (capture->readBlock(Emopod::Sensors::ADC_CHANNEL_AIR, block)) {
+            fresh = true;
+        }
+        if (!fresh) {
+            return false;
+        }
+        value = toPpm(block.mean());
+    } else {
+        value = toPpm(analogRead(sensorPin));
+    }
+    if (isnan(value) || value <= 0) {
+        return false;
+    }
+    ppm = value;
+    return true;
+}
+
+float AirQualitySensor::toPpm(float raw) const {
+    float volts = raw * ADC_VOLTS / ADC_FULL_SCALE;
+    if (!(volts > 0)) {
+        return NAN;
+    }
+    // volts = SUPPLY * RLOAD / (RLOAD + Rs)
+    float resistance = RLOAD * (SUPPLY_VOLTS - volts) / volts;
+    if (!(resistance > 0)) {
+        return NAN;
+    }
+    return PARA * powf(resistance / RZERO, -PARB);
+}
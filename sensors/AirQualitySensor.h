@@ -0,0 +1,49 @@
+#ifndef AIR_QUALITY_SENSOR_H
+#define AIR_QUALITY_SENSOR_H
+
+#include <Arduino.h>
+#include "sensors/SensorDriver.h"
+#include "sensors/AdcCapture.h"
+
+// MQ135 gas sensor, reported as CO2-equivalent ppm. Its pin is on ADC1, so
+// while AdcCapture runs the readings come from captured blocks; analogRead()
+// is only used when capture is not running. Both go through toPpm(), so the
+// reading does not depend on which path produced it.
+class AirQualitySensor : public Emopod::Sensors::SensorDriver<AirQualitySensor, 10> {
+public:
+    static constexpr const char* NAME = "MQ135";
+    static constexpr const char* KEY = "co2";
+    static constexpr unsigned long PERIOD_MS = 2000;
+    static constexpr unsigned long COST_US = 300;
+    
+private:
+    friend class Emopod::Sensors::SensorDriver<AirQualitySensor, 10>;
+    
+    static constexpr float ADC_FULL_SCALE = 4095.0f;
+    static constexpr float ADC_VOLTS = 3.3f;
+    
+    // The module divides its 5 V supply between the sensor (Rs) and the
+    // load resistor, and the ADC reads the load side. RZERO and the CO2
+    // curve ppm = PARA * (Rs / RZERO)^-PARB are the MQ135 library's
+    static constexpr float SUPPLY_VOLTS = 5.0f;
+    static constexpr float RLOAD = 10.0f;        // kOhm
+    static constexpr float RZERO = 76.63f;       // kOhm in clean air
+    static constexpr float PARA = 116.6020682f;
+    static constexpr float PARB = 2.769034857f;
+    
+    int sensorPin;
+    Emopod::Sensors::AdcCapture* capture;
+    
+    void beginDevice() {}
+    bool acquire(float& ppm);
+    
+public:
+    // With a capture engine the driver consumes its blocks; otherwise it polls
+    AirQualitySensor(int pin, Emopod::Sensors::AdcCapture* adcCapture = nullptr)
+        : sensorPin(pin), capture(adcCapture) {}
+    
+    // Raw 12-bit count to ppm; NAN when the reading is out of range
+    float toPpm(float raw) const;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#include "AmbientTemperatureSensor.h"
+
+void AmbientTemperatureSensor::beginDevice() {
+    dht.begin();
+}
+
+bool AmbientTemperatureSensor::acquire(float& temperature) {
+    if (!dht.update()) {
+        return false;
+    }
+    dht.consumeValue();
+    
+    float value = dht.getTemperature();
+    if (isnan(value) || value <= 0 || value >= 50) {
+        return false;
+    }
+    temperature = value;
+    return true;
+}
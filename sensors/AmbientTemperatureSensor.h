@@ -0,0 +1,33 @@
+#ifndef AMBIENT_TEMPERATURE_SENSOR_H
+#define AMBIENT_TEMPERATURE_SENSOR_H
+
+#include <Arduino.h>
+#include "sensors/SensorDriver.h"
+#include "sensors/DhtReader.h"
+
+// DHT22 through the non-blocking DhtReader
+class AmbientTemperatureSensor : public Emopod::Sensors::SensorDriver<AmbientTemperatureSensor, 10> {
+public:
+    static constexpr const char* NAME = "DHT22";
+    static constexpr const char* KEY = "temperature";
+    static constexpr unsigned long PERIOD_MS = 2;     // advances the reader's state machine
+    static constexpr unsigned long COST_US = 100;
+    
+private:
+    friend class Emopod::Sensors::SensorDriver<AmbientTemperatureSensor, 10>;
+    
+    Emopod::Sensors::DhtReader dht;
+    
+    void beginDevice();
+    bool acquire(float& temperature);
+    
+public:
+    // intervalMs: time between DHT22 transactions (>= 2 s)
+    AmbientTemperatureSensor(int pin, unsigned long intervalMs = 2000)
+        : dht(pin, intervalMs) {}
+    
+    float getHumidity() const { return dht.getHumidity(); }
+    const Emopod::Sensors::DhtReader::Stats& getStats() const { return dht.getStats(); }
+};
+
+#endif
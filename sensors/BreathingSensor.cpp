@@ -1,47 +1,78 @@
 #include "BreathingSensor.h"
 
-void BreathingSensor::begin() {
-    pinMode(sensorPin, INPUT);
-    for (int i = 0; i < NUM_SAMPLES; i++) {
-        samples[i] = 0;
+void BreathingSensor::beginDevice() {
+    if (capture == nullptr) {
+        pinMode(sensorPin, INPUT);
+        estimator.configure(1000.0f / PERIOD_MS);
     }
 }
 
-float BreathingSensor::read() {
-    float currentValue = analogRead(sensorPin);
-    
-    // Detect peaks in breathing pattern
-    if (currentValue > lastValue && !rising) {
-        rising = true;
-    } else if (currentValue < lastValue && rising) {
-        rising = false;
-        peakCount++;
-        
-        // Calculate breathing rate (breaths per minute)
-        if (peakCount >= 2) {
-            unsigned long currentTime = millis();
-            unsigned long timeDiff = currentTime - lastPeakTime;
-            breathingRate = 60000.0 / timeDiff; // Convert to breaths per minute
-            lastPeakTime = currentTime;
-            peakCount = 0;
-            
-            // Update moving average
-            samples[sampleIndex] = breathingRate;
-            sampleIndex = (sampleIndex + 1) % NUM_SAMPLES;
-            
-            // Calculate average
-            breathingAverage = 0;
-            for (int i = 0; i < NUM_SAMPLES; i++) {
-                breathingAverage += samples[i];
+bool BreathingSensor::acquire(float& rate) {
+    if (capture == nullptr) {
+        if (source == SOURCE_SENSOR) {
+            addSample(analogRead(sensorPin));
+        }
+    } else {
+        // Always drain the channel so stale blocks do not pile up
+        Emopod::Sensors::AdcBlock block;
+        while (capture->readBlock(Emopod::Sensors::ADC_CHANNEL_BREATHING, block)) {
+            if (source == SOURCE_SENSOR) {
+                processBlock(block);
             }
-            breathingAverage /= NUM_SAMPLES;
         }
     }
     
-    lastValue = currentValue;
-    return breathingAverage;
+    // Only completed breaths produce a new rate
+    if (!newRate) {
+        return false;
+    }
+    newRate = false;
+    rate = estimator.getRate();
+    return true;
+}
+
+float BreathingSensor::read() {
+    sample();
+    return getValue();
+}
+
+void BreathingSensor::setSource(Source newSource) {
+    if (newSource != source) {
+        source = newSource;
+        estimator.reset();
+        newRate = false;
+    }
 }
 
-float BreathingSensor::getAverage() {
-    return breathingAverage;
-} 
\ No newline at end of file
+void BreathingSensor::addSample(float value) {
+    if (estimator.addSample(value)) {
+        newRate = true;
+    }
+}
+
+void BreathingSensor::processBlock(const Emopod::Sensors::AdcBlock& block) {
+    if (block.sampleRate == 0) {
+        return;
+    }
+    if (block.sampleRate != estimator.getInputRate()) {
+        estimator.configure(block.sampleRate);
+    }
+    
+    // Timing comes from the sample count at the block's rate, not millis(),
+    // so breaths keep their spacing no matter when the block is consumed
+    for (int i = 0; i < block.count; i++) {
+        addSample(block.samples[i]);
+    }
+}
+
+void BreathingSensor::addChestSamples(const float* values, int count, float sampleRate) {
+    if (source != SOURCE_CHEST_MOTION || sampleRate <= 0) {
+        return;
+    }
+    if (sampleRate != estimator.getInputRate()) {
+        estimator.configure(sampleRate);
+    }
+    for (int i = 0; i < count; i++) {
+        addSample(values[i]);
+    }
+}
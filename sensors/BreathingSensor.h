@@ -1,67 +1,55 @@
 #ifndef BREATHING_SENSOR_H
 #define BREATHING_SENSOR_H
 
-class BreathingSensor {
+#include <Arduino.h>
+#include "sensors/SensorDriver.h"
+#include "sensors/AdcCapture.h"
+#include "sensors/BreathingEstimator.h"
+
+// The estimator already averages the last few breaths, so the driver does not smooth again
+class BreathingSensor : public Emopod::Sensors::SensorDriver<BreathingSensor, 1> {
+public:
+    static constexpr const char* NAME = "Breathing";
+    static constexpr const char* KEY = "breathingRate";
+    static constexpr unsigned long PERIOD_MS = 100;
+    static constexpr unsigned long COST_US = 500;
+    
+    enum Source {
+        SOURCE_SENSOR,        // breathing belt on the ADC
+        SOURCE_CHEST_MOTION   // chest accelerometer axis via addChestSamples()
+    };
+    
 private:
+    friend class Emopod::Sensors::SensorDriver<BreathingSensor, 1>;
+    
     int sensorPin;
-    float breathingRate;
-    float breathingAverage;
-    const int NUM_SAMPLES = 10;
-    float samples[10];
-    int sampleIndex = 0;
-    unsigned long lastPeakTime = 0;
-    int peakCount = 0;
-    float lastValue = 0;
-    bool rising = false;
+    Emopod::Sensors::AdcCapture* capture;
+    Emopod::Sensors::BreathingEstimator estimator;
+    Source source;
+    bool newRate = false;
+    
+    void beginDevice();
+    bool acquire(float& rate);
+    void addSample(float value);
     
 public:
-    BreathingSensor(int pin) : sensorPin(pin) {}
+    // With a capture engine the driver consumes its blocks; otherwise it polls
+    BreathingSensor(int pin, Emopod::Sensors::AdcCapture* adcCapture = nullptr)
+        : sensorPin(pin), capture(adcCapture), source(SOURCE_SENSOR) {}
+    
+    float read();
+    
+    // Switching source restarts the estimate
+    void setSource(Source newSource);
+    Source getSource() const { return source; }
     
-    void begin() {
-        pinMode(sensorPin, INPUT);
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-            samples[i] = 0;
-        }
-    }
+    // Consume one block from AdcCapture at the block's own sample rate
+    void processBlock(const Emopod::Sensors::AdcBlock& block);
     
-    float read() {
-        float currentValue = analogRead(sensorPin);
-        
-        // Detect peaks in breathing pattern
-        if (currentValue > lastValue && !rising) {
-            rising = true;
-        } else if (currentValue < lastValue && rising) {
-            rising = false;
-            peakCount++;
-            
-            // Calculate breathing rate (breaths per minute)
-            if (peakCount >= 2) {
-                unsigned long currentTime = millis();
-                unsigned long timeDiff = currentTime - lastPeakTime;
-                breathingRate = 60000.0 / timeDiff; // Convert to breaths per minute
-                lastPeakTime = currentTime;
-                peakCount = 0;
-                
-                // Update moving average
-                samples[sampleIndex] = breathingRate;
-                sampleIndex = (sampleIndex + 1) % NUM_SAMPLES;
-                
-                // Calculate average
-                breathingAverage = 0;
-                for (int i = 0; i < NUM_SAMPLES; i++) {
-                    breathingAverage += samples[i];
-                }
-                breathingAverage /= NUM_SAMPLES;
-            }
-        }
-        
-        lastValue = currentValue;
-        return breathingAverage;
-    }
+    // Chest motion input: one accelerometer axis at sampleRate Hz
+    void addChestSamples(const float* values, int count, float sampleRate);
     
-    float getAverage() {
-        return breathingAverage;
-    }
+    const Emopod::Sensors::BreathingEstimator& getEstimator() const { return estimator; }
 };
 
-#endif 
\ No newline at end of file
+#endif 
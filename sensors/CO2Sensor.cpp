@@ -1,35 +1,22 @@
 #include "CO2Sensor.h"
 
-void CO2Sensor::begin() {
+void CO2Sensor::beginDevice() {
     sensor.begin();
     sensor.setMeasurementInterval(2);
     sensor.setAutoSelfCalibration(true);
-    for (int i = 0; i < NUM_SAMPLES; i++) {
-        samples[i] = 0;
-    }
 }
 
-float CO2Sensor::read() {
-    if (sensor.dataAvailable()) {
-        co2Value = sensor.getCO2();
-        
-        // Update moving average
-        samples[sampleIndex] = co2Value;
-        sampleIndex = (sampleIndex + 1) % NUM_SAMPLES;
-        
-        // Calculate average
-        co2Average = 0;
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-            co2Average += samples[i];
-        }
-        co2Average /= NUM_SAMPLES;
+bool CO2Sensor::acquire(float& co2) {
+    if (!sensor.dataAvailable()) {
+        return false;
     }
-    
-    return co2Average;
+    co2 = sensor.getCO2();
+    return true;
 }
 
-float CO2Sensor::getAverage() {
-    return co2Average;
+float CO2Sensor::read() {
+    sample();
+    return getValue();
 }
 
 float CO2Sensor::getHumidity() {
@@ -38,4 +25,4 @@ float CO2Sensor::getHumidity() {
 
 float CO2Sensor::getTemperature() {
     return sensor.getTemperature();
-} 
\ No newline at end of file
+} 
@@ -2,58 +2,29 @@
 #define CO2_SENSOR_H
 
 #include <SparkFun_SCD30_Arduino_Library.h>
+#include "sensors/SensorDriver.h"
 
-class CO2Sensor {
-private:
-    SCD30& sensor;
-    float co2Value;
-    float co2Average;
-    const int NUM_SAMPLES = 5;
-    float samples[5];
-    int sampleIndex = 0;
-    
+class CO2Sensor : public Emopod::Sensors::SensorDriver<CO2Sensor, 5> {
 public:
-    CO2Sensor(SCD30& sensorRef) : sensor(sensorRef) {}
+    static constexpr const char* NAME = "SCD30";
+    static constexpr const char* KEY = "co2";
+    static constexpr unsigned long PERIOD_MS = 500;   // new data every 2 s
+    static constexpr unsigned long COST_US = 2000;
     
-    void begin() {
-        sensor.begin();
-        sensor.setMeasurementInterval(2);
-        sensor.setAutoSelfCalibration(true);
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-            samples[i] = 0;
-        }
-    }
+private:
+    friend class Emopod::Sensors::SensorDriver<CO2Sensor, 5>;
     
-    float read() {
-        if (sensor.dataAvailable()) {
-            co2Value = sensor.getCO2();
-            
-            // Update moving average
-            samples[sampleIndex] = co2Value;
-            sampleIndex = (sampleIndex + 1) % NUM_SAMPLES;
-            
-            // Calculate average
-            co2Average = 0;
-            for (int i = 0; i < NUM_SAMPLES; i++) {
-                co2Average += samples[i];
-            }
-            co2Average /= NUM_SAMPLES;
-        }
-        
-        return co2Average;
-    }
+    SCD30& sensor;
     
-    float getAverage() {
-        return co2Average;
-    }
+    void beginDevice();
+    bool acquire(float& co2);
     
-    float getHumidity() {
-        return sensor.getHumidity();
-    }
+public:
+    CO2Sensor(SCD30& sensorRef) : sensor(sensorRef) {}
     
-    float getTemperature() {
-        return sensor.getTemperature();
-    }
+    float read();
+    float getHumidity();
+    float getTemperature();
 };
 
-#endif 
\ No newline at end of file
+#endif 
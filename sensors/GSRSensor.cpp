@@ -1,33 +1,73 @@
 #include "GSRSensor.h"
 
-void GSRSensor::begin() {
-    pinMode(sensorPin, INPUT);
-    for (int i = 0; i < NUM_SAMPLES; i++) {
-        samples[i] = 0;
+void GSRSensor::beginDevice() {
+    if (capture == nullptr) {
+        pinMode(sensorPin, INPUT);
+        eda.configure(1000.0f / PERIOD_MS);
     }
 }
 
-float GSRSensor::read() {
-    // Read raw GSR value
-    int rawValue = analogRead(sensorPin);
-    
-    // Convert to conductance (microsiemens)
-    float conductance = (1023.0 / rawValue - 1.0) * 10000.0;
-    
-    // Update moving average
-    samples[sampleIndex] = conductance;
-    sampleIndex = (sampleIndex + 1) % NUM_SAMPLES;
-    
-    // Calculate average
-    gsrAverage = 0;
-    for (int i = 0; i < NUM_SAMPLES; i++) {
-        gsrAverage += samples[i];
+bool GSRSensor::acquire(float& level) {
+    if (capture == nullptr) {
+        int rawValue = analogRead(sensorPin);
+        conductance = toConductance(rawValue);
+        if (isnan(conductance)) {
+            return false;
+        }
+        addConductance(conductance, PERIOD_MS * 0.001f);
+    } else {
+        // Skin conductance changes over seconds; one published value per block
+        bool fresh = false;
+        Emopod::Sensors::AdcBlock block;
+        while (capture->readBlock(Emopod::Sensors::ADC_CHANNEL_GSR, block)) {
+            processBlock(block);
+            fresh = true;
+        }
+        if (!fresh) {
+            return false;
+        }
     }
-    gsrAverage /= NUM_SAMPLES;
     
-    return gsrAverage;
+    level = eda.getTonicLevel();
+    return !isnan(level);
 }
 
-float GSRSensor::getAverage() {
-    return gsrAverage;
-} 
\ No newline at end of file
+float GSRSensor::read() {
+    sample();
+    return getValue();
+}
+
+float GSRSensor::processBlock(const Emopod::Sensors::AdcBlock& block) {
+    if (block.count == 0) {
+        return conductance;
+    }
+    if (block.sampleRate != eda.getInputRate()) {
+        eda.configure(block.sampleRate);
+    }
+    float interval = 1.0f / block.sampleRate;
+    for (int i = 0; i < block.count; i++) {
+        addConductance(toConductance(block.samples[i]), interval);
+    }
+    conductance = toConductance(block.mean());
+    return conductance;
+}
+
+void GSRSensor::addConductance(float value, float elapsed) {
+    if (artifacts.isEnabled() && !artifacts.accept(value, elapsed)) {
+        return;
+    }
+    if (eda.addSample(value)) {
+        newResponse = true;
+    }
+}
+
+float GSRSensor::toConductance(float raw) const {
+    float volts = raw * ADC_VOLTS / ADC_FULL_SCALE;
+    if (!(volts > 0)) {
+        return NAN;
+    }
+    // At or above the supply the skin is a short; clamp to one count below
+    float headroom = max(calibration.supplyVolts - volts, ADC_VOLTS / ADC_FULL_SCALE);
+    float microsiemens = 1e6f * volts / (calibration.referenceOhms * headroom);
+    return calibration.gain * microsiemens + calibration.offset;
+} 
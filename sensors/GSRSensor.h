@@ -1,49 +1,104 @@
 #ifndef GSR_SENSOR_H
 #define GSR_SENSOR_H
 
-class GSRSensor {
+#include <Arduino.h>
+#include "sensors/SensorDriver.h"
+#include "sensors/AdcCapture.h"
+#include "sensors/EdaAnalyzer.h"
+
+// Publishes the tonic skin conductance level in microsiemens; every
+// captured sample goes through the EDA analyzer, which is already smooth.
+// Motion artifacts are screened out per sample, before the analyzer.
+class GSRSensor : public Emopod::Sensors::SensorDriver<GSRSensor, 1> {
+public:
+    static constexpr const char* NAME = "GSR";
+    static constexpr const char* KEY = "gsr";
+    static constexpr unsigned long PERIOD_MS = 50;
+    static constexpr unsigned long COST_US = 300;
+    
+    // Phasic features published alongside the level
+    static constexpr const char* SCR_RATE_KEY = "scrRate";
+    static constexpr const char* SCR_AMPLITUDE_KEY = "scrAmplitude";
+    
+    // Skin sits between the supply and the ADC node, referenceOhms from the
+    // node to ground. gain and offset trim the result against a known load.
+    struct Calibration {
+        float supplyVolts;
+        float referenceOhms;
+        float gain;
+        float offset;   // uS
+    };
+    
 private:
+    friend class Emopod::Sensors::SensorDriver<GSRSensor, 1>;
+    
+    static constexpr float ADC_FULL_SCALE = 4095.0f;
+    static constexpr float ADC_VOLTS = 3.3f;
+    static const size_t CONDUCTANCE_WINDOW = 9;
+    
     int sensorPin;
-    float gsrValue;
-    float gsrAverage;
-    const int NUM_SAMPLES = 10;
-    float samples[10];
-    int sampleIndex = 0;
+    Emopod::Sensors::AdcCapture* capture;
+    Calibration calibration;
+    Emopod::Utils::OutlierFilter<CONDUCTANCE_WINDOW> artifacts;
+    Emopod::Sensors::EdaAnalyzer eda;
+    float conductance;
+    bool newResponse;
+    
+    void beginDevice();
+    bool acquire(float& level);
+    void addConductance(float value, float elapsed);
     
 public:
-    GSRSensor(int pin) : sensorPin(pin) {}
+    // With a capture engine the driver consumes its blocks; otherwise it polls
+    GSRSensor(int pin, Emopod::Sensors::AdcCapture* adcCapture = nullptr)
+        : sensorPin(pin), capture(adcCapture), calibration({ 3.3f, 10000.0f, 1.0f, 0.0f }),
+          conductance(NAN), newResponse(false) {}
+    
+    float read();
+    
+    // Feed every sample of one block from AdcCapture to the analyzer;
+    // returns the block's mean conductance
+    float processBlock(const Emopod::Sensors::AdcBlock& block);
+    
+    // Raw 12-bit count to microsiemens; NAN with no skin contact
+    float toConductance(float raw) const;
+    
+    void setCalibration(const Calibration& values) { calibration = values; }
+    const Calibration& getCalibration() const { return calibration; }
+    
+    // Artifact limits for individual conductance samples (uS, uS/s)
+    void setConductanceLimits(const Emopod::Utils::OutlierLimits& limits) {
+        artifacts.setLimits(limits);
+    }
+    
+    uint32_t getCheckedCount() const {
+        return SensorDriver::getCheckedCount() + artifacts.getCheckedCount();
+    }
+    
+    uint32_t getRejectedCount() const {
+        return SensorDriver::getRejectedCount() + artifacts.getRejectedCount();
+    }
+    
+    // Latest conductance, uS, before the tonic/phasic split
+    float getConductance() const { return conductance; }
     
-    void begin() {
-        pinMode(sensorPin, INPUT);
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-            samples[i] = 0;
-        }
+    const Emopod::Sensors::EdaAnalyzer::Features& getEdaFeatures() const {
+        return eda.getFeatures();
     }
     
-    float read() {
-        // Read raw GSR value
-        int rawValue = analogRead(sensorPin);
-        
-        // Convert to conductance (microsiemens)
-        float conductance = (1023.0 / rawValue - 1.0) * 10000.0;
-        
-        // Update moving average
-        samples[sampleIndex] = conductance;
-        sampleIndex = (sampleIndex + 1) % NUM_SAMPLES;
-        
-        // Calculate average
-        gsrAverage = 0;
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-            gsrAverage += samples[i];
-        }
-        gsrAverage /= NUM_SAMPLES;
-        
-        return gsrAverage;
+    // True once per accepted SCR; returns and clears the flag
+    bool takeResponse() {
+        bool response = newResponse;
+        newResponse = false;
+        return response;
     }
     
-    float getAverage() {
-        return gsrAverage;
+    template <typename Document>
+    void serialize(Document& doc) const {
+        SensorDriver::serialize(doc);
+        doc[SCR_RATE_KEY] = eda.getFeatures().scrRate;
+        doc[SCR_AMPLITUDE_KEY] = eda.getFeatures().meanAmplitude;
     }
 };
 
-#endif 
\ No newline at end of file
+#endif 
@@ -1,35 +1,168 @@
 #include "HeartRateSensor.h"
 
 // Implementation of HeartRateSensor class methods
-void HeartRateSensor::begin() {
-    sensor.setup();
+void HeartRateSensor::beginDevice() {
+    // Red + IR at 400 sps averaged by 4: 100 samples/s into the 32-deep FIFO
+    sensor.setup(0x1F, 4, 2, 400, 411, 4096);
     sensor.setPulseAmplitudeRed(0x0A);
     sensor.setPulseAmplitudeGreen(0);
+    sensor.clearFIFO();
+    
+    lastSampleTime = micros();
 }
 
-float HeartRateSensor::read() {
-    long irValue = sensor.getIR();
+int HeartRateSensor::burstRead() {
+    uint8_t writePointer = sensor.getWritePointer();
+    uint8_t readPointer = sensor.getReadPointer();
+    uint8_t overflow = sensor.readRegister8(MAX3010X_ADDRESS, REG_OVF_COUNTER);
     
-    if (checkForBeat(irValue)) {
-        long delta = millis() - lastBeat;
-        lastBeat = millis();
-        
-        beatsPerMinute = 60 / (delta / 1000.0);
+    int available = (writePointer - readPointer) & (FIFO_DEPTH - 1);
+    if (overflow > 0) {
+        // Pointers wrapped onto each other: the FIFO is full and samples were lost
+        available = FIFO_DEPTH;
+        stats.overflowEvents++;
+        stats.lostSamples += overflow;
+    }
+    if (available == 0) {
+        return 0;
+    }
+    
+    // A full FIFO is 192 bytes, more than the core's 128-byte receive
+    // buffer; the read pointer advances per sample, so later bursts resume
+    uint32_t red[FIFO_DEPTH];
+    uint32_t ir[FIFO_DEPTH];
+    int count = 0;
+    while (count < available) {
+        int burst = min(available - count, MAX_BURST_SAMPLES);
+        wire.beginTransmission(MAX3010X_ADDRESS);
+        wire.write(REG_FIFO_DATA);
+        wire.endTransmission(false);
+        int received = wire.requestFrom(MAX3010X_ADDRESS, (uint8_t)(burst * BYTES_PER_SAMPLE)) / BYTES_PER_SAMPLE;
+        stats.burstReads++;
         
-        if (beatsPerMinute < 255 && beatsPerMinute > 20) {
-            rates[rateSpot++] = (int)beatsPerMinute;
-            rateSpot %= RATE_SIZE;
+        for (int i = 0; i < received; i++, count++) {
+            uint32_t value;
+            
+            value = (uint32_t)wire.read() << 16;
+            value |= (uint32_t)wire.read() << 8;
+            value |= wire.read();
+            red[count] = value & 0x3FFFF;
             
-            beatAvg = 0;
-            for (int x = 0; x < RATE_SIZE; x++)
-                beatAvg += rates[x];
-            beatAvg /= RATE_SIZE;
+            value = (uint32_t)wire.read() << 16;
+            value |= (uint32_t)wire.read() << 8;
+            value |= wire.read();
+            ir[count] = value & 0x3FFFF;
+        }
+        if (received < burst) {
+            break;
+        }
+    }
+    
+    // Newest sample lands "now"; older ones are spaced back by the sample period
+    const unsigned long period = 1000000UL / SAMPLE_RATE;
+    unsigned long now = micros();
+    unsigned long timestamp = now - (unsigned long)(count - 1) * period;
+    if (overflow == 0 && (long)(timestamp - lastSampleTime) <= 0) {
+        timestamp = lastSampleTime + period;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        PpgSample sample;
+        sample.red = red[i];
+        sample.ir = ir[i];
+        sample.timestamp = timestamp + i * period;
+        if (!samples.push(sample)) {
+            stats.bufferDrops++;
+        }
+    }
+    
+    if (count > 0) {
+        lastSampleTime = timestamp + (count - 1) * period;
+    }
+    stats.samplesRead += count;
+    return count;
+}
+
+int HeartRateSensor::processBatch() {
+    // Beat detection and SpO2 both run over whole blocks
+    const int blockSize = Emopod::Sensors::SpO2Estimator::BLOCK_SIZE;
+    const float period = 1000000.0f / SAMPLE_RATE;
+    uint32_t red[blockSize];
+    uint32_t ir[blockSize];
+    Emopod::Sensors::PpgBeatDetector::Beat beats[4];
+    int processed = 0;
+    PpgSample sample;
+    for (;;) {
+        int count = 0;
+        unsigned long start = 0;
+        while (count < blockSize && samples.pop(sample)) {
+            if (count == 0) {
+                start = sample.timestamp;
+            }
+            red[count] = sample.red;
+            ir[count] = sample.ir;
+            count++;
         }
+        if (count == 0) {
+            break;
+        }
+        
+        // Samples in a block are evenly spaced on the sample clock
+        int found = beatDetector.processBlock(ir, count, beats, 4);
+        for (int i = 0; i < found; i++) {
+            onBeat(start + (long)lroundf(beats[i].offset * period));
+        }
+        oximeter.processBatch(red, ir, count);
+        processed += count;
     }
+    return processed;
+}
+
+bool HeartRateSensor::acquire(float& bpm) {
+    burstRead();
+    processBatch();
     
-    return beatsPerMinute;
+    // Only a detected beat yields a new rate
+    if (!newBeat) {
+        return false;
+    }
+    newBeat = false;
+    bpm = beatsPerMinute;
+    return true;
+}
+
+float HeartRateSensor::read() {
+    sample();
+    return getValue();
+}
+
+void HeartRateSensor::onBeat(unsigned long timestamp) {
+    // Beat spacing comes from sample timestamps, not from when we got here
+    hrv.addBeat(timestamp);
+    
+    unsigned long delta = timestamp - lastBeatTime;
+    bool first = !hasBeat;
+    lastBeatTime = timestamp;
+    hasBeat = true;
+    if (first || delta == 0) {
+        return;
+    }
+    
+    float bpm = 60000000.0f / delta;
+    if (bpm < 255 && bpm > 20) {
+        beatsPerMinute = bpm;
+        newBeat = true;
+    }
+}
+
+float HeartRateSensor::getSpO2() {
+    return oximeter.getSpO2();
+}
+
+bool HeartRateSensor::isSpO2Valid() {
+    return oximeter.isValid();
 }
 
-int HeartRateSensor::getAverage() {
-    return beatAvg;
-} 
\ No newline at end of file
+const HeartRateSensor::FifoStats& HeartRateSensor::getFifoStats() {
+    return stats;
+} 
@@ -1,54 +1,110 @@
 #ifndef HEART_RATE_SENSOR_H
 #define HEART_RATE_SENSOR_H
 
+#include <Wire.h>
 #include <MAX30105.h>
-#include <heartRate.h>
+#include "utils/RingBuffer.h"
+#include "sensors/SensorDriver.h"
+#include "sensors/HrvAnalyzer.h"
+#include "sensors/SpO2Estimator.h"
+#include "sensors/PpgBeatDetector.h"
 
-class HeartRateSensor {
+// MAX30102/MAX30105 (18-bit, 32-deep FIFO) through the SparkFun library.
+// Not in SensorManager's table, which runs the MAX30100 through
+// PulseOximeterSensor; boards with a MAX3010x list this driver there
+// instead. Both run the same PpgBeatDetector and SpO2Estimator.
+class HeartRateSensor : public Emopod::Sensors::SensorDriver<HeartRateSensor, 4> {
+public:
+    static constexpr const char* NAME = "MAX30105";
+    static constexpr const char* KEY = "heartRate";
+    static constexpr unsigned long PERIOD_MS = 100;   // FIFO holds 320 ms at 100 sps
+    static constexpr unsigned long COST_US = 3000;
+    
+    struct PpgSample {
+        uint32_t red;
+        uint32_t ir;
+        unsigned long timestamp; // micros(), reconstructed from the FIFO sample clock
+    };
+    
+    struct FifoStats {
+        uint32_t burstReads;
+        uint32_t samplesRead;
+        uint32_t overflowEvents;  // bursts that found the chip FIFO already full
+        uint32_t lostSamples;     // samples the chip discarded (OVF_COUNTER)
+        uint32_t bufferDrops;     // samples overwritten before processing
+    };
+    
 private:
+    friend class Emopod::Sensors::SensorDriver<HeartRateSensor, 4>;
+    
+    // MAX3010x register map (FIFO section)
+    static const uint8_t MAX3010X_ADDRESS = 0x57;
+    static const uint8_t REG_FIFO_WR_PTR = 0x04;
+    static const uint8_t REG_OVF_COUNTER = 0x05;
+    static const uint8_t REG_FIFO_RD_PTR = 0x06;
+    static const uint8_t REG_FIFO_DATA = 0x07;
+    static const int FIFO_DEPTH = 32;
+    static const int BYTES_PER_SAMPLE = 6;         // red + IR, 3 bytes each
+    
+    // requestFrom() cannot return more than the Wire receive buffer, 128
+    // bytes unless setBufferSize() ran before Wire.begin()
+    static const int WIRE_BUFFER_BYTES = 128;
+    static const int MAX_BURST_SAMPLES = WIRE_BUFFER_BYTES / BYTES_PER_SAMPLE;
+    static const uint16_t SAMPLE_RATE = 100;       // 400 sps averaged by 4
+    
     MAX30105& sensor;
-    long lastBeat = 0;
+    TwoWire& wire;
+    Emopod::Utils::RingBuffer<PpgSample, 64> samples;
+    FifoStats stats;
+    unsigned long lastSampleTime = 0;
+    
+    Emopod::Sensors::PpgBeatDetector beatDetector;
+    unsigned long lastBeatTime = 0;   // micros(), sub-sample
+    bool hasBeat = false;
     float beatsPerMinute;
-    int beatAvg;
-    const int RATE_SIZE = 4;
-    int rates[RATE_SIZE];
-    int rateSpot = 0;
+    bool newBeat = false;
+    Emopod::Sensors::HrvAnalyzer hrv;
+    Emopod::Sensors::SpO2Estimator oximeter;
+    
+    void onBeat(unsigned long timestamp);
+    
+    void beginDevice();
+    bool acquire(float& bpm);
     
 public:
-    HeartRateSensor(MAX30105& sensorRef) : sensor(sensorRef) {}
+    HeartRateSensor(MAX30105& sensorRef, TwoWire& wirePort = Wire)
+        : sensor(sensorRef), wire(wirePort), stats(), beatDetector(SAMPLE_RATE), beatsPerMinute(0),
+          oximeter(SAMPLE_RATE) {}
     
-    void begin() {
-        sensor.setup();
-        sensor.setPulseAmplitudeRed(0x0A);
-        sensor.setPulseAmplitudeGreen(0);
-    }
+    // Drain the whole chip FIFO in bursts of at most MAX_BURST_SAMPLES;
+    // returns samples read
+    int burstRead();
     
-    float read() {
-        long irValue = sensor.getIR();
-        
-        if (checkForBeat(irValue)) {
-            long delta = millis() - lastBeat;
-            lastBeat = millis();
-            
-            beatsPerMinute = 60 / (delta / 1000.0);
-            
-            if (beatsPerMinute < 255 && beatsPerMinute > 20) {
-                rates[rateSpot++] = (int)beatsPerMinute;
-                rateSpot %= RATE_SIZE;
-                
-                beatAvg = 0;
-                for (int x = 0; x < RATE_SIZE; x++)
-                    beatAvg += rates[x];
-                beatAvg /= RATE_SIZE;
-            }
-        }
-        
-        return beatsPerMinute;
-    }
+    // Process everything buffered so far; returns samples consumed
+    int processBatch();
     
-    int getAverage() {
-        return beatAvg;
+    // burstRead() followed by processBatch(); returns the smoothed BPM
+    float read();
+    
+    // NAN while the signal quality is below SpO2Estimator::QUALITY_THRESHOLD
+    float getSpO2();
+    bool isSpO2Valid();
+    float getSpO2Quality() const { return oximeter.getQuality(); }
+    const Emopod::Sensors::SpO2Estimator& getOximeter() const { return oximeter; }
+    const Emopod::Sensors::PpgBeatDetector& getBeatDetector() const { return beatDetector; }
+    const FifoStats& getFifoStats();
+    
+    // Beat-to-beat variability, from the same sample-clock beat times
+    const Emopod::Sensors::HrvAnalyzer& getHrv() const { return hrv; }
+    
+    template <typename Document>
+    void serialize(Document& doc) const {
+        SensorDriver::serialize(doc);
+        if (oximeter.isValid()) {
+            doc["spO2"] = oximeter.getSpO2();
+        }
+        hrv.serialize(doc);
     }
 };
 
-#endif 
\ No newline at end of file
+#endif 
@@ -1,48 +1,52 @@
 #include "MicrophoneSensor.h"
 
-void MicrophoneSensor::begin() {
-    pinMode(sensorPin, INPUT);
-    for (int i = 0; i < NUM_SAMPLES; i++) {
-        samples[i] = 0;
+void MicrophoneSensor::beginDevice() {
+    if (capture == nullptr) {
+        // Polled samples are far below audio rate: only a coarse, unweighted level
+        pinMode(sensorPin, INPUT);
+        meter.configure(1000.0f / PERIOD_MS, false, 1000.0f);
     }
 }
 
-float MicrophoneSensor::read() {
-    // Read raw microphone value
-    int rawValue = analogRead(sensorPin);
-    
-    // Update min/max values for calibration
-    if (rawValue > maxAmplitude) maxAmplitude = rawValue;
-    if (rawValue < minAmplitude) minAmplitude = rawValue;
-    
-    // Normalize the value between 0 and 1
-    float normalizedValue = (float)(rawValue - minAmplitude) / (maxAmplitude - minAmplitude);
-    
-    // Convert to decibels (simplified)
-    soundLevel = 20 * log10(normalizedValue * 100);
-    
-    // Update moving average
-    samples[sampleIndex] = soundLevel;
-    sampleIndex = (sampleIndex + 1) % NUM_SAMPLES;
-    
-    // Calculate average
-    soundAverage = 0;
-    for (int i = 0; i < NUM_SAMPLES; i++) {
-        soundAverage += samples[i];
+bool MicrophoneSensor::acquire(float& level) {
+    if (capture == nullptr) {
+        uint16_t raw = analogRead(sensorPin);
+        if (meter.processBlock(&raw, 1)) {
+            newLevel = true;
+        }
+    } else {
+        Emopod::Sensors::AdcBlock block;
+        while (capture->readBlock(Emopod::Sensors::ADC_CHANNEL_MIC, block)) {
+            processBlock(block);
+        }
     }
-    soundAverage /= NUM_SAMPLES;
     
-    return soundAverage;
+    // One value per completed window
+    if (!newLevel) {
+        return false;
+    }
+    newLevel = false;
+    level = meter.getLeq();
+    return true;
 }
 
-float MicrophoneSensor::getAverage() {
-    return soundAverage;
+float MicrophoneSensor::read() {
+    sample();
+    return getValue();
 }
 
-float MicrophoneSensor::getMaxAmplitude() {
-    return maxAmplitude;
+void MicrophoneSensor::processBlock(const Emopod::Sensors::AdcBlock& block) {
+    if (block.count == 0 || block.sampleRate == 0) {
+        return;
+    }
+    if (block.sampleRate != meter.getSampleRate()) {
+        meter.configure(block.sampleRate);
+    }
+    if (block.sampleRate != spectrum.getSampleRate()) {
+        spectrum.configure(block.sampleRate);
+    }
+    if (meter.processBlock(block.samples, block.count)) {
+        newLevel = true;
+    }
+    spectrum.processBlock(block.samples, block.count);
 }
-
-float MicrophoneSensor::getMinAmplitude() {
-    return minAmplitude;
-} 
\ No newline at end of file
@@ -1,66 +1,70 @@
 #ifndef MICROPHONE_SENSOR_H
 #define MICROPHONE_SENSOR_H
 
-class MicrophoneSensor {
+#include <Arduino.h>
+#include "sensors/SensorDriver.h"
+#include "sensors/AdcCapture.h"
+#include "sensors/SoundLevelMeter.h"
+#include "sensors/SpectralAnalyzer.h"
+
+// The published level is already an Leq, so the driver does not smooth again
+class MicrophoneSensor : public Emopod::Sensors::SensorDriver<MicrophoneSensor, 1> {
+public:
+    static constexpr const char* NAME = "Microphone";
+    static constexpr const char* KEY = "soundLevel";
+    static constexpr unsigned long PERIOD_MS = 10;
+    static constexpr unsigned long COST_US = 400;
+    
+    // Spectral cues published alongside the level
+    static constexpr const char* CENTROID_KEY = "spectralCentroid";
+    static constexpr const char* PITCH_VARIABILITY_KEY = "pitchVariability";
+    static constexpr const char* VOICED_RATIO_KEY = "voicedRatio";
+    
 private:
+    friend class Emopod::Sensors::SensorDriver<MicrophoneSensor, 1>;
+    
     int sensorPin;
-    float soundLevel;
-    float soundAverage;
-    const int NUM_SAMPLES = 10;
-    float samples[10];
-    int sampleIndex = 0;
-    float maxAmplitude = 0;
-    float minAmplitude = 1023;
+    Emopod::Sensors::AdcCapture* capture;
+    Emopod::Sensors::SoundLevelMeter meter;
+    Emopod::Sensors::SpectralAnalyzer spectrum;
+    bool newLevel = false;
+    
+    void beginDevice();
+    bool acquire(float& level);
     
 public:
-    MicrophoneSensor(int pin) : sensorPin(pin) {}
+    // With a capture engine the driver consumes its blocks; otherwise it polls
+    MicrophoneSensor(int pin, Emopod::Sensors::AdcCapture* adcCapture = nullptr)
+        : sensorPin(pin), capture(adcCapture) {}
     
-    void begin() {
-        pinMode(sensorPin, INPUT);
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-            samples[i] = 0;
-        }
-    }
+    float read();
     
-    float read() {
-        // Read raw microphone value
-        int rawValue = analogRead(sensorPin);
-        
-        // Update min/max values for calibration
-        if (rawValue > maxAmplitude) maxAmplitude = rawValue;
-        if (rawValue < minAmplitude) minAmplitude = rawValue;
-        
-        // Normalize the value between 0 and 1
-        float normalizedValue = (float)(rawValue - minAmplitude) / (maxAmplitude - minAmplitude);
-        
-        // Convert to decibels (simplified)
-        soundLevel = 20 * log10(normalizedValue * 100);
-        
-        // Update moving average
-        samples[sampleIndex] = soundLevel;
-        sampleIndex = (sampleIndex + 1) % NUM_SAMPLES;
-        
-        // Calculate average
-        soundAverage = 0;
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-            soundAverage += samples[i];
-        }
-        soundAverage /= NUM_SAMPLES;
-        
-        return soundAverage;
-    }
+    // Feed one block from AdcCapture; the meter follows the block's rate
+    void processBlock(const Emopod::Sensors::AdcBlock& block);
+    
+    // Latest window: RMS level, peak and Leq
+    const Emopod::Sensors::SoundLevelMeter::Window& getWindow() const { return meter.getWindow(); }
+    
+    Emopod::Sensors::SoundLevelMeter& getMeter() { return meter; }
+    float getMeterLoad() const { return meter.getCpuLoad(); }
     
-    float getAverage() {
-        return soundAverage;
+    // Band energies, centroid and pitch variability; needs the capture engine
+    const Emopod::Sensors::SpectralAnalyzer::Features& getSpectralFeatures() const {
+        return spectrum.getFeatures();
     }
     
-    float getMaxAmplitude() {
-        return maxAmplitude;
+    const Emopod::Sensors::SpectralAnalyzer::Stats& getSpectralStats() const {
+        return spectrum.getStats();
     }
     
-    float getMinAmplitude() {
-        return minAmplitude;
+    template <typename Document>
+    void serialize(Document& doc) const {
+        SensorDriver::serialize(doc);
+        const Emopod::Sensors::SpectralAnalyzer::Features& features = spectrum.getFeatures();
+        doc[CENTROID_KEY] = features.centroidHz;
+        doc[PITCH_VARIABILITY_KEY] = features.pitchVariability;
+        doc[VOICED_RATIO_KEY] = features.voicedRatio;
     }
 };
 
-#endif 
\ No newline at end of file
+#endif 
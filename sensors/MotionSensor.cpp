@@ -1,58 +1,151 @@
 #include "MotionSensor.h"
 
-void MotionSensor::begin() {
+void MotionSensor::beginDevice() {
     sensor.begin();
     sensor.setAccelerometerRange(MPU6050_RANGE_8_G);
     sensor.setGyroRange(MPU6050_RANGE_500_DEG);
     sensor.setFilterBandwidth(MPU6050_BAND_21_HZ);
     
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < NUM_SAMPLES; j++) {
-            accelSamples[i][j] = 0;
-            gyroSamples[i][j] = 0;
-        }
-    }
+    // With the DLPF enabled the sample clock is 1 kHz: ODR = 1000 / (1 + div)
+    uint16_t odrHz = constrain(outputRate, 4, 1000);
+    uint8_t divider = (uint8_t)(1000 / odrHz - 1);
+    outputRate = 1000 / (divider + 1);
+    writeRegister(REG_SMPLRT_DIV, divider);
+    
+    writeRegister(REG_FIFO_EN, FIFO_EN_ACCEL_GYRO);
+    resetFifo();
+    
+    batch.count = 0;
+    batch.sampleRate = outputRate;
+    fusion.configure(outputRate);
 }
 
-void MotionSensor::read() {
-    sensors_event_t a, g, temp;
-    sensor.getEvent(&a, &g, &temp);
+int MotionSensor::readBatch() {
+    batch.count = 0;
+    batch.sampleRate = outputRate;
     
-    // Update accelerometer values
-    accelX = a.acceleration.x;
-    accelY = a.acceleration.y;
-    accelZ = a.acceleration.z;
-    
-    // Update gyroscope values
-    gyroX = g.gyro.x;
-    gyroY = g.gyro.y;
-    gyroZ = g.gyro.z;
+    uint8_t countBytes[2];
+    if (!readRegisters(REG_FIFO_COUNT_H, countBytes, 2)) {
+        return 0;
+    }
+    uint16_t fifoBytes = ((uint16_t)countBytes[0] << 8) | countBytes[1];
+    if (fifoBytes >= FIFO_SIZE) {
+        // Frame alignment is lost once the FIFO wraps; start clean
+        stats.overflows++;
+        resetFifo();
+        return 0;
+    }
+    int frames = fifoBytes / FRAME_BYTES;
+    if (frames > MotionBatch::CAPACITY) {
+        frames = MotionBatch::CAPACITY;
+    }
     
-    // Update moving averages for accelerometer
-    accelSamples[0][sampleIndex] = accelX;
-    accelSamples[1][sampleIndex] = accelY;
-    accelSamples[2][sampleIndex] = accelZ;
+    uint8_t buffer[FRAMES_PER_TRANSACTION * FRAME_BYTES];
+    while (batch.count < frames) {
+        int chunk = frames - batch.count;
+        if (chunk > FRAMES_PER_TRANSACTION) {
+            chunk = FRAMES_PER_TRANSACTION;
+        }
+        if (!readRegisters(REG_FIFO_R_W, buffer, chunk * FRAME_BYTES)) {
+            break;
+        }
+        
+        for (int i = 0; i < chunk; i++) {
+            const uint8_t* frame = buffer + i * FRAME_BYTES;
+            int n = batch.count + i;
+            batch.accelX[n] = (int16_t)((frame[0] << 8) | frame[1]) * ACCEL_SCALE;
+            batch.accelY[n] = (int16_t)((frame[2] << 8) | frame[3]) * ACCEL_SCALE;
+            batch.accelZ[n] = (int16_t)((frame[4] << 8) | frame[5]) * ACCEL_SCALE;
+            batch.gyroX[n] = (int16_t)((frame[6] << 8) | frame[7]) * GYRO_SCALE;
+            batch.gyroY[n] = (int16_t)((frame[8] << 8) | frame[9]) * GYRO_SCALE;
+            batch.gyroZ[n] = (int16_t)((frame[10] << 8) | frame[11]) * GYRO_SCALE;
+        }
+        batch.count += chunk;
+    }
     
-    // Update moving averages for gyroscope
-    gyroSamples[0][sampleIndex] = gyroX;
-    gyroSamples[1][sampleIndex] = gyroY;
-    gyroSamples[2][sampleIndex] = gyroZ;
+    batch.timestamp = micros();
+    stats.framesRead += batch.count;
+    return batch.count;
+}
+
+bool MotionSensor::acquire(float& linear) {
+    if (readBatch() == 0) {
+        return false;
+    }
+    computeFeatures();
+    fusion.processBatch(batch.accelX, batch.accelY, batch.accelZ,
+                        batch.gyroX, batch.gyroY, batch.gyroZ, batch.count);
+    linear = fusion.getFeatures().linearMagnitude;
+    return true;
+}
+
+float MotionSensor::read() {
+    sample();
+    return getValue();
+}
+
+void MotionSensor::readTemperature() {
+    uint8_t raw[2];
+    if (readRegisters(REG_TEMP_OUT_H, raw, 2)) {
+        temperature = (int16_t)((raw[0] << 8) | raw[1]) / 340.0f + 36.53f;
+    }
+}
+
+void MotionSensor::computeFeatures() {
+    float sums[6] = { 0, 0, 0, 0, 0, 0 };
+    float magnitudeSum = 0;
+    float magnitudeSquares = 0;
     
-    sampleIndex = (sampleIndex + 1) % NUM_SAMPLES;
+    for (int i = 0; i < batch.count; i++) {
+        sums[0] += batch.accelX[i];
+        sums[1] += batch.accelY[i];
+        sums[2] += batch.accelZ[i];
+        sums[3] += batch.gyroX[i];
+        sums[4] += batch.gyroY[i];
+        sums[5] += batch.gyroZ[i];
+        
+        float magnitude = sqrtf(batch.accelX[i] * batch.accelX[i] +
+                                batch.accelY[i] * batch.accelY[i] +
+                                batch.accelZ[i] * batch.accelZ[i]);
+        magnitudeSum += magnitude;
+        magnitudeSquares += magnitude * magnitude;
+    }
     
-    // Calculate averages
+    float n = batch.count;
     for (int i = 0; i < 3; i++) {
-        accelAverage[i] = 0;
-        gyroAverage[i] = 0;
-        
-        for (int j = 0; j < NUM_SAMPLES; j++) {
-            accelAverage[i] += accelSamples[i][j];
-            gyroAverage[i] += gyroSamples[i][j];
-        }
-        
-        accelAverage[i] /= NUM_SAMPLES;
-        gyroAverage[i] /= NUM_SAMPLES;
+        accelAverage[i] = sums[i] / n;
+        gyroAverage[i] = sums[i + 3] / n;
     }
+    magnitudeMean = magnitudeSum / n;
+    magnitudeVariance = max(0.0f, magnitudeSquares / n - magnitudeMean * magnitudeMean);
+}
+
+void MotionSensor::resetFifo() {
+    writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_RESET);
+    writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_EN);
+}
+
+void MotionSensor::writeRegister(uint8_t reg, uint8_t value) {
+    wire.beginTransmission(MPU_ADDRESS);
+    wire.write(reg);
+    wire.write(value);
+    wire.endTransmission();
+}
+
+bool MotionSensor::readRegisters(uint8_t reg, uint8_t* buffer, uint8_t length) {
+    stats.transactions++;
+    wire.beginTransmission(MPU_ADDRESS);
+    wire.write(reg);
+    if (wire.endTransmission(false) != 0) {
+        return false;
+    }
+    if (wire.requestFrom(MPU_ADDRESS, length) != length) {
+        return false;
+    }
+    for (uint8_t i = 0; i < length; i++) {
+        buffer[i] = wire.read();
+    }
+    return true;
 }
 
 float MotionSensor::getAccelX() { return accelAverage[0]; }
@@ -63,4 +156,7 @@ float MotionSensor::getGyroX() { return gyroAverage[0]; }
 float MotionSensor::getGyroY() { return gyroAverage[1]; }
 float MotionSensor::getGyroZ() { return gyroAverage[2]; }
 
-float MotionSensor::getTemperature() { return temp.temperature; } 
\ No newline at end of file
+float MotionSensor::getMagnitude() { return magnitudeMean; }
+float MotionSensor::getMagnitudeVariance() { return magnitudeVariance; }
+
+float MotionSensor::getTemperature() { return temperature; } 
@@ -1,88 +1,141 @@
 #ifndef MOTION_SENSOR_H
 #define MOTION_SENSOR_H
 
+#include <Wire.h>
 #include <Adafruit_MPU6050.h>
 #include <Adafruit_Sensor.h>
+#include "sensors/SensorDriver.h"
+#include "sensors/MotionFusion.h"
 
-class MotionSensor {
+// One FIFO drain worth of motion samples, stored axis by axis
+struct MotionBatch {
+    static const int CAPACITY = 85; // 1020 bytes of 12-byte frames
+    
+    float accelX[CAPACITY];
+    float accelY[CAPACITY];
+    float accelZ[CAPACITY];
+    float gyroX[CAPACITY];
+    float gyroY[CAPACITY];
+    float gyroZ[CAPACITY];
+    int count;
+    uint16_t sampleRate;       // Hz
+    unsigned long timestamp;   // micros() of the newest frame
+};
+
+// Publishes RMS linear acceleration (gravity removed by the fusion stage)
+class MotionSensor : public Emopod::Sensors::SensorDriver<MotionSensor, 10> {
+public:
+    static constexpr const char* NAME = "MPU6050";
+    static constexpr const char* KEY = "motion";
+    static constexpr unsigned long PERIOD_MS = 100;  // FIFO holds ~850 ms at 100 Hz
+    static constexpr unsigned long COST_US = 2300;
+    
+    // Activity features published alongside the linear acceleration
+    static constexpr const char* JERK_KEY = "jerk";
+    static constexpr const char* FIDGET_KEY = "fidgetEnergy";
+    static constexpr const char* CADENCE_KEY = "cadence";
+    
+    struct FifoStats {
+        uint32_t transactions;   // I2C transactions spent on FIFO reads
+        uint32_t framesRead;
+        uint32_t overflows;      // FIFO filled up and was reset
+    };
+    
 private:
+    friend class Emopod::Sensors::SensorDriver<MotionSensor, 10>;
+    
+    // MPU6050 registers used for FIFO operation
+    static const uint8_t MPU_ADDRESS = 0x68;
+    static const uint8_t REG_SMPLRT_DIV = 0x19;
+    static const uint8_t REG_FIFO_EN = 0x23;
+    static const uint8_t REG_TEMP_OUT_H = 0x41;
+    static const uint8_t REG_USER_CTRL = 0x6A;
+    static const uint8_t REG_FIFO_COUNT_H = 0x72;
+    static const uint8_t REG_FIFO_R_W = 0x74;
+    
+    static const uint8_t FIFO_EN_ACCEL_GYRO = 0x78;
+    static const uint8_t USER_CTRL_FIFO_EN = 0x40;
+    static const uint8_t USER_CTRL_FIFO_RESET = 0x04;
+    
+    static const uint16_t FIFO_SIZE = 1024;
+    static const int FRAME_BYTES = 12;
+    static const int FRAMES_PER_TRANSACTION = 10; // stays inside the 128-byte Wire buffer
+    
+    // +-8 g and +-500 dps full scale
+    static constexpr float ACCEL_SCALE = 9.80665f / 4096.0f;          // m/s^2 per LSB
+    static constexpr float GYRO_SCALE = (3.14159265f / 180.0f) / 65.5f; // rad/s per LSB
+    
     Adafruit_MPU6050& sensor;
-    float accelX, accelY, accelZ;
-    float gyroX, gyroY, gyroZ;
+    TwoWire& wire;
+    MotionBatch batch;
+    FifoStats stats;
+    uint16_t outputRate;
+    Emopod::Sensors::MotionFusion fusion;
+    
     float accelAverage[3];
     float gyroAverage[3];
-    const int NUM_SAMPLES = 5;
-    float accelSamples[3][5];
-    float gyroSamples[3][5];
-    int sampleIndex = 0;
+    float magnitudeMean;
+    float magnitudeVariance;
+    float temperature;
+    
+    void writeRegister(uint8_t reg, uint8_t value);
+    bool readRegisters(uint8_t reg, uint8_t* buffer, uint8_t length);
+    void resetFifo();
+    void computeFeatures();
+    
+    void beginDevice();
+    bool acquire(float& linear);
     
 public:
-    MotionSensor(Adafruit_MPU6050& sensorRef) : sensor(sensorRef) {}
-    
-    void begin() {
-        sensor.begin();
-        sensor.setAccelerometerRange(MPU6050_RANGE_8_G);
-        sensor.setGyroRange(MPU6050_RANGE_500_DEG);
-        sensor.setFilterBandwidth(MPU6050_BAND_21_HZ);
-        
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < NUM_SAMPLES; j++) {
-                accelSamples[i][j] = 0;
-                gyroSamples[i][j] = 0;
-            }
-        }
-    }
+    MotionSensor(Adafruit_MPU6050& sensorRef, TwoWire& wirePort = Wire)
+        : sensor(sensorRef), wire(wirePort), stats(), outputRate(100),
+          accelAverage(), gyroAverage(), magnitudeMean(0), magnitudeVariance(0),
+          temperature(0) { batch.count = 0; }
     
-    void read() {
-        sensors_event_t a, g, temp;
-        sensor.getEvent(&a, &g, &temp);
-        
-        // Update accelerometer values
-        accelX = a.acceleration.x;
-        accelY = a.acceleration.y;
-        accelZ = a.acceleration.z;
-        
-        // Update gyroscope values
-        gyroX = g.gyro.x;
-        gyroY = g.gyro.y;
-        gyroZ = g.gyro.z;
-        
-        // Update moving averages for accelerometer
-        accelSamples[0][sampleIndex] = accelX;
-        accelSamples[1][sampleIndex] = accelY;
-        accelSamples[2][sampleIndex] = accelZ;
-        
-        // Update moving averages for gyroscope
-        gyroSamples[0][sampleIndex] = gyroX;
-        gyroSamples[1][sampleIndex] = gyroY;
-        gyroSamples[2][sampleIndex] = gyroZ;
-        
-        sampleIndex = (sampleIndex + 1) % NUM_SAMPLES;
-        
-        // Calculate averages
-        for (int i = 0; i < 3; i++) {
-            accelAverage[i] = 0;
-            gyroAverage[i] = 0;
-            
-            for (int j = 0; j < NUM_SAMPLES; j++) {
-                accelAverage[i] += accelSamples[i][j];
-                gyroAverage[i] += gyroSamples[i][j];
-            }
-            
-            accelAverage[i] /= NUM_SAMPLES;
-            gyroAverage[i] /= NUM_SAMPLES;
-        }
-    }
+    // FIFO output data rate (4-1000 Hz), applied by begin()
+    void setOutputRate(uint16_t odrHz) { outputRate = odrHz; }
+    
+    // Drain the FIFO into the batch buffer; returns frames read
+    int readBatch();
+    
+    // readBatch() followed by feature extraction over the whole batch
+    float read();
+    
+    // Die temperature is not in the FIFO; read it on demand
+    void readTemperature();
+    
+    const MotionBatch& getBatch() const { return batch; }
+    const FifoStats& getFifoStats() const { return stats; }
     
-    float getAccelX() { return accelAverage[0]; }
-    float getAccelY() { return accelAverage[1]; }
-    float getAccelZ() { return accelAverage[2]; }
+    float getAccelX();
+    float getAccelY();
+    float getAccelZ();
     
-    float getGyroX() { return gyroAverage[0]; }
-    float getGyroY() { return gyroAverage[1]; }
-    float getGyroZ() { return gyroAverage[2]; }
+    float getGyroX();
+    float getGyroY();
+    float getGyroZ();
     
-    float getTemperature() { return temp.temperature; }
+    // Mean and variance of |accel| over the last batch, gravity included
+    float getMagnitude();
+    float getMagnitudeVariance();
+    
+    float getTemperature();
+    
+    // Orientation, linear acceleration and activity from the fusion stage
+    const Emopod::Sensors::MotionFusion::Features& getMotionFeatures() const {
+        return fusion.getFeatures();
+    }
+    const Emopod::Sensors::MotionFusion::Stats& getFusionStats() const {
+        return fusion.getStats();
+    }
+    
+    template <typename Document>
+    void serialize(Document& doc) const {
+        SensorDriver::serialize(doc);
+        doc[JERK_KEY] = fusion.getFeatures().jerk;
+        doc[FIDGET_KEY] = fusion.getFeatures().fidgetEnergy;
+        doc[CADENCE_KEY] = fusion.getFeatures().cadence;
+    }
 };
 
-#endif 
\ No newline at end of file
+#endif 
@@ -0,0 +1,102 @@
+#include "PulseOximeterSensor.h"
+
+constexpr Emopod::Sensors::SpO2Estimator::Calibration PulseOximeterSensor::CALIBRATION;
+
+void PulseOximeterSensor::beginDevice() {
+    // Red + IR at 100 sps, 16-bit; begin() leaves the chip in HR-only mode
+    sensor.setMode(MAX30100_MODE_SPO2_HR);
+    sensor.setSamplingRate(MAX30100_SAMPRATE_100HZ);
+    sensor.setLedsPulseWidth(MAX30100_SPC_PW_1600US_16BITS);
+    sensor.setLedsCurrent(MAX30100_LED_CURR_7_6MA, MAX30100_LED_CURR_27_1MA);
+    sensor.setHighresModeEnabled(true);
+    sensor.resetFifo();
+    
+    oximeter.setCalibration(CALIBRATION);
+    lastSampleTime = micros();
+}
+
+bool PulseOximeterSensor::acquire(float& heartRate) {
+    // OVF_COUNTER resets once a sample is popped, so sample it first
+    uint8_t lost = 0;
+    wire.beginTransmission(MAX30100_ADDRESS);
+    wire.write(REG_OVF_COUNTER);
+    if (wire.endTransmission(false) == 0 &&
+        wire.requestFrom(MAX30100_ADDRESS, (uint8_t)1) == 1) {
+        lost = wire.read();
+    }
+    if (lost > 0) {
+        // A full FIFO has equal pointers, which the library reads as empty;
+        // restart it and let the detectors resynchronize
+        lostSamples += lost;
+        overflowEvents++;
+        sensor.resetFifo();
+        return false;
+    }
+    
+    // The library reads every pending sample in one I2C burst
+    sensor.update();
+    
+    const int blockSize = Emopod::Sensors::SpO2Estimator::BLOCK_SIZE;
+    uint32_t red[blockSize];
+    uint32_t ir[blockSize];
+    uint16_t irValue;
+    uint16_t redValue;
+    int count = 0;
+    while (count < blockSize && sensor.getRawValues(&irValue, &redValue)) {
+        red[count] = (uint32_t)redValue << SAMPLE_SHIFT;
+        ir[count] = (uint32_t)irValue << SAMPLE_SHIFT;
+        count++;
+    }
+    
+    if (count > 0) {
+        // Newest sample lands "now"; older ones are spaced back by the sample period
+        const unsigned long period = 1000000UL / SAMPLE_RATE;
+        unsigned long start = micros() - (unsigned long)(count - 1) * period;
+        if ((long)(start - lastSampleTime) <= 0) {
+            start = lastSampleTime + period;
+        }
+        lastSampleTime = start + (unsigned long)(count - 1) * period;
+    
+        Emopod::Sensors::PpgBeatDetector::Beat beats[4];
+        int found = beatDetector.processBlock(ir, count, beats, 4);
+        for (int i = 0; i < found; i++) {
+            onBeat(start + (long)lroundf(beats[i].offset * period));
+        }
+    
+        // The last good estimate stands while the quality is too low
+        oximeter.processBatch(red, ir, count);
+        float value = oximeter.getSpO2();
+        if (!isnan(value) && value != spo2) {
+            spo2 = value;
+            spo2Changed = true;
+        }
+    }
+    
+    // Only a detected beat yields a new rate
+    if (!newBeat) {
+        return false;
+    }
+    newBeat = false;
+    heartRate = beatsPerMinute;
+    return true;
+}
+
+void PulseOximeterSensor::onBeat(unsigned long timestamp) {
+    if (hrv.addBeat(timestamp)) {
+        hrvChanged = true;
+    }
+    
+    unsigned long delta = timestamp - lastBeatTime;
+    bool first = !hasBeat;
+    lastBeatTime = timestamp;
+    hasBeat = true;
+    if (first || delta == 0) {
+        return;
+    }
+    
+    float bpm = 60000000.0f / delta;
+    if (bpm < 200 && bpm > 20) {
+        beatsPerMinute = bpm;
+        newBeat = true;
+    }
+}
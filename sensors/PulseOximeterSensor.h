@@ -0,0 +1,102 @@
+#ifndef PULSE_OXIMETER_SENSOR_H
+#define PULSE_OXIMETER_SENSOR_H
+
+#include <Wire.h>
+#include <MAX30100.h>
+#include "sensors/SensorDriver.h"
+#include "sensors/HrvAnalyzer.h"
+#include "sensors/PpgBeatDetector.h"
+#include "sensors/SpO2Estimator.h"
+
+// MAX30100 from raw red/IR samples: the library's MAX30100 class only moves
+// FIFO samples; beats come from PpgBeatDetector and SpO2 from SpO2Estimator,
+// both timed on the sample clock
+class PulseOximeterSensor : public Emopod::Sensors::SensorDriver<PulseOximeterSensor, 10> {
+public:
+    static constexpr const char* NAME = "MAX30100";
+    static constexpr const char* KEY = "heartRate";
+    static constexpr unsigned long PERIOD_MS = 40;    // FIFO fills in 160 ms at 100 sps
+    static constexpr unsigned long COST_US = 1500;
+
+private:
+    friend class Emopod::Sensors::SensorDriver<PulseOximeterSensor, 10>;
+    
+    // OVF_COUNTER is read before each FIFO drain
+    static const uint8_t MAX30100_ADDRESS = 0x57;
+    static const uint8_t REG_OVF_COUNTER = 0x03;
+    static const int FIFO_DEPTH = 16;
+    static const uint16_t SAMPLE_RATE = 100;
+    
+    // 16-bit readings are scaled to the 18-bit MAX3010x range the
+    // estimators' absolute thresholds are written for
+    static const int SAMPLE_SHIFT = 2;
+    
+    // SpO2 = 110 - 25 R, the usual empirical line for the MAX30100; replace
+    // it with a per-device fit through getOximeter()
+    static constexpr Emopod::Sensors::SpO2Estimator::Calibration CALIBRATION = { 0.0f, -25.0f, 110.0f };
+    
+    MAX30100& sensor;
+    TwoWire& wire;
+    unsigned long lastSampleTime;
+    uint32_t lostSamples;
+    uint32_t overflowEvents;
+    
+    Emopod::Sensors::PpgBeatDetector beatDetector;
+    Emopod::Sensors::SpO2Estimator oximeter;
+    Emopod::Sensors::HrvAnalyzer hrv;
+    unsigned long lastBeatTime;   // micros(), sub-sample
+    bool hasBeat;
+    float beatsPerMinute;
+    bool newBeat;
+    float spo2;
+    bool spo2Changed;
+    bool hrvChanged;
+    
+    void onBeat(unsigned long timestamp);
+    
+    void beginDevice();
+    bool acquire(float& heartRate);
+
+public:
+    PulseOximeterSensor(MAX30100& device, TwoWire& wirePort = Wire)
+        : sensor(device), wire(wirePort), lastSampleTime(0), lostSamples(0), overflowEvents(0),
+          beatDetector(SAMPLE_RATE), oximeter(SAMPLE_RATE), lastBeatTime(0), hasBeat(false),
+          beatsPerMinute(NAN), newBeat(false), spo2(NAN), spo2Changed(false), hrvChanged(false) {}
+    
+    // Latest estimate that reached SpO2Estimator::QUALITY_THRESHOLD, NAN before one
+    float getSpO2() const { return spo2; }
+    
+    // SpO2 is revised independently of beats; returns and clears the change flag
+    bool takeSpO2Change() {
+        bool changed = spo2Changed;
+        spo2Changed = false;
+        return changed;
+    }
+    
+    Emopod::Sensors::SpO2Estimator& getOximeter() { return oximeter; }
+    const Emopod::Sensors::SpO2Estimator& getOximeter() const { return oximeter; }
+    const Emopod::Sensors::PpgBeatDetector& getBeatDetector() const { return beatDetector; }
+    
+    // Beat-to-beat variability, from the same sample-clock beat times
+    const Emopod::Sensors::HrvAnalyzer& getHrv() const { return hrv; }
+    
+    // True once per accepted beat; returns and clears the change flag
+    bool takeHrvChange() {
+        bool changed = hrvChanged;
+        hrvChanged = false;
+        return changed;
+    }
+    
+    // Samples the MAX30100 discarded because its FIFO was not drained in time
+    uint32_t getLostSamples() const { return lostSamples; }
+    uint32_t getOverflowEvents() const { return overflowEvents; }
+    
+    template <typename Document>
+    void serialize(Document& doc) const {
+        SensorDriver::serialize(doc);
+        doc["spO2"] = spo2;
+        hrv.serialize(doc);
+    }
+};
+
+#endif
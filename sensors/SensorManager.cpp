@@ -5,142 +5,286 @@ void SensorManager::begin() {
     
     // Initialize MPU6050
     if (!mpu.begin()) {
-        Serial.println("[ERROR] Failed to find MPU6050 chip");
+        LOG_ERROR(SENSOR, "Failed to find MPU6050 chip");
         while (1);
     }
-    mpu.setAccelerometerRange(MPU6050_RANGE_8_G);
-    mpu.setGyroRange(MPU6050_RANGE_500_DEG);
-    mpu.setFilterBandwidth(MPU6050_BAND_21_HZ);
-    Serial.println("[MPU6050] Initialized successfully");
+    sensors.get<MotionSensor>().setOutputRate(MOTION_ODR);
     
-    // Initialize Pulse Oximeter
-    if (!pox.begin()) {
-        Serial.println("[ERROR] Failed to find MAX30100 chip");
+    // Derived features (motion, breathing, sound) are left unscreened
+    sensors.get<PulseOximeterSensor>().setOutlierLimits(HR_LIMITS);
+    sensors.get<GSRSensor>().setConductanceLimits(CONDUCTANCE_LIMITS);
+    sensors.get<AmbientTemperatureSensor>().setOutlierLimits(TEMPERATURE_LIMITS);
+    sensors.get<AirQualitySensor>().setOutlierLimits(CO2_LIMITS);
+    
+    // Initialize the MAX30100; PulseOximeterSensor configures it
+    if (!max30100.begin()) {
+        LOG_ERROR(SENSOR, "Failed to find MAX30100 chip");
         while (1);
     }
-    pox.setIRLedCurrent(MAX30100_LED_CURR_7_6MA);
-    Serial.println("[MAX30100] Initialized successfully");
     
-    // Initialize DHT
-    dht.begin();
-    Serial.println("[DHT22] Initialized successfully");
+    // Configure every driver in the table
+    sensors.begin();
+    sensors.forEach([](auto& driver) {
+        LOG_INFO(SENSOR, "%s initialized successfully", driver.getName());
+    });
+    
+    // Start continuous capture of the analog channels
+    Emopod::Sensors::AdcChannelConfig adcChannels[Emopod::Sensors::ADC_CHANNEL_COUNT];
+    adcChannels[Emopod::Sensors::ADC_CHANNEL_MIC] = { MIC_PIN, 1 };
+    adcChannels[Emopod::Sensors::ADC_CHANNEL_GSR] = { GSR_PIN, GSR_DECIMATION };
+    adcChannels[Emopod::Sensors::ADC_CHANNEL_BREATHING] = { BREATH_PIN, BREATH_DECIMATION };
+    adcChannels[Emopod::Sensors::ADC_CHANNEL_AIR] = { MQ135_PIN, AIR_DECIMATION };
+    if (!adcCapture.begin(adcChannels, ADC_SAMPLE_RATE)) {
+        LOG_ERROR(ADC, "Failed to start ADC capture");
+    } else {
+        LOG_INFO(ADC, "Continuous capture running");
+    }
     
-    // Initialize MQ135
-    Serial.println("[MQ135] Initialized successfully");
+    // Register sampling jobs at each device's native rate
+    scheduler.addJob("ADC", ADC_PERIOD, ADC_COST, adcJob, this);
+    sensors.registerJobs(scheduler, this);
+    sensors.registerHealth(health);
+    for (int i = 0; i < ALIGNED_FIELD_COUNT; i++) {
+        aligner.configureChannel(i, ALIGNED_FIELDS[i].interpolation, ALIGNED_FIELDS[i].maxAgeMs);
+    }
     
-    // Calibrate sensors
+    // Baselines are learned from live readings; nothing blocks here
+    // (tolerance is the standard error of the mean each channel must reach)
+    calibrator.addChannel("GSR", CALIBRATION_MIN_SAMPLES, 0.05);          // uS
+    calibrator.addChannel("Temperature", CALIBRATION_MIN_SAMPLES, 0.05);  // C
+    calibrator.addChannel("CO2", CALIBRATION_MIN_SAMPLES, 10.0);          // ppm
+    calibrator.addChannel("HR", CALIBRATION_MIN_SAMPLES, 1.0);            // BPM
+    calibrator.addChannel("SpO2", CALIBRATION_MIN_SAMPLES, 0.5);          // %
     calibrate();
 }
 
 void SensorManager::update() {
-    unsigned long currentMillis = millis();
-    if (currentMillis - lastReadTime >= READ_INTERVAL) {
-        lastReadTime = currentMillis;
-        pox.update();
+    scheduler.run();
+    health.checkHealth();
+}
+
+bool SensorManager::markFresh(bool changed, uint16_t fieldBit) {
+    if (changed) {
+        freshFields |= fieldBit;
+        alignFields |= fieldBit;
     }
+    return changed;
 }
 
-SensorManager::SensorData SensorManager::readSensors() {
-    SensorData data;
-    
-    // Read heart rate and SpO2
-    float hr = pox.getHeartRate();
-    if (!isnan(hr) && hr > 0 && hr < 200) {
-        data.heartRate = hrAvg.addValue(hr);
-        Serial.printf("[HR] Heart rate: %.1f BPM\n", data.heartRate);
+// A new reading keeps its fields current even when their values held still
+void SensorManager::markSampled(bool fresh, uint16_t fieldBits) {
+    if (fresh) {
+        alignFields |= fieldBits;
     }
-    
-    float spo2 = pox.getSpO2();
-    if (!isnan(spo2) && spo2 > 0 && spo2 <= 100) {
-        data.spO2 = spo2;
-        Serial.printf("[SpO2] Oxygen saturation: %.1f%%\n", data.spO2);
+}
+
+uint16_t SensorManager::takeFreshFields() {
+    uint16_t fields = freshFields;
+    freshFields = 0;
+    return fields;
+}
+
+bool SensorManager::onSample(PulseOximeterSensor& driver, bool fresh, bool changed) {
+    if (fresh) {
+        addCalibrationSample(CAL_HR, driver.getRawValue());
     }
-    
-    // Read GSR
-    int gsrRaw = analogRead(GSR_PIN);
-    if (gsrRaw > 0) {
-        float gsrVoltage = (gsrRaw * 3.3) / 4095.0;
-        data.gsr = gsrAvg.addValue(gsrVoltage);
-        Serial.printf("[GSR] Skin conductance: %.2f uS\n", data.gsr);
+    markSampled(fresh, FRESH_HEART_RATE | FRESH_SPO2 | FRESH_HRV);
+    bool spo2Changed = driver.takeSpO2Change();
+    if (spo2Changed) {
+        addCalibrationSample(CAL_SPO2, driver.getSpO2());
     }
-    
-    // Read temperature
-    float temp = dht.readTemperature();
-    if (!isnan(temp) && temp > 0 && temp < 50) {
-        data.temperature = tempAvg.addValue(temp);
-        Serial.printf("[TEMP] Temperature: %.1f°C\n", data.temperature);
+    return markFresh(spo2Changed, FRESH_SPO2) | markFresh(driver.takeHrvChange(), FRESH_HRV) |
+           markFresh(changed, FRESH_HEART_RATE);
+}
+
+bool SensorManager::onSample(GSRSensor& driver, bool fresh, bool changed) {
+    if (fresh) {
+        addCalibrationSample(CAL_GSR, driver.getRawValue());
     }
-    
-    // Read CO2
-    float co2Raw = gasSensor.getPPM();
-    if (!isnan(co2Raw) && co2Raw > 0) {
-        data.co2 = co2Avg.addValue(co2Raw);
-        Serial.printf("[CO2] Concentration: %.1f ppm\n", data.co2);
+    markSampled(fresh, FRESH_GSR | FRESH_SCR);
+    return markFresh(driver.takeResponse(), FRESH_SCR) | markFresh(changed, FRESH_GSR);
+}
+
+bool SensorManager::onSample(AmbientTemperatureSensor& driver, bool fresh, bool changed) {
+    if (fresh) {
+        addCalibrationSample(CAL_TEMP, driver.getRawValue());
     }
-    
-    // Read motion
-    sensors_event_t a, g, temp;
-    if (mpu.getEvent(&a, &g, &temp)) {
-        float motion = sqrt(a.acceleration.x * a.acceleration.x +
-                           a.acceleration.y * a.acceleration.y +
-                           a.acceleration.z * a.acceleration.z);
-        data.motion = motionAvg.addValue(motion);
-        Serial.printf("[MOTION] Magnitude: %.2f m/s²\n", data.motion);
+    markSampled(fresh, FRESH_TEMPERATURE);
+    return markFresh(changed, FRESH_TEMPERATURE);
+}
+
+bool SensorManager::onSample(AirQualitySensor& driver, bool fresh, bool changed) {
+    if (fresh) {
+        addCalibrationSample(CAL_CO2, driver.getRawValue());
     }
+    markSampled(fresh, FRESH_CO2);
+    return markFresh(changed, FRESH_CO2);
+}
+
+bool SensorManager::onSample(MotionSensor& driver, bool fresh, bool changed) {
+    // Chest motion can stand in for the breathing belt
+    if (fresh) {
+        const MotionBatch& batch = driver.getBatch();
+        sensors.get<BreathingSensor>().addChestSamples(batch.accelZ, batch.count, batch.sampleRate);
+    }
+    markSampled(fresh, FRESH_MOTION);
+    return markFresh(changed, FRESH_MOTION);
+}
+
+bool SensorManager::onSample(BreathingSensor& driver, bool fresh, bool changed) {
+    markSampled(fresh, FRESH_BREATHING);
+    return markFresh(changed, FRESH_BREATHING);
+}
+
+bool SensorManager::onSample(MicrophoneSensor& driver, bool fresh, bool changed) {
+    markSampled(fresh, FRESH_SOUND);
+    return markFresh(changed, FRESH_SOUND);
+}
+
+SensorManager::SensorData SensorManager::snapshot() const {
+    SensorData data;
+    data.heartRate = sensors.get<PulseOximeterSensor>().getValue();
+    data.spO2 = sensors.get<PulseOximeterSensor>().getSpO2();
+    data.gsr = sensors.get<GSRSensor>().getValue();
+    const Emopod::Sensors::EdaAnalyzer::Features& eda = sensors.get<GSRSensor>().getEdaFeatures();
+    data.scrRate = eda.scrRate;
+    data.scrAmplitude = eda.meanAmplitude;
+    data.temperature = sensors.get<AmbientTemperatureSensor>().getValue();
+    data.co2 = sensors.get<AirQualitySensor>().getValue();
+    data.motion = sensors.get<MotionSensor>().getValue();
+    const Emopod::Sensors::MotionFusion::Features& motion = sensors.get<MotionSensor>().getMotionFeatures();
+    data.motionX = motion.linearRms[0];
+    data.motionY = motion.linearRms[1];
+    data.motionZ = motion.linearRms[2];
+    data.jerk = motion.jerk;
+    data.fidgetEnergy = motion.fidgetEnergy;
+    data.cadence = motion.cadence;
+    data.breathingRate = sensors.get<BreathingSensor>().getValue();
+    data.soundLevel = sensors.get<MicrophoneSensor>().getValue();
     
-    // Calculate breathing rate (placeholder - implement actual algorithm)
-    data.breathingRate = 15.0; // Default value
-    Serial.printf("[BREATH] Rate: %.1f BPM\n", data.breathingRate);
+    const Emopod::Sensors::SpectralAnalyzer::Features& spectrum =
+        sensors.get<MicrophoneSensor>().getSpectralFeatures();
+    data.spectralCentroid = spectrum.centroidHz;
+    data.pitchVariability = spectrum.pitchVariability;
     
-    // Read sound level (placeholder - implement actual microphone reading)
-    data.soundLevel = 0.0;
-    Serial.printf("[SOUND] Level: %.1f dB\n", data.soundLevel);
+    const Emopod::Sensors::HrvAnalyzer::Metrics& hrv =
+        sensors.get<PulseOximeterSensor>().getHrv().getMetrics();
+    data.rmssd = hrv.rmssd;
+    data.sdnn = hrv.sdnn;
+    data.pnn50 = hrv.pnn50;
+    data.lfHfRatio = hrv.lfHfRatio;
+    return data;
+}
+
+// The breathing rate only changes on a breath, up to the estimator's
+// longest interval apart, and is read ALIGNMENT_DELAY in the past
+static const uint32_t BREATHING_MAX_AGE =
+    (uint32_t)(Emopod::Sensors::BreathingEstimator::getMaxInterval() * 1000) + SensorManager::ALIGNMENT_DELAY + 3000;
+
+// Slow physiological levels are interpolated; features computed over a
+// window or per event hold. The age limits allow a few missed updates
+const SensorManager::AlignedFieldSpec SensorManager::ALIGNED_FIELDS[ALIGNED_FIELD_COUNT] = {
+    { &SensorData::heartRate, FRESH_HEART_RATE, Aligner::LINEAR, 5000 },
+    { &SensorData::spO2, FRESH_SPO2, Aligner::LINEAR, 5000 },
+    { &SensorData::gsr, FRESH_GSR, Aligner::LINEAR, 2000 },
+    { &SensorData::scrRate, FRESH_SCR, Aligner::HOLD, 2000 },
+    { &SensorData::scrAmplitude, FRESH_SCR, Aligner::HOLD, 2000 },
+    { &SensorData::temperature, FRESH_TEMPERATURE, Aligner::LINEAR, 10000 },
+    { &SensorData::co2, FRESH_CO2, Aligner::LINEAR, 10000 },
+    { &SensorData::motion, FRESH_MOTION, Aligner::HOLD, 1000 },
+    { &SensorData::motionX, FRESH_MOTION, Aligner::HOLD, 1000 },
+    { &SensorData::motionY, FRESH_MOTION, Aligner::HOLD, 1000 },
+    { &SensorData::motionZ, FRESH_MOTION, Aligner::HOLD, 1000 },
+    { &SensorData::jerk, FRESH_MOTION, Aligner::HOLD, 1000 },
+    { &SensorData::fidgetEnergy, FRESH_MOTION, Aligner::HOLD, 1000 },
+    { &SensorData::cadence, FRESH_MOTION, Aligner::HOLD, 1000 },
+    { &SensorData::breathingRate, FRESH_BREATHING, Aligner::LINEAR, BREATHING_MAX_AGE },
+    { &SensorData::soundLevel, FRESH_SOUND, Aligner::HOLD, 1000 },
+    { &SensorData::spectralCentroid, FRESH_SOUND, Aligner::HOLD, 1000 },
+    { &SensorData::pitchVariability, FRESH_SOUND, Aligner::HOLD, 1000 },
+    { &SensorData::rmssd, FRESH_HRV, Aligner::HOLD, 5000 },
+    { &SensorData::sdnn, FRESH_HRV, Aligner::HOLD, 5000 },
+    { &SensorData::pnn50, FRESH_HRV, Aligner::HOLD, 5000 },
+    { &SensorData::lfHfRatio, FRESH_HRV, Aligner::HOLD, 5000 }
+};
+
+void SensorManager::recordAligned(unsigned long time) {
+    SensorData data = snapshot();
+    for (int i = 0; i < ALIGNED_FIELD_COUNT; i++) {
+        if (alignFields & ALIGNED_FIELDS[i].freshField) {
+            aligner.addSample(i, time, data.*ALIGNED_FIELDS[i].field);
+        }
+    }
+    alignFields = 0;
+}
+
+void SensorManager::alignedSnapshot(unsigned long time, SensorData& data,
+                                    uint16_t ages[ALIGNED_FIELD_COUNT]) const {
+    for (int i = 0; i < ALIGNED_FIELD_COUNT; i++) {
+        uint32_t age;
+        data.*ALIGNED_FIELDS[i].field = aligner.valueAt(i, time, age);
+        ages[i] = age < AGE_UNKNOWN ? age : AGE_UNKNOWN;
+    }
+}
+
+void SensorManager::printData(const SensorData& data) {
+    // Routed through Logger so deferred mode keeps formatting off the caller
+    LOG_INFO(DATA, "Heart rate: %.1f BPM", data.heartRate);
+    LOG_INFO(DATA, "SpO2: %.1f%%", data.spO2);
+    LOG_INFO(DATA, "Skin conductance: %.2f uS, SCRs %.1f/min of %.2f uS",
+             data.gsr, data.scrRate, data.scrAmplitude);
+    LOG_INFO(DATA, "Temperature: %.1f°C", data.temperature);
+    LOG_INFO(DATA, "CO2: %.1f ppm", data.co2);
+    LOG_INFO(DATA, "Linear acceleration: %.2f m/s² (%.2f, %.2f, %.2f), jerk %.1f m/s³",
+             data.motion, data.motionX, data.motionY, data.motionZ, data.jerk);
+    LOG_INFO(DATA, "Fidget energy: %.3f, cadence: %.0f steps/min", data.fidgetEnergy, data.cadence);
+    LOG_INFO(DATA, "Breathing rate: %.1f BPM", data.breathingRate);
+    LOG_INFO(DATA, "Sound level: %.1f dB", data.soundLevel);
+    LOG_INFO(DATA, "Spectral centroid: %.0f Hz, pitch variability: %.1f Hz",
+             data.spectralCentroid, data.pitchVariability);
+    LOG_INFO(DATA, "HRV: RMSSD %.1f ms, SDNN %.1f ms, pNN50 %.1f%%, LF/HF %.2f",
+             data.rmssd, data.sdnn, data.pnn50, data.lfHfRatio);
+}
+
+SensorManager::SensorData SensorManager::readSensors() {
+    SensorData data = snapshot();
+    printData(data);
     
+    const PulseOximeterSensor& oximeter = sensors.get<PulseOximeterSensor>();
+    if (oximeter.getLostSamples() > 0) {
+        LOG_WARN(SENSOR, "MAX30100 FIFO overflows: %u, lost samples: %u",
+                 (unsigned)oximeter.getOverflowEvents(), (unsigned)oximeter.getLostSamples());
+    }
     return data;
 }
 
 void SensorManager::calibrate() {
-    Serial.println("[CALIBRATION] Starting sensor calibration...");
-    
-    const int CALIBRATION_SAMPLES = 100;
-    float sumGSR = 0, sumTemp = 0, sumCO2 = 0, sumHR = 0, sumSpO2 = 0;
-    int validSamples = 0;
+    calibrator.reset();
+    isCalibrated = false;
+    LOG_INFO(CALIBRATION, "Collecting baselines in the background");
+}
+
+void SensorManager::addCalibrationSample(CalibrationChannel channel, float value) {
+    if (!calibrator.addSample(channel, value)) {
+        return;
+    }
     
-    for (int i = 0; i < CALIBRATION_SAMPLES; i++) {
-        update();
-        SensorData data = readSensors();
-        
-        if (!isnan(data.gsr) && !isnan(data.temperature) && 
-            !isnan(data.co2) && !isnan(data.heartRate) && 
-            !isnan(data.spO2)) {
-            sumGSR += data.gsr;
-            sumTemp += data.temperature;
-            sumCO2 += data.co2;
-            sumHR += data.heartRate;
-            sumSpO2 += data.spO2;
-            validSamples++;
-        }
-        
-        delay(10);
+    float baseline = calibrator.getBaseline(channel);
+    switch (channel) {
+        case CAL_GSR:  calibration.baselineGSR = baseline; break;
+        case CAL_TEMP: calibration.baselineTemp = baseline; break;
+        case CAL_CO2:  calibration.baselineCO2 = baseline; break;
+        case CAL_HR:   calibration.baselineHR = baseline; break;
+        case CAL_SPO2: calibration.baselineSpO2 = baseline; break;
+        default: break;
     }
+    // Runs on the acquisition task; in deferred mode this only enqueues
+    LOG_INFO(CALIBRATION, "%s baseline: %.2f (%lu samples, %.0f%% overall)",
+             calibrator.getChannelName(channel), baseline,
+             calibrator.getSampleCount(channel), calibrator.getOverallProgress() * 100);
     
-    if (validSamples > 0) {
-        calibration.baselineGSR = sumGSR / validSamples;
-        calibration.baselineTemp = sumTemp / validSamples;
-        calibration.baselineCO2 = sumCO2 / validSamples;
-        calibration.baselineHR = sumHR / validSamples;
-        calibration.baselineSpO2 = sumSpO2 / validSamples;
-        
-        Serial.println("[CALIBRATION] Complete");
-        Serial.printf("[CALIBRATION] GSR baseline: %.2f uS\n", calibration.baselineGSR);
-        Serial.printf("[CALIBRATION] Temperature baseline: %.1f°C\n", calibration.baselineTemp);
-        Serial.printf("[CALIBRATION] CO2 baseline: %.1f ppm\n", calibration.baselineCO2);
-        Serial.printf("[CALIBRATION] HR baseline: %.1f BPM\n", calibration.baselineHR);
-        Serial.printf("[CALIBRATION] SpO2 baseline: %.1f%%\n", calibration.baselineSpO2);
-        
+    if (calibrator.isComplete()) {
         isCalibrated = true;
-    } else {
-        Serial.println("[ERROR] Calibration failed - no valid samples");
-        isCalibrated = false;
+        LOG_INFO(CALIBRATION, "Complete");
     }
-} 
\ No newline at end of file
+}
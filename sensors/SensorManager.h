@@ -4,17 +4,46 @@
 #include <Wire.h>
 #include <Adafruit_MPU6050.h>
 #include <Adafruit_Sensor.h>
-#include <MAX30100_PulseOximeter.h>
-#include <DHT.h>
-#include <MQ135.h>
+#include <MAX30100.h>
+#include "sensors/AdcCapture.h"
+#include "sensors/AcquisitionScheduler.h"
+#include "sensors/BaselineCalibrator.h"
+#include "sensors/SensorHealth.h"
+#include "sensors/SensorTable.h"
+#include "sensors/TimeAligner.h"
+#include "utils/Logger.h"
+#include "PulseOximeterSensor.h"
+#include "GSRSensor.h"
+#include "AmbientTemperatureSensor.h"
+#include "AirQualitySensor.h"
+#include "MotionSensor.h"
+#include "BreathingSensor.h"
+#include "MicrophoneSensor.h"
 
 class SensorManager {
 private:
-    // Sensor objects
+    // Every driver this build samples; jobs, health slots and JSON fields
+    // are all generated from this list
+    typedef Emopod::Sensors::SensorTable<
+        PulseOximeterSensor,
+        GSRSensor,
+        AmbientTemperatureSensor,
+        AirQualitySensor,
+        MotionSensor,
+        BreathingSensor,
+        MicrophoneSensor
+    > SensorSet;
+    friend SensorSet; // registers sampleJob<Driver>
+    
+    // Devices shared with their drivers
     Adafruit_MPU6050 mpu;
-    PulseOximeter pox;
-    DHT dht;
-    MQ135 gasSensor;
+    MAX30100 max30100;
+    
+    // Continuous capture of the analog channels, drained by the ADC drivers
+    Emopod::Sensors::AdcCapture adcCapture;
+    
+    SensorSet sensors;
+    Emopod::Sensors::SensorHealth health;
     
     // Calibration data
     struct CalibrationData {
@@ -25,156 +54,280 @@ private:
         float baselineSpO2;
     } calibration;
     
-    // Moving averages for smoothing
-    struct MovingAverage {
-        float values[10];
-        int index;
-        float sum;
-        
-        MovingAverage() : index(0), sum(0) {
-            for (int i = 0; i < 10; i++) values[i] = 0;
-        }
-        
-        float addValue(float value) {
-            sum -= values[index];
-            values[index] = value;
-            sum += value;
-            index = (index + 1) % 10;
-            return sum / 10;
-        }
+    // Baselines converge in the background from normal readings
+    enum CalibrationChannel {
+        CAL_GSR,
+        CAL_TEMP,
+        CAL_CO2,
+        CAL_HR,
+        CAL_SPO2,
+        CAL_CHANNEL_COUNT
     };
-    
-    MovingAverage hrAvg;
-    MovingAverage gsrAvg;
-    MovingAverage tempAvg;
-    MovingAverage co2Avg;
-    MovingAverage motionAvg;
+    static const unsigned long CALIBRATION_MIN_SAMPLES = 20;
+    Emopod::Sensors::BaselineCalibrator<CAL_CHANNEL_COUNT> calibrator;
     
     // Sensor pins
-    const int GSR_PIN = 34;
-    const int DHT_PIN = 35;
-    const int MQ135_PIN = 36;
+    static const int GSR_PIN = 34;
+    static const int DHT_PIN = 35;
+    static const int MQ135_PIN = 36;
+    static const int MIC_PIN = 39;
+    static const int BREATH_PIN = 33;
+    
+    // Capture rates
+    static const uint32_t ADC_SAMPLE_RATE = 8000;  // Hz per channel
+    static const uint16_t GSR_DECIMATION = 80;     // 100 Hz
+    static const uint16_t BREATH_DECIMATION = 160; // 50 Hz
+    static const uint16_t AIR_DECIMATION = 250;    // 32 Hz, one block per 2 s
+    static const uint16_t MOTION_ODR = 100;        // Hz
+    static const unsigned long DHT_INTERVAL = 2000;
+    
+    // Artifact rejection: Hampel threshold in MADs, its floor, and the
+    // fastest believable change (units/s)
+    static constexpr Emopod::Utils::OutlierLimits HR_LIMITS = { 3.0f, 5.0f, 10.0f };             // BPM
+    static constexpr Emopod::Utils::OutlierLimits CONDUCTANCE_LIMITS = { 4.0f, 0.05f, 5.0f };    // uS
+    static constexpr Emopod::Utils::OutlierLimits TEMPERATURE_LIMITS = { 3.0f, 0.3f, 0.5f };     // C
+    static constexpr Emopod::Utils::OutlierLimits CO2_LIMITS = { 3.0f, 50.0f, 100.0f };          // ppm
     
-    // Timing
-    unsigned long lastReadTime;
-    const unsigned long READ_INTERVAL = 100; // 100ms
+    // The DMA pool is moved into per-channel blocks by its own job; driver
+    // periods and costs come from each driver's constants
+    static const unsigned long ADC_PERIOD = 10;
+    static const unsigned long ADC_COST = 300;
+    
+    Emopod::Sensors::AcquisitionScheduler scheduler;
     
     bool isCalibrated;
     
+    static bool adcJob(void* self) {
+        static_cast<SensorManager*>(self)->adcCapture.poll();
+        return false;
+    }
+    
+    // Scheduler entry point for each driver in SensorSet
+    template <typename Driver>
+    static bool sampleJob(void* self) {
+        SensorManager* manager = static_cast<SensorManager*>(self);
+        Driver& driver = manager->sensors.template get<Driver>();
+        
+        uint32_t acquired = driver.getSampleCount();
+        uint32_t checked = driver.getCheckedCount();
+        uint32_t rejected = driver.getRejectedCount();
+        bool changed = driver.sample();
+        bool fresh = driver.getSampleCount() != acquired;
+        const int index = SensorSet::template indexOf<Driver>();
+        if (fresh) {
+            manager->health.updateSensor(index, driver.getRawValue());
+        }
+        if (driver.getCheckedCount() != checked) {
+            manager->health.recordScreening(index, driver.getCheckedCount() - checked,
+                                            driver.getRejectedCount() - rejected);
+        }
+        bool published = manager->onSample(driver, fresh, changed);
+        if (manager->alignFields != 0) {
+            manager->recordAligned(millis());
+        }
+        return published;
+    }
+    
+    // Per-driver follow-up to a sample: calibration feed and fresh-field bits.
+    // fresh: a raw value was acquired; changed: the smoothed value moved
+    bool onSample(PulseOximeterSensor& driver, bool fresh, bool changed);
+    bool onSample(GSRSensor& driver, bool fresh, bool changed);
+    bool onSample(AmbientTemperatureSensor& driver, bool fresh, bool changed);
+    bool onSample(AirQualitySensor& driver, bool fresh, bool changed);
+    bool onSample(MotionSensor& driver, bool fresh, bool changed);
+    bool onSample(BreathingSensor& driver, bool fresh, bool changed);
+    bool onSample(MicrophoneSensor& driver, bool fresh, bool changed);
+    
+    bool markFresh(bool changed, uint16_t fieldBit);
+    void markSampled(bool fresh, uint16_t fieldBits);
+    void recordAligned(unsigned long time);
+    void addCalibrationSample(CalibrationChannel channel, float value);
+    
 public:
     struct SensorData {
         float heartRate;
         float spO2;
-        float gsr;
+        float gsr;                // tonic level, uS
+        float scrRate;            // responses per minute
+        float scrAmplitude;       // uS
         float temperature;
         float co2;
-        float motion;
+        float motion;             // RMS linear acceleration, m/s^2
+        float motionX;            // per sensor axis, m/s^2
+        float motionY;
+        float motionZ;
+        float jerk;               // m/s^3
+        float fidgetEnergy;       // (m/s^2)^2
+        float cadence;            // steps per minute
         float breathingRate;
         float soundLevel;
+        float spectralCentroid;   // Hz
+        float pitchVariability;   // Hz
+        float rmssd;              // ms
+        float sdnn;               // ms
+        float pnn50;              // %
+        float lfHfRatio;
+    };
+    
+    // Bits of SensorData fields that changed since takeFreshFields()
+    enum FreshField {
+        FRESH_HEART_RATE = 1 << 0,
+        FRESH_SPO2 = 1 << 1,
+        FRESH_GSR = 1 << 2,
+        FRESH_TEMPERATURE = 1 << 3,
+        FRESH_CO2 = 1 << 4,
+        FRESH_MOTION = 1 << 5,
+        FRESH_BREATHING = 1 << 6,
+        FRESH_SOUND = 1 << 7,
+        FRESH_HRV = 1 << 8,
+        FRESH_SCR = 1 << 9
+    };
+    
+    // SensorData fields, in order, as aligner channels and age slots
+    enum AlignedField {
+        ALIGN_HEART_RATE,
+        ALIGN_SPO2,
+        ALIGN_GSR,
+        ALIGN_SCR_RATE,
+        ALIGN_SCR_AMPLITUDE,
+        ALIGN_TEMPERATURE,
+        ALIGN_CO2,
+        ALIGN_MOTION,
+        ALIGN_MOTION_X,
+        ALIGN_MOTION_Y,
+        ALIGN_MOTION_Z,
+        ALIGN_JERK,
+        ALIGN_FIDGET_ENERGY,
+        ALIGN_CADENCE,
+        ALIGN_BREATHING_RATE,
+        ALIGN_SOUND_LEVEL,
+        ALIGN_SPECTRAL_CENTROID,
+        ALIGN_PITCH_VARIABILITY,
+        ALIGN_RMSSD,
+        ALIGN_SDNN,
+        ALIGN_PNN50,
+        ALIGN_LF_HF_RATIO,
+        ALIGNED_FIELD_COUNT
     };
     
+    // How far behind now alignedSnapshot() looks: the slowest interpolated
+    // fields (CO2, temperature) update every 2 s
+    static const unsigned long ALIGNMENT_DELAY = 2000;   // ms
+    
+    // Field ages saturate here; also the age of a field never sampled
+    static const uint16_t AGE_UNKNOWN = 0xFFFF;
+    
     SensorManager() 
-        : dht(DHT_PIN, DHT22), gasSensor(MQ135_PIN),
-          lastReadTime(0), isCalibrated(false) {}
+        : sensors(PulseOximeterSensor(max30100),
+                  GSRSensor(GSR_PIN, &adcCapture),
+                  AmbientTemperatureSensor(DHT_PIN, DHT_INTERVAL),
+                  AirQualitySensor(MQ135_PIN, &adcCapture),
+                  MotionSensor(mpu),
+                  BreathingSensor(BREATH_PIN, &adcCapture),
+                  MicrophoneSensor(MIC_PIN, &adcCapture)),
+          isCalibrated(false), freshFields(0), alignFields(0),
+          aligner(ALIGNMENT_DELAY / (ALIGNMENT_DEPTH - 2)) {}
     
-    void begin() {
-        Wire.begin();
-        
-        // Initialize MPU6050
-        if (!mpu.begin()) {
-            Serial.println("Failed to find MPU6050 chip");
-            while (1);
-        }
-        mpu.setAccelerometerRange(MPU6050_RANGE_8_G);
-        mpu.setGyroRange(MPU6050_RANGE_500_DEG);
-        mpu.setFilterBandwidth(MPU6050_BAND_21_HZ);
-        
-        // Initialize Pulse Oximeter
-        if (!pox.begin()) {
-            Serial.println("Failed to find MAX30100 chip");
-            while (1);
-        }
-        pox.setIRLedCurrent(MAX30100_LED_CURR_7_6MA);
-        
-        // Initialize DHT
-        dht.begin();
-        
-        // Calibrate sensors
-        calibrate();
+    void begin();
+    
+    // Call every loop iteration: runs whichever sampling jobs are due
+    void update();
+    
+    // Latest published values; never touches the hardware
+    SensorData readSensors();
+    
+    // As readSensors(), without logging; cheap enough for the acquisition task
+    SensorData snapshot() const;
+    
+    // Every field resampled to `time` (millis(), up to ALIGNMENT_DELAY in
+    // the past): slow continuous fields are interpolated, the rest hold
+    // their last value, and fields older than their limit are NAN. ages
+    // gets each field's age at `time` in ms, indexed by AlignedField
+    void alignedSnapshot(unsigned long time, SensorData& data, uint16_t ages[ALIGNED_FIELD_COUNT]) const;
+    
+    static void printData(const SensorData& data);
+    
+    // One JSON field per driver, keyed by the driver's KEY
+    template <typename Document>
+    void serialize(Document& doc) const {
+        sensors.serialize(doc);
     }
     
-    void update() {
-        unsigned long currentMillis = millis();
-        if (currentMillis - lastReadTime >= READ_INTERVAL) {
-            lastReadTime = currentMillis;
-            pox.update();
-        }
+    // Same fields from a snapshot, for consumers on another task
+    template <typename Document>
+    static void serialize(const SensorData& data, Document& doc) {
+        doc[PulseOximeterSensor::KEY] = data.heartRate;
+        doc["spO2"] = data.spO2;
+        doc[GSRSensor::KEY] = data.gsr;
+        doc[GSRSensor::SCR_RATE_KEY] = data.scrRate;
+        doc[GSRSensor::SCR_AMPLITUDE_KEY] = data.scrAmplitude;
+        doc[AmbientTemperatureSensor::KEY] = data.temperature;
+        doc[AirQualitySensor::KEY] = data.co2;
+        doc[MotionSensor::KEY] = data.motion;
+        doc[MotionSensor::JERK_KEY] = data.jerk;
+        doc[MotionSensor::FIDGET_KEY] = data.fidgetEnergy;
+        doc[MotionSensor::CADENCE_KEY] = data.cadence;
+        doc[BreathingSensor::KEY] = data.breathingRate;
+        doc[MicrophoneSensor::KEY] = data.soundLevel;
+        doc[MicrophoneSensor::CENTROID_KEY] = data.spectralCentroid;
+        doc[MicrophoneSensor::PITCH_VARIABILITY_KEY] = data.pitchVariability;
+        doc[Emopod::Sensors::HrvAnalyzer::RMSSD_KEY] = data.rmssd;
+        doc[Emopod::Sensors::HrvAnalyzer::SDNN_KEY] = data.sdnn;
+        doc[Emopod::Sensors::HrvAnalyzer::PNN50_KEY] = data.pnn50;
+        doc[Emopod::Sensors::HrvAnalyzer::LF_HF_KEY] = data.lfHfRatio;
     }
     
-    SensorData readSensors() {
-        SensorData data;
-        
-        // Read heart rate and SpO2
-        data.heartRate = hrAvg.addValue(pox.getHeartRate());
-        data.spO2 = pox.getSpO2();
-        
-        // Read GSR
-        int gsrRaw = analogRead(GSR_PIN);
-        float gsrVoltage = (gsrRaw * 3.3) / 4095.0;
-        data.gsr = gsrAvg.addValue(gsrVoltage);
-        
-        // Read temperature
-        data.temperature = tempAvg.addValue(dht.readTemperature());
-        
-        // Read CO2
-        float co2Raw = gasSensor.getPPM();
-        data.co2 = co2Avg.addValue(co2Raw);
-        
-        // Read motion
-        sensors_event_t a, g, temp;
-        mpu.getEvent(&a, &g, &temp);
-        float motion = sqrt(a.acceleration.x * a.acceleration.x +
-                           a.acceleration.y * a.acceleration.y +
-                           a.acceleration.z * a.acceleration.z);
-        data.motion = motionAvg.addValue(motion);
-        
-        // Calculate breathing rate (placeholder - implement actual algorithm)
-        data.breathingRate = 15.0; // Default value
-        
-        // Read sound level (placeholder - implement actual microphone reading)
-        data.soundLevel = 0.0;
-        
-        return data;
+    // (Re)start background calibration; returns immediately
+    void calibrate();
+    
+    // 0..1 across all calibration channels
+    float getCalibrationProgress() const {
+        return calibrator.getOverallProgress();
     }
     
-    void calibrate() {
-        Serial.println("Calibrating sensors...");
-        
-        // Take multiple readings and average them
-        const int CALIBRATION_SAMPLES = 100;
-        float sumGSR = 0, sumTemp = 0, sumCO2 = 0, sumHR = 0, sumSpO2 = 0;
-        
-        for (int i = 0; i < CALIBRATION_SAMPLES; i++) {
-            update();
-            SensorData data = readSensors();
-            
-            sumGSR += data.gsr;
-            sumTemp += data.temperature;
-            sumCO2 += data.co2;
-            sumHR += data.heartRate;
-            sumSpO2 += data.spO2;
-            
-            delay(10);
-        }
-        
-        calibration.baselineGSR = sumGSR / CALIBRATION_SAMPLES;
-        calibration.baselineTemp = sumTemp / CALIBRATION_SAMPLES;
-        calibration.baselineCO2 = sumCO2 / CALIBRATION_SAMPLES;
-        calibration.baselineHR = sumHR / CALIBRATION_SAMPLES;
-        calibration.baselineSpO2 = sumSpO2 / CALIBRATION_SAMPLES;
-        
-        isCalibrated = true;
-        Serial.println("Calibration complete");
+    // Returns and clears the FreshField bits published since the last call
+    uint16_t takeFreshFields();
+    
+    const Emopod::Sensors::AcquisitionScheduler& getScheduler() const {
+        return scheduler;
+    }
+    
+    const Emopod::Sensors::AdcCapture& getAdcCapture() const {
+        return adcCapture;
+    }
+    
+    // Breathing belt, or chest motion from the MPU6050's Z axis (assumed
+    // normal to the chest)
+    void setBreathingSource(BreathingSensor::Source source) {
+        sensors.get<BreathingSensor>().setSource(source);
+    }
+    
+    // Share of one core spent in the sound level meter
+    float getSoundMeterLoad() const {
+        return sensors.get<MicrophoneSensor>().getMeterLoad();
+    }
+    
+    const Emopod::Sensors::SensorHealth& getHealth() const {
+        return health;
+    }
+    
+    // Raw values the driver has dropped as artifacts
+    template <typename Driver>
+    uint32_t getRejectedCount() const {
+        return health.getRejectedCount(SensorSet::template indexOf<Driver>());
+    }
+    
+    const MotionSensor::FifoStats& getMotionFifoStats() const {
+        return sensors.get<MotionSensor>().getFifoStats();
+    }
+    
+    // Samples the MAX30100 discarded because its FIFO was not drained in time
+    uint32_t getOximeterLostSamples() const {
+        return sensors.get<PulseOximeterSensor>().getLostSamples();
+    }
+    
+    uint32_t getOximeterOverflowEvents() const {
+        return sensors.get<PulseOximeterSensor>().getOverflowEvents();
     }
     
     bool isSensorCalibrated() const {
@@ -184,6 +337,23 @@ public:
     const CalibrationData& getCalibrationData() const {
         return calibration;
     }
+    
+private:
+    // Spacing keeps ALIGNMENT_DELAY of history for even the fastest field
+    static const int ALIGNMENT_DEPTH = 6;
+    typedef Emopod::Sensors::TimeAligner<ALIGNED_FIELD_COUNT, ALIGNMENT_DEPTH> Aligner;
+    
+    struct AlignedFieldSpec {
+        float SensorData::* field;
+        uint16_t freshField;       // FreshField group that updates it
+        Aligner::Interpolation interpolation;
+        uint32_t maxAgeMs;
+    };
+    static const AlignedFieldSpec ALIGNED_FIELDS[ALIGNED_FIELD_COUNT];
+    
+    uint16_t freshFields;
+    uint16_t alignFields;          // FreshField groups to record after this job
+    Aligner aligner;
 };
 
-#endif 
\ No newline at end of file
+#endif 
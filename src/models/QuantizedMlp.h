@@ -0,0 +1,244 @@
+#ifndef QUANTIZED_MLP_H
+#define QUANTIZED_MLP_H
+
+#include <math.h>
+#include <stdint.h>
+#include "utils/CycleCounter.h"
+#include "utils/FixedPoint.h"
+
+namespace Emopod {
+namespace Models {
+
+// Affine int8 quantization: real = scale * (q - zeroPoint)
+struct Quantization {
+    float scale;
+    int32_t zeroPoint;
+};
+
+/*
+ * DenseLayer - Constant data for one fully connected layer
+ *
+ * Weights are symmetric int8 with one scale per output channel, stored
+ * row by row ([outputs][inputs]). Biases are int32 in units of
+ * inputScale * weightScale, so they add straight into the accumulator.
+ * output quantizes the layer's result, which is the next layer's input.
+ * ReLU layers clamp at the output zero point (real 0).
+ */
+struct DenseLayer {
+    const int8_t* weights;
+    const float* weightScales;
+    const int32_t* bias;
+    Quantization output;
+    bool relu;
+};
+
+// Sizes derived from a layer size list: inputs, hidden..., outputs
+template <int... SIZES>
+struct MlpShape;
+
+template <int IN, int OUT>
+struct MlpShape<IN, OUT> {
+    static const int FIRST = IN;
+    static const int LAYERS = 1;
+    static const int MACS = IN * OUT;
+    static const int WIDEST = IN > OUT ? IN : OUT;
+    static const int OUTPUT_TOTAL = OUT;
+    static const int LAST = OUT;
+};
+
+template <int IN, int NEXT, int... REST>
+struct MlpShape<IN, NEXT, REST...> {
+    typedef MlpShape<NEXT, REST...> Tail;
+    static const int FIRST = IN;
+    static const int LAYERS = 1 + Tail::LAYERS;
+    static const int MACS = IN * NEXT + Tail::MACS;
+    static const int WIDEST = IN > Tail::WIDEST ? IN : Tail::WIDEST;
+    static const int OUTPUT_TOTAL = NEXT + Tail::OUTPUT_TOTAL;
+    static const int LAST = Tail::LAST;
+};
+
+/*
+ * QuantizedMlp - int8 inference for a fixed-shape MLP
+ *
+ * SIZES lists the layer widths, input first: QuantizedMlp<11, 16, 3> has
+ * one hidden layer and QuantizedMlp<11, 3> is a logistic model. Layer
+ * data is the caller's const arrays; on the ESP32 const data at namespace
+ * scope stays in flash, so only the per-output requantization multipliers
+ * and zero-point-folded biases (12 bytes per output) and two activation
+ * buffers on the stack use RAM.
+ *
+ * Each output is requantized from its int32 accumulator with a FixedScale
+ * multiplier, rounded and saturated to int8. There is no data-dependent
+ * control flow, so an inference always costs the same; MAC_COUNT gives
+ * the work at compile time and getStats() the measured cycles, counting
+ * runs over the budget given to the constructor.
+ *
+ * runReference() computes the same network in double from the dequantized
+ * weights, quantizing between layers; the integer path must agree with it
+ * exactly.
+ */
+template <int... SIZES>
+class QuantizedMlp {
+    typedef MlpShape<SIZES...> Shape;
+
+public:
+    static const int LAYER_COUNT = Shape::LAYERS;
+    static const int INPUTS = Shape::FIRST;
+    static const int OUTPUTS = Shape::LAST;
+    static const int MAC_COUNT = Shape::MACS;
+
+    struct Stats {
+        uint32_t inferences;
+        uint32_t lastCycles;
+        uint32_t maxCycles;
+        uint32_t overruns;      // inferences over the cycle budget
+    };
+
+private:
+    Quantization input;
+    const DenseLayer* layers;
+    Utils::FixedScale requantize[Shape::OUTPUT_TOTAL];
+    int32_t offsets[Shape::OUTPUT_TOTAL];     // bias - input zero point * row sum
+    uint32_t budgetCycles;
+    Stats stats;
+
+    static int8_t saturate(int32_t q, int32_t low) {
+        return (int8_t)(q > 127 ? 127 : (q < low ? low : q));
+    }
+
+    // One layer; restrict matters here, int8 stores may otherwise alias
+    // every pointer and force reloads on each output
+    static void dense(const int8_t* __restrict x, int inputs,
+                      const int8_t* __restrict weights, const int32_t* __restrict offset,
+                      const Utils::FixedScale* __restrict scale, int outputs,
+                      int32_t outZero, int32_t low, int8_t* __restrict y) {
+        for (int o = 0; o < outputs; o++, weights += inputs) {
+            int32_t acc = offset[o];
+            for (int i = 0; i < inputs; i++) {
+                acc += weights[i] * x[i];
+            }
+            y[o] = saturate(scale[o].apply(acc) + outZero, low);
+        }
+    }
+
+public:
+    // layers points at LAYER_COUNT layers; budget in Utils::cycleCount() units
+    QuantizedMlp(const Quantization& inputQuantization, const DenseLayer* layerData,
+                 uint32_t budget)
+        : input(inputQuantization), layers(layerData), budgetCycles(budget) {
+        static const int sizes[] = { SIZES... };
+        Quantization from = input;
+        int k = 0;
+        for (int l = 0; l < LAYER_COUNT; l++) {
+            const DenseLayer& layer = layers[l];
+            for (int o = 0; o < sizes[l + 1]; o++, k++) {
+                double ratio = (double)from.scale * layer.weightScales[o] / layer.output.scale;
+                requantize[k] = Utils::FixedScale::fromRatio(ratio);
+                int32_t rowSum = 0;
+                for (int i = 0; i < sizes[l]; i++) {
+                    rowSum += layer.weights[o * sizes[l] + i];
+                }
+                offsets[k] = layer.bias[o] - from.zeroPoint * rowSum;
+            }
+            from = layer.output;
+        }
+        resetStats();
+    }
+
+    // Round to nearest; NAN reads as 0
+    int8_t quantizeInput(float x) const {
+        if (isnan(x)) {
+            return (int8_t)input.zeroPoint;
+        }
+        float q = floorf(x / input.scale + 0.5f) + input.zeroPoint;
+        return (int8_t)(q > 127 ? 127 : (q < -128 ? -128 : q));
+    }
+
+    static float dequantize(int8_t q, const Quantization& quantization) {
+        return quantization.scale * (q - quantization.zeroPoint);
+    }
+
+    const Quantization& getInputQuantization() const { return input; }
+    const Quantization& getOutputQuantization() const { return layers[LAYER_COUNT - 1].output; }
+
+    // Integer inference: in[INPUTS] to out[OUTPUTS]
+    void run(const int8_t* in, int8_t* out) {
+        static const int sizes[] = { SIZES... };
+        uint32_t start = Utils::cycleCount();
+        int8_t buffers[2][Shape::WIDEST];
+        const int8_t* x = in;
+        int k = 0;
+        for (int l = 0; l < LAYER_COUNT; l++) {
+            const DenseLayer& layer = layers[l];
+            int outputs = sizes[l + 1];
+            int8_t* y = l == LAYER_COUNT - 1 ? out : buffers[l & 1];
+            int32_t outZero = layer.output.zeroPoint;
+            dense(x, sizes[l], layer.weights, offsets + k, requantize + k, outputs,
+                  outZero, layer.relu ? outZero : -128, y);
+            k += outputs;
+            x = y;
+        }
+
+        uint32_t cycles = Utils::cycleCount() - start;
+        stats.inferences++;
+        stats.lastCycles = cycles;
+        if (cycles > stats.maxCycles) {
+            stats.maxCycles = cycles;
+        }
+        if (cycles > budgetCycles) {
+            stats.overruns++;
+        }
+    }
+
+    // Float input, quantized first
+    void infer(const float* x, int8_t* out) {
+        int8_t q[INPUTS];
+        for (int i = 0; i < INPUTS; i++) {
+            q[i] = quantizeInput(x[i]);
+        }
+        run(q, out);
+    }
+
+    // Floating-point reference for run(): the layers computed in double
+    // from the dequantized weights and inputs, quantized between layers
+    void runReference(const int8_t* in, int8_t* out) const {
+        static const int sizes[] = { SIZES... };
+        int8_t buffers[2][Shape::WIDEST];
+        const int8_t* x = in;
+        Quantization from = input;
+        for (int l = 0; l < LAYER_COUNT; l++) {
+            const DenseLayer& layer = layers[l];
+            int inputs = sizes[l];
+            int8_t* y = l == LAYER_COUNT - 1 ? out : buffers[l & 1];
+            for (int o = 0; o < sizes[l + 1]; o++) {
+                double weightScale = layer.weightScales[o];
+                double sum = layer.bias[o] * (from.scale * weightScale);
+                for (int i = 0; i < inputs; i++) {
+                    sum += (weightScale * layer.weights[o * inputs + i]) *
+                           ((double)from.scale * (x[i] - from.zeroPoint));
+                }
+                if (layer.relu && sum < 0) {
+                    sum = 0;
+                }
+                double q = floor(sum / layer.output.scale + 0.5) + layer.output.zeroPoint;
+                y[o] = (int8_t)(q > 127 ? 127 : (q < -128 ? -128 : q));
+            }
+            x = y;
+            from = layer.output;
+        }
+    }
+
+    const Stats& getStats() const { return stats; }
+
+    void resetStats() {
+        stats.inferences = 0;
+        stats.lastCycles = 0;
+        stats.maxCycles = 0;
+        stats.overruns = 0;
+    }
+};
+
+} // namespace Models
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef STRESS_NETWORK_H
+#define STRESS_NETWORK_H
+
+#include "models/QuantizedMlp.h"
+
+namespace Emopod {
+namespace Models {
+
+/*
+ * StressNetwork - int8 weights for the stress classifier
+ *
+ * Inputs are the features in StressFeature order, each normalized as
+ * (x - threshold) / scale (RMSSD as (threshold - x) / threshold), 0 when
+ * missing, and quantized at 1/32 over [-4, 4). The hidden layer is the
+ * ReLU of each feature. The three outputs are ordinal logits, one per
+ * boundary (mild, moderate, high); the state is the number of logits
+ * at or above zero, as the weighted sum counts cutoffs the score reaches.
+ *
+ * These weights transcribe the weighted-sum rule: the output rows hold the
+ * per-feature weights and the biases the 0.3/0.5/0.7 cutoffs. A trained
+ * model replaces the arrays below with the same shapes.
+ */
+enum StressFeature {
+    FEATURE_HEART_RATE,
+    FEATURE_GSR,
+    FEATURE_SCR_RATE,
+    FEATURE_SCR_AMPLITUDE,
+    FEATURE_TEMPERATURE,
+    FEATURE_CO2,
+    FEATURE_BREATHING_RATE,
+    FEATURE_MOTION,
+    FEATURE_SOUND_LEVEL,
+    FEATURE_RMSSD,
+    FEATURE_LF_HF_RATIO,
+    STRESS_FEATURE_COUNT
+};
+
+static const int STRESS_HIDDEN = 11;
+static const int STRESS_LOGITS = 3;
+
+typedef QuantizedMlp<STRESS_FEATURE_COUNT, STRESS_HIDDEN, STRESS_LOGITS> StressNetwork;
+
+constexpr Quantization STRESS_INPUT = { 1.0f / 32, 0 };
+
+constexpr int8_t STRESS_HIDDEN_WEIGHTS[STRESS_HIDDEN][STRESS_FEATURE_COUNT] = {
+    { 127,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0, 127,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0, 127,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0, 127,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0, 127,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0, 127,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0, 127,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0, 127,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0, 127,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0, 127,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 127 }
+};
+
+constexpr float STRESS_HIDDEN_SCALES[STRESS_HIDDEN] = {
+    1.0f / 127, 1.0f / 127, 1.0f / 127, 1.0f / 127, 1.0f / 127, 1.0f / 127,
+    1.0f / 127, 1.0f / 127, 1.0f / 127, 1.0f / 127, 1.0f / 127
+};
+
+constexpr int32_t STRESS_HIDDEN_BIAS[STRESS_HIDDEN] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+// Per-feature weights / (0.25 / 127): 0.25 0.20 0.10 0.05 0.15 0.10 0.15 0.10 0.05 0.20 0.10
+constexpr int8_t STRESS_OUTPUT_WEIGHTS[STRESS_LOGITS][STRESS_HIDDEN] = {
+    { 127, 102, 51, 25, 76, 51, 76, 51, 25, 102, 51 },
+    { 127, 102, 51, 25, 76, 51, 76, 51, 25, 102, 51 },
+    { 127, 102, 51, 25, 76, 51, 76, 51, 25, 102, 51 }
+};
+
+constexpr float STRESS_OUTPUT_SCALES[STRESS_LOGITS] = { 0.25f / 127, 0.25f / 127, 0.25f / 127 };
+
+// -cutoff / (hidden scale * output weight scale)
+constexpr int32_t STRESS_OUTPUT_BIAS[STRESS_LOGITS] = { -9754, -16256, -22758 };
+
+// Logits saturate at +-1/8; only their sign is used
+constexpr DenseLayer STRESS_LAYERS[StressNetwork::LAYER_COUNT] = {
+    { &STRESS_HIDDEN_WEIGHTS[0][0], STRESS_HIDDEN_SCALES, STRESS_HIDDEN_BIAS, { 1.0f / 64, -128 }, true },
+    { &STRESS_OUTPUT_WEIGHTS[0][0], STRESS_OUTPUT_SCALES, STRESS_OUTPUT_BIAS, { 1.0f / 1024, 0 }, false }
+};
+
+} // namespace Models
+} // namespace Emopod
+
+#endif
@@ -34,7 +34,7 @@ void NetworkManager::update() {
 
 bool NetworkManager::sendData(const JsonDocument& doc) {
     if (WiFi.status() != WL_CONNECTED) {
-        Logger::warn("NETWORK", "WiFi not connected, buffering data");
+        LOG_WARN(NETWORK, "WiFi not connected, buffering data");
         return dataBuffer->addData(doc);
     }
     
@@ -45,26 +45,26 @@ bool NetworkManager::sendData(const JsonDocument& doc) {
     
     String jsonString;
     if (serializeJson(doc, jsonString) == 0) {
-        Logger::error("NETWORK", "Failed to serialize JSON");
+        LOG_ERROR(NETWORK, "Failed to serialize JSON");
         return false;
     }
     
-    Logger::debug("NETWORK", "Sending data to %s", serverUrl);
+    LOG_DEBUG(NETWORK, "Sending data to %s", serverUrl);
     int httpResponseCode = http.POST(jsonString);
     
     if (httpResponseCode > 0) {
         String response = http.getString();
-        Logger::info("NETWORK", "Response code: %d", httpResponseCode);
-        Logger::debug("NETWORK", "Response: %s", response.c_str());
+        LOG_INFO(NETWORK, "Response code: %d", httpResponseCode);
+        LOG_DEBUG(NETWORK, "Response: %s", response.c_str());
         failedAttempts = 0;
         http.end();
         return true;
     } else {
-        Logger::error("NETWORK", "HTTP POST failed, error: %s", http.errorToString(httpResponseCode).c_str());
+        LOG_ERROR(NETWORK, "HTTP POST failed, error: %s", http.errorToString(httpResponseCode).c_str());
         failedAttempts++;
         
         if (failedAttempts >= MAX_FAILED_ATTEMPTS) {
-            Logger::warn("NETWORK", "Too many failed attempts, buffering data");
+            LOG_WARN(NETWORK, "Too many failed attempts, buffering data");
             dataBuffer->addData(doc);
             WiFi.disconnect();
             isConnected = false;
@@ -81,7 +81,7 @@ bool NetworkManager::isWiFiConnected() const {
 }
 
 void NetworkManager::connect() {
-    Logger::info("NETWORK", "Connecting to WiFi...");
+    LOG_INFO(NETWORK, "Connecting to WiFi...");
     WiFi.begin(ssid, password);
     
     int attempts = 0;
@@ -92,11 +92,11 @@ void NetworkManager::connect() {
     }
     
     if (WiFi.status() == WL_CONNECTED) {
-        Logger::info("NETWORK", "Connected to WiFi");
-        Logger::info("NETWORK", "IP address: %s", WiFi.localIP().toString().c_str());
+        LOG_INFO(NETWORK, "Connected to WiFi");
+        LOG_INFO(NETWORK, "IP address: %s", WiFi.localIP().toString().c_str());
         isConnected = true;
     } else {
-        Logger::error("NETWORK", "Failed to connect to WiFi");
+        LOG_ERROR(NETWORK, "Failed to connect to WiFi");
         isConnected = false;
     }
 }
@@ -0,0 +1,134 @@
+#include "AcquisitionScheduler.h"
+#include "utils/Logger.h"
+
+namespace Emopod {
+namespace Sensors {
+
+int AcquisitionScheduler::addJob(const char* name, unsigned long periodMs, unsigned long costUs,
+                                 SampleFn sample, void* context) {
+    if (jobCount >= MAX_JOBS || sample == nullptr || periodMs == 0) {
+        return -1;
+    }
+
+    Job& job = jobs[jobCount];
+    job.name = name;
+    job.periodUs = periodMs * 1000UL;
+    job.costUs = costUs;
+    job.nextDueUs = micros();
+    job.sample = sample;
+    job.context = context;
+    job.stats = JobStats();
+    return jobCount++;
+}
+
+int AcquisitionScheduler::findMostOverdue(unsigned long now) const {
+    int best = -1;
+    long bestLateness = -1;
+    for (int i = 0; i < jobCount; i++) {
+        long lateness = (long)(now - jobs[i].nextDueUs);
+        if (lateness >= 0 && lateness > bestLateness) {
+            best = i;
+            bestLateness = lateness;
+        }
+    }
+    return best;
+}
+
+int AcquisitionScheduler::run() {
+    unsigned long passStart = micros();
+    unsigned long now = passStart;
+    int started = 0;
+
+    for (int i = 0; i < jobCount; i++) {
+        int index = findMostOverdue(now);
+        if (index < 0) {
+            break;
+        }
+
+        // Keep the pass bounded: a job that would not fit waits for the next
+        // pass, except the first one so that expensive jobs still make progress
+        Job& job = jobs[index];
+        unsigned long spent = now - passStart;
+        if (started > 0 && spent + job.costUs > budgetUs) {
+            break;
+        }
+
+        runJob(job, now);
+        started++;
+        now = micros();
+    }
+    return started;
+}
+
+void AcquisitionScheduler::runJob(Job& job, unsigned long now) {
+    JobStats& stats = job.stats;
+    unsigned long jitter = now - job.nextDueUs;
+
+    bool changed = job.sample(job.context);
+    unsigned long cost = micros() - now;
+
+    stats.runs++;
+    if (changed) {
+        stats.published++;
+    }
+    if (cost > job.costUs) {
+        stats.overruns++;
+    }
+    stats.lastCostUs = cost;
+    if (cost > stats.maxCostUs) {
+        stats.maxCostUs = cost;
+    }
+    stats.lastJitterUs = jitter;
+    stats.totalJitterUs += jitter;
+    if (jitter > stats.maxJitterUs) {
+        stats.maxJitterUs = jitter;
+    }
+
+    // Stay on the original phase; if whole periods were lost, skip past them
+    // rather than firing a burst of catch-up runs
+    job.nextDueUs += job.periodUs;
+    if ((long)(now - job.nextDueUs) >= 0) {
+        unsigned long missed = (now - job.nextDueUs) / job.periodUs + 1;
+        stats.missedPeriods += missed;
+        job.nextDueUs += missed * job.periodUs;
+    }
+}
+
+void AcquisitionScheduler::triggerAll() {
+    unsigned long now = micros();
+    for (int i = 0; i < jobCount; i++) {
+        jobs[i].nextDueUs = now;
+    }
+}
+
+const char* AcquisitionScheduler::getJobName(int index) const {
+    return (index >= 0 && index < jobCount) ? jobs[index].name : nullptr;
+}
+
+unsigned long AcquisitionScheduler::getJobPeriodMs(int index) const {
+    return (index >= 0 && index < jobCount) ? jobs[index].periodUs / 1000UL : 0;
+}
+
+const AcquisitionScheduler::JobStats* AcquisitionScheduler::getJobStats(int index) const {
+    return (index >= 0 && index < jobCount) ? &jobs[index].stats : nullptr;
+}
+
+void AcquisitionScheduler::resetStats() {
+    for (int i = 0; i < jobCount; i++) {
+        jobs[i].stats = JobStats();
+    }
+}
+
+void AcquisitionScheduler::logStats() const {
+    for (int i = 0; i < jobCount; i++) {
+        const JobStats& stats = jobs[i].stats;
+        LOG_INFO(SCHED, "%s: runs %u, fresh %u, jitter mean/max %lu/%lu us, "
+                 "cost max %lu us, overruns %u, missed %u",
+                 jobs[i].name, (unsigned)stats.runs, (unsigned)stats.published,
+                 stats.meanJitterUs(), stats.maxJitterUs, stats.maxCostUs,
+                 (unsigned)stats.overruns, (unsigned)stats.missedPeriods);
+    }
+}
+
+} // namespace Sensors
+} // namespace Emopod
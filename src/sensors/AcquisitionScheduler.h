@@ -0,0 +1,84 @@
+#ifndef ACQUISITION_SCHEDULER_H
+#define ACQUISITION_SCHEDULER_H
+
+#include <Arduino.h>
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * AcquisitionScheduler - Runs each sensor's sampling job at its native rate
+ *
+ * Every job declares a period and an expected cost. run() is called from the
+ * main loop; it starts due jobs most-overdue first and keeps each pass inside
+ * a time budget, so one slow device cannot push every other job late. Jobs
+ * keep a fixed phase (next due = previous due + period) and report whether
+ * they published a changed value.
+ */
+class AcquisitionScheduler {
+public:
+    // Returns true when the job published a value that differs from the last one
+    typedef bool (*SampleFn)(void* context);
+
+    struct JobStats {
+        uint32_t runs;
+        uint32_t published;        // runs that produced a changed value
+        uint32_t overruns;         // runs that took longer than the declared cost
+        uint32_t missedPeriods;    // whole periods skipped because the job was late
+        unsigned long maxJitterUs; // worst start delay after the due time
+        unsigned long lastJitterUs;
+        unsigned long maxCostUs;
+        unsigned long lastCostUs;
+        uint64_t totalJitterUs;
+
+        unsigned long meanJitterUs() const {
+            return runs > 0 ? (unsigned long)(totalJitterUs / runs) : 0;
+        }
+    };
+
+private:
+    struct Job {
+        const char* name;
+        unsigned long periodUs;
+        unsigned long costUs;
+        unsigned long nextDueUs;
+        SampleFn sample;
+        void* context;
+        JobStats stats;
+    };
+
+    static const int MAX_JOBS = 10;
+    Job jobs[MAX_JOBS];
+    int jobCount;
+    unsigned long budgetUs;
+
+    int findMostOverdue(unsigned long now) const;
+    void runJob(Job& job, unsigned long now);
+
+public:
+    // budgetUs bounds the time one run() pass may spend starting jobs
+    explicit AcquisitionScheduler(unsigned long budgetUs = 5000)
+        : jobCount(0), budgetUs(budgetUs) {}
+
+    // Returns the job index, or -1 if the table is full
+    int addJob(const char* name, unsigned long periodMs, unsigned long costUs,
+               SampleFn sample, void* context);
+
+    // Start every job that is due and fits the remaining budget
+    int run();
+
+    // Make every job due on the next run()
+    void triggerAll();
+
+    int getJobCount() const { return jobCount; }
+    const char* getJobName(int index) const;
+    unsigned long getJobPeriodMs(int index) const;
+    const JobStats* getJobStats(int index) const;
+    void resetStats();
+    void logStats() const;
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
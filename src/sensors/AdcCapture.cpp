@@ -0,0 +1,327 @@
+#include "AdcCapture.h"
+
+#ifdef ARDUINO
+#include "utils/Logger.h"
+#else
+#include <chrono>
+#include <math.h>
+#endif
+
+namespace Emopod {
+namespace Sensors {
+
+#ifdef ARDUINO
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define ADC_CAPTURE_OUTPUT_FORMAT ADC_DIGI_OUTPUT_FORMAT_TYPE1
+#define ADC_CAPTURE_GET_CHANNEL(result) ((result)->type1.channel)
+#define ADC_CAPTURE_GET_DATA(result) ((result)->type1.data)
+#else
+#define ADC_CAPTURE_OUTPUT_FORMAT ADC_DIGI_OUTPUT_FORMAT_TYPE2
+#define ADC_CAPTURE_GET_CHANNEL(result) ((result)->type2.channel)
+#define ADC_CAPTURE_GET_DATA(result) ((result)->type2.data)
+#endif
+
+static unsigned long nowMicros() {
+    return micros();
+}
+#else
+static unsigned long nowMicros() {
+    using namespace std::chrono;
+    return (unsigned long)duration_cast<microseconds>(
+        steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+AdcCapture::AdcCapture()
+    : rawRatePerChannel(0), driverOverruns(0), pollTimestamp(0), running(false)
+#ifdef ARDUINO
+    , handle(nullptr)
+#else
+    , fakeSource(nullptr), lastFakePoll(0)
+#endif
+{
+    for (int i = 0; i < ADC_CHANNEL_COUNT; i++) {
+        channels[i].config.pin = -1;
+        channels[i].config.decimation = 1;
+        resetChannel(channels[i]);
+    }
+}
+
+AdcCapture::~AdcCapture() {
+    end();
+}
+
+void AdcCapture::resetChannel(ChannelState& channel) {
+    channel.blocks.clear();
+    channel.pending.count = 0;
+    channel.pending.firstSample = 0;
+    channel.decimationSum = 0;
+    channel.decimationCount = 0;
+    channel.nextSample = 0;
+    channel.stats.samplesCaptured = 0;
+    channel.stats.blocksCaptured = 0;
+    channel.stats.blocksDropped = 0;
+}
+
+bool AdcCapture::begin(const AdcChannelConfig configs[ADC_CHANNEL_COUNT], uint32_t sampleRateHz) {
+    end();
+
+    int enabledCount = 0;
+    for (int i = 0; i < ADC_CHANNEL_COUNT; i++) {
+        channels[i].config = configs[i];
+        if (channels[i].config.decimation == 0) {
+            channels[i].config.decimation = 1;
+        }
+        resetChannel(channels[i]);
+        if (channels[i].config.pin >= 0) {
+            enabledCount++;
+        }
+    }
+    if (enabledCount == 0 || sampleRateHz == 0) {
+        return false;
+    }
+
+    rawRatePerChannel = sampleRateHz;
+    driverOverruns = 0;
+
+#ifdef ARDUINO
+    for (int i = 0; i < MAX_HW_CHANNELS; i++) {
+        channelMap[i] = -1;
+    }
+
+    adc_continuous_handle_cfg_t handleConfig = {};
+    handleConfig.max_store_buf_size = FRAME_BYTES * 16;
+    handleConfig.conv_frame_size = FRAME_BYTES;
+    if (adc_continuous_new_handle(&handleConfig, &handle) != ESP_OK) {
+        LOG_ERROR(ADC, "Failed to allocate continuous ADC driver");
+        handle = nullptr;
+        return false;
+    }
+
+    adc_digi_pattern_config_t pattern[ADC_CHANNEL_COUNT] = {};
+    int patternCount = 0;
+    for (int i = 0; i < ADC_CHANNEL_COUNT; i++) {
+        if (channels[i].config.pin < 0) {
+            continue;
+        }
+        adc_unit_t unit;
+        adc_channel_t hwChannel;
+        if (adc_continuous_io_to_channel(channels[i].config.pin, &unit, &hwChannel) != ESP_OK ||
+            unit != ADC_UNIT_1) {
+            LOG_ERROR(ADC, "Pin %d is not an ADC1 input", channels[i].config.pin);
+            end();
+            return false;
+        }
+        pattern[patternCount].atten = ADC_ATTEN_DB_11;
+        pattern[patternCount].channel = hwChannel & 0x7;
+        pattern[patternCount].unit = unit;
+        pattern[patternCount].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+        channelMap[hwChannel] = i;
+        patternCount++;
+    }
+
+    adc_continuous_config_t config = {};
+    config.pattern_num = patternCount;
+    config.adc_pattern = pattern;
+    config.sample_freq_hz = sampleRateHz * patternCount;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_CAPTURE_OUTPUT_FORMAT;
+    if (adc_continuous_config(handle, &config) != ESP_OK) {
+        LOG_ERROR(ADC, "Unsupported scan rate %u Hz", (unsigned)config.sample_freq_hz);
+        end();
+        return false;
+    }
+
+    adc_continuous_evt_cbs_t callbacks = {};
+    callbacks.on_pool_ovf = onPoolOverflow;
+    adc_continuous_register_event_callbacks(handle, &callbacks, this);
+
+    if (adc_continuous_start(handle) != ESP_OK) {
+        LOG_ERROR(ADC, "Failed to start continuous ADC");
+        end();
+        return false;
+    }
+
+    LOG_INFO(ADC, "Capturing %d channels at %u Hz each",
+             patternCount, (unsigned)sampleRateHz);
+#else
+    lastFakePoll = nowMicros();
+#endif
+
+    running = true;
+    return true;
+}
+
+void AdcCapture::end() {
+#ifdef ARDUINO
+    if (handle != nullptr) {
+        if (running) {
+            adc_continuous_stop(handle);
+        }
+        adc_continuous_deinit(handle);
+        handle = nullptr;
+    }
+#endif
+    running = false;
+}
+
+#ifdef ARDUINO
+bool IRAM_ATTR AdcCapture::onPoolOverflow(adc_continuous_handle_t handle,
+                                          const adc_continuous_evt_data_t* event, void* userData) {
+    static_cast<AdcCapture*>(userData)->driverOverruns++;
+    return false;
+}
+#endif
+
+void AdcCapture::poll() {
+    if (!running) {
+        return;
+    }
+    pollTimestamp = nowMicros();
+
+#ifdef ARDUINO
+    uint8_t frame[FRAME_BYTES];
+    uint32_t length = 0;
+    while (adc_continuous_read(handle, frame, sizeof(frame), &length, 0) == ESP_OK) {
+        for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+            const adc_digi_output_data_t* result = (const adc_digi_output_data_t*)&frame[i];
+            uint32_t hwChannel = ADC_CAPTURE_GET_CHANNEL(result);
+            if (hwChannel < MAX_HW_CHANNELS && channelMap[hwChannel] >= 0) {
+                pushRaw((AdcChannel)channelMap[hwChannel], ADC_CAPTURE_GET_DATA(result));
+            }
+        }
+    }
+#else
+    if (fakeSource != nullptr) {
+        // Generate whatever the hardware would have produced since the last poll
+        unsigned long elapsed = pollTimestamp - lastFakePoll;
+        uint32_t frames = (uint32_t)((uint64_t)elapsed * fakeSource->getSampleRate() / 1000000UL);
+        if (frames > 0) {
+            lastFakePoll += (unsigned long)((uint64_t)frames * 1000000UL / fakeSource->getSampleRate());
+            fakeSource->produce(*this, frames);
+        }
+    }
+#endif
+}
+
+void AdcCapture::pushRaw(AdcChannel channelIndex, uint16_t raw) {
+    ChannelState& channel = channels[channelIndex];
+    if (channel.config.pin < 0) {
+        return;
+    }
+
+    channel.decimationSum += raw;
+    if (++channel.decimationCount < channel.config.decimation) {
+        return;
+    }
+
+    AdcBlock& block = channel.pending;
+    if (block.count == 0) {
+        block.firstSample = channel.nextSample;
+    }
+    block.samples[block.count++] = (uint16_t)(channel.decimationSum / channel.decimationCount);
+    channel.decimationSum = 0;
+    channel.decimationCount = 0;
+    channel.nextSample++;
+    channel.stats.samplesCaptured++;
+
+    if (block.count == AdcBlock::SIZE) {
+        block.sampleRate = getSampleRate(channelIndex);
+        block.timestamp = pollTimestamp;
+        if (channel.blocks.push(block)) {
+            channel.stats.blocksCaptured++;
+        } else {
+            channel.stats.blocksDropped++;
+        }
+        block.count = 0;
+    }
+}
+
+bool AdcCapture::readBlock(AdcChannel channel, AdcBlock& block) {
+    return channels[channel].blocks.pop(block);
+}
+
+int AdcCapture::availableBlocks(AdcChannel channel) const {
+    return channels[channel].blocks.size();
+}
+
+const AdcChannelStats& AdcCapture::getStats(AdcChannel channel) const {
+    return channels[channel].stats;
+}
+
+uint32_t AdcCapture::getDriverOverruns() const {
+    return driverOverruns;
+}
+
+uint32_t AdcCapture::getSampleRate(AdcChannel channel) const {
+    return rawRatePerChannel / channels[channel].config.decimation;
+}
+
+bool AdcCapture::isChannelEnabled(AdcChannel channel) const {
+    return channels[channel].config.pin >= 0;
+}
+
+bool AdcCapture::isRunning() const {
+    return running;
+}
+
+#ifndef ARDUINO
+void AdcCapture::attachSource(FakeAdcSource* source) {
+    fakeSource = source;
+    lastFakePoll = nowMicros();
+}
+
+FakeAdcSource::FakeAdcSource(uint32_t seed)
+    : sampleRate(8000), frameIndex(0), randomState(seed ? seed : 1) {
+    for (int i = 0; i < ADC_CHANNEL_COUNT; i++) {
+        waveforms[i].frequency = 0.0f;
+        waveforms[i].amplitude = 0.0f;
+        waveforms[i].offset = 2048.0f;
+        waveforms[i].noise = 0.0f;
+    }
+}
+
+void FakeAdcSource::setSampleRate(uint32_t rateHz) {
+    sampleRate = rateHz > 0 ? rateHz : 1;
+}
+
+void FakeAdcSource::setWaveform(AdcChannel channel, float frequencyHz, float amplitude,
+                                float offset, float noise) {
+    waveforms[channel].frequency = frequencyHz;
+    waveforms[channel].amplitude = amplitude;
+    waveforms[channel].offset = offset;
+    waveforms[channel].noise = noise;
+}
+
+float FakeAdcSource::nextNoise() {
+    // xorshift32, mapped to [-1, 1)
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return (float)(randomState >> 8) / 8388608.0f - 1.0f;
+}
+
+void FakeAdcSource::produce(AdcCapture& capture, uint32_t frames) {
+    const double twoPi = 6.283185307179586;
+    for (uint32_t f = 0; f < frames; f++, frameIndex++) {
+        double t = (double)frameIndex / sampleRate;
+        for (int c = 0; c < ADC_CHANNEL_COUNT; c++) {
+            if (!capture.isChannelEnabled((AdcChannel)c)) {
+                continue;
+            }
+            const Waveform& w = waveforms[c];
+            float value = w.offset + w.amplitude * (float)sin(twoPi * w.frequency * t) + w.noise * nextNoise();
+            if (value < 0.0f) value = 0.0f;
+            if (value > 4095.0f) value = 4095.0f;
+            capture.pushRaw((AdcChannel)c, (uint16_t)value);
+        }
+    }
+}
+
+uint32_t FakeAdcSource::getSampleRate() const {
+    return sampleRate;
+}
+#endif
+
+} // namespace Sensors
+} // namespace Emopod
@@ -0,0 +1,173 @@
+#ifndef ADC_CAPTURE_H
+#define ADC_CAPTURE_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_adc/adc_continuous.h>
+#else
+#include <stdint.h>
+#endif
+#include "utils/RingBuffer.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * AdcCapture - Continuous DMA-driven sampling of the analog biosignal channels
+ *
+ * The ESP32 ADC digital controller (fed through the I2S/DMA engine) scans the
+ * configured pins round-robin at a fixed rate. poll() moves finished DMA
+ * frames into per-channel rings of fixed-size blocks, which drivers consume
+ * with readBlock() instead of calling analogRead() once per loop.
+ *
+ * Pins captured here belong to ADC1. While capture is running no ADC1 pin
+ * may be read with analogRead(): the IDF does not allow oneshot and
+ * continuous mode on the same unit, so every analog input on ADC1 (the
+ * MQ135 included) has to be a channel here.
+ *
+ * On a host build the DMA engine is replaced by FakeAdcSource, which feeds
+ * synthetic waveforms through the same block path.
+ */
+
+enum AdcChannel {
+    ADC_CHANNEL_MIC = 0,
+    ADC_CHANNEL_GSR,
+    ADC_CHANNEL_BREATHING,
+    ADC_CHANNEL_AIR,
+    ADC_CHANNEL_COUNT
+};
+
+struct AdcBlock {
+    static const int SIZE = 64;
+
+    uint16_t samples[SIZE];
+    int count;
+    uint32_t firstSample;      // stream index of samples[0]
+    uint32_t sampleRate;       // Hz, after decimation
+    unsigned long timestamp;   // micros() when the block was completed
+
+    float mean() const {
+        uint32_t sum = 0;
+        for (int i = 0; i < count; i++) {
+            sum += samples[i];
+        }
+        return count > 0 ? (float)sum / count : 0.0f;
+    }
+};
+
+struct AdcChannelConfig {
+    int pin;                   // -1 disables the channel
+    uint16_t decimation;       // raw conversions averaged per output sample
+};
+
+struct AdcChannelStats {
+    uint32_t samplesCaptured;
+    uint32_t blocksCaptured;   // completed with room left in the ring
+    uint32_t blocksDropped;    // completed by overwriting an unread block
+};
+
+class FakeAdcSource;
+
+class AdcCapture {
+private:
+    static const int BLOCKS_PER_CHANNEL = 8;
+
+    struct ChannelState {
+        AdcChannelConfig config;
+        Utils::RingBuffer<AdcBlock, BLOCKS_PER_CHANNEL> blocks;
+        AdcBlock pending;
+        uint32_t decimationSum;
+        uint16_t decimationCount;
+        uint32_t nextSample;
+        AdcChannelStats stats;
+    };
+
+    ChannelState channels[ADC_CHANNEL_COUNT];
+    uint32_t rawRatePerChannel;
+    volatile uint32_t driverOverruns;
+    unsigned long pollTimestamp;
+    bool running;
+
+#ifdef ARDUINO
+    static const int MAX_HW_CHANNELS = 10;
+    static const int FRAME_BYTES = 256;
+
+    adc_continuous_handle_t handle;
+    int8_t channelMap[MAX_HW_CHANNELS];
+
+    static bool onPoolOverflow(adc_continuous_handle_t handle,
+                               const adc_continuous_evt_data_t* event, void* userData);
+#else
+    FakeAdcSource* fakeSource;
+    unsigned long lastFakePoll;
+#endif
+
+    void resetChannel(ChannelState& channel);
+
+public:
+    AdcCapture();
+    ~AdcCapture();
+
+    // sampleRateHz is the raw conversion rate of each enabled channel
+    bool begin(const AdcChannelConfig configs[ADC_CHANNEL_COUNT], uint32_t sampleRateHz);
+    void end();
+
+    // Drain completed DMA frames into the block rings; call from the main loop
+    void poll();
+
+    // Producer entry point for one raw conversion (DMA parser and fake source)
+    void pushRaw(AdcChannel channel, uint16_t raw);
+
+    bool readBlock(AdcChannel channel, AdcBlock& block);
+    int availableBlocks(AdcChannel channel) const;
+
+    const AdcChannelStats& getStats(AdcChannel channel) const;
+    uint32_t getDriverOverruns() const;
+    uint32_t getSampleRate(AdcChannel channel) const;
+    bool isChannelEnabled(AdcChannel channel) const;
+    bool isRunning() const;
+
+#ifndef ARDUINO
+    void attachSource(FakeAdcSource* source);
+#endif
+};
+
+#ifndef ARDUINO
+/*
+ * Host stand-in for the DMA engine: a sine (plus optional noise) per channel,
+ * emitted in scan order exactly as the hardware pattern would deliver it.
+ */
+class FakeAdcSource {
+private:
+    struct Waveform {
+        float frequency;
+        float amplitude;
+        float offset;
+        float noise;
+    };
+
+    Waveform waveforms[ADC_CHANNEL_COUNT];
+    uint32_t sampleRate;
+    uint32_t frameIndex;
+    uint32_t randomState;
+
+    float nextNoise();
+
+public:
+    explicit FakeAdcSource(uint32_t seed = 1);
+
+    void setSampleRate(uint32_t rateHz);
+    void setWaveform(AdcChannel channel, float frequencyHz, float amplitude,
+                     float offset, float noise = 0.0f);
+
+    // Emit `frames` scan frames (one conversion per enabled channel each)
+    void produce(AdcCapture& capture, uint32_t frames);
+
+    uint32_t getSampleRate() const;
+};
+#endif
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef BASELINE_CALIBRATOR_H
+#define BASELINE_CALIBRATOR_H
+
+#include <Arduino.h>
+#include "utils/Statistics.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * BaselineCalibrator - Background per-channel baseline estimation
+ *
+ * Replaces the blocking boot-time averaging loop. Every fresh reading is fed
+ * into a Welford accumulator during normal operation; a channel converges
+ * once it has at least minSamples and the standard error of its mean is
+ * within the channel's tolerance. Converged channels stop accumulating.
+ */
+template <int N>
+class BaselineCalibrator {
+private:
+    struct Channel {
+        const char* name;
+        unsigned long minSamples;
+        float tolerance;
+        RunningStats stats;
+        bool converged;
+    };
+
+    Channel channels[N];
+    int channelCount;
+
+public:
+    BaselineCalibrator() : channelCount(0) {}
+
+    // Returns the channel index, or -1 if all N slots are taken
+    int addChannel(const char* name, unsigned long minSamples, float tolerance) {
+        if (channelCount >= N) {
+            return -1;
+        }
+        Channel& channel = channels[channelCount];
+        channel.name = name;
+        channel.minSamples = minSamples;
+        channel.tolerance = tolerance;
+        channel.stats.reset();
+        channel.converged = false;
+        return channelCount++;
+    }
+
+    // Returns true on the sample that makes the channel converge
+    bool addSample(int index, float value) {
+        if (index < 0 || index >= channelCount || channels[index].converged) {
+            return false;
+        }
+        Channel& channel = channels[index];
+        channel.stats.addValue(value);
+        if (channel.stats.getCount() >= channel.minSamples &&
+            channel.stats.getStdError() <= channel.tolerance) {
+            channel.converged = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool isConverged(int index) const {
+        return index >= 0 && index < channelCount && channels[index].converged;
+    }
+
+    bool isComplete() const {
+        for (int i = 0; i < channelCount; i++) {
+            if (!channels[i].converged) {
+                return false;
+            }
+        }
+        return channelCount > 0;
+    }
+
+    float getBaseline(int index) const {
+        return (index >= 0 && index < channelCount) ? channels[index].stats.getMean() : NAN;
+    }
+
+    // 0..1: limited by whichever is further off, sample count or precision
+    float getProgress(int index) const {
+        if (index < 0 || index >= channelCount) {
+            return 0.0f;
+        }
+        const Channel& channel = channels[index];
+        if (channel.converged) {
+            return 1.0f;
+        }
+        unsigned long count = channel.stats.getCount();
+        float countProgress = channel.minSamples > 0 ? (float)count / channel.minSamples : 1.0f;
+
+        // No spread to judge before two samples; a constant signal has a
+        // standard error of 0 and is as precise as it gets
+        float precisionProgress;
+        if (count < 2) {
+            precisionProgress = 0.0f;
+        } else if (channel.stats.getVariance() <= 0) {
+            precisionProgress = 1.0f;
+        } else {
+            precisionProgress = channel.tolerance / channel.stats.getStdError();
+        }
+        float progress = min(countProgress, precisionProgress);
+        return constrain(progress, 0.0f, 0.99f);
+    }
+
+    float getOverallProgress() const {
+        if (channelCount == 0) {
+            return 0.0f;
+        }
+        float total = 0;
+        for (int i = 0; i < channelCount; i++) {
+            total += getProgress(i);
+        }
+        return total / channelCount;
+    }
+
+    const char* getChannelName(int index) const {
+        return (index >= 0 && index < channelCount) ? channels[index].name : nullptr;
+    }
+
+    unsigned long getSampleCount(int index) const {
+        return (index >= 0 && index < channelCount) ? channels[index].stats.getCount() : 0;
+    }
+
+    void reset() {
+        for (int i = 0; i < channelCount; i++) {
+            channels[i].stats.reset();
+            channels[i].converged = false;
+        }
+    }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
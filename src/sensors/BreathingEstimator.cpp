@@ -0,0 +1,118 @@
+#include "BreathingEstimator.h"
+
+namespace Emopod {
+namespace Sensors {
+
+BreathingEstimator::BreathingEstimator(float sampleRate) {
+    configure(sampleRate);
+}
+
+void BreathingEstimator::configure(float sampleRate) {
+    inputRate = sampleRate > 0 ? sampleRate : PROCESS_RATE_HZ;
+    decimation = (int)lroundf(inputRate / PROCESS_RATE_HZ);
+    if (decimation < 1) {
+        decimation = 1;
+    }
+    processRate = inputRate / decimation;
+
+    highPass = Utils::Biquad::highPass(processRate, LOW_CUTOFF_HZ);
+    lowPass = Utils::Biquad::lowPass(processRate, HIGH_CUTOFF_HZ);
+    envelope.setAlpha(Ewma::alphaFor(ENVELOPE_TIME_S, processRate));
+    reset();
+}
+
+void BreathingEstimator::reset() {
+    accumulator = 0;
+    accumulated = 0;
+    primed = false;
+    highPass.reset();
+    lowPass.reset();
+    envelope.prime(0);
+    filtered = 0;
+    processed = 0;
+    armed = false;
+    crossingTime = -1;
+    lastBreathTime = -1;
+    intervals.reset();
+    rate = NAN;
+    breaths = 0;
+    rejected = 0;
+}
+
+bool BreathingEstimator::addSample(float value) {
+    if (isnan(value)) {
+        return false;
+    }
+    accumulator += value;
+    if (++accumulated < decimation) {
+        return false;
+    }
+    float mean = accumulator / decimation;
+    accumulator = 0;
+    accumulated = 0;
+    return processSample(mean);
+}
+
+bool BreathingEstimator::processSample(float value) {
+    if (!primed) {
+        // Start from steady state on the first value's DC level
+        highPass.prime(value);
+        lowPass.prime(0);
+        primed = true;
+    }
+
+    float previous = filtered;
+    filtered = lowPass.process(highPass.process(value));
+    envelope.addValue(fabsf(filtered));
+    processed++;
+
+    // Upward zero crossing, interpolated between the two samples
+    if (previous < 0 && filtered >= 0) {
+        float fraction = -previous / (filtered - previous);
+        crossingTime = (processed - 1 + fraction) / processRate;
+    }
+
+    float threshold = HYSTERESIS * envelope.getValue();
+    if (filtered < -threshold) {
+        armed = true;
+    } else if (armed && filtered > threshold && crossingTime >= 0) {
+        armed = false;
+        return acceptCrossing(crossingTime);
+    }
+    return false;
+}
+
+bool BreathingEstimator::acceptCrossing(double time) {
+    if (lastBreathTime < 0) {
+        lastBreathTime = time;
+        return false;
+    }
+
+    float interval = (float)(time - lastBreathTime);
+    if (interval < MIN_INTERVAL_S) {
+        // Too fast for respiration; keep the earlier reference
+        rejected++;
+        return false;
+    }
+    lastBreathTime = time;
+    if (interval > MAX_INTERVAL_S) {
+        // A pause or dropout; restart the interval history from here
+        rejected++;
+        intervals.reset();
+        return false;
+    }
+
+    rate = 60.0f / intervals.addValue(interval);
+    breaths++;
+    return true;
+}
+
+float BreathingEstimator::getTimeSinceBreath() const {
+    if (lastBreathTime < 0) {
+        return NAN;
+    }
+    return (float)(processed / processRate - lastBreathTime);
+}
+
+} // namespace Sensors
+} // namespace Emopod
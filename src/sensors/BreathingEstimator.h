@@ -0,0 +1,94 @@
+#ifndef BREATHING_ESTIMATOR_H
+#define BREATHING_ESTIMATOR_H
+
+#include <Arduino.h>
+#include "utils/Biquad.h"
+#include "utils/Statistics.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * BreathingEstimator - Streaming respiration rate from any chest signal
+ *
+ * Input (breathing belt ADC or one chest accelerometer axis) is boxcar-
+ * decimated to ~10 Hz, band-passed to the 0.1-0.7 Hz respiration band
+ * (2nd-order high-pass + 2nd-order low-pass) and passed to a zero-crossing
+ * detector with adaptive hysteresis: a breath is an upward zero crossing
+ * that follows a dip below -k*envelope and reaches +k*envelope, where the
+ * envelope tracks the band's mean absolute amplitude. Crossing times are
+ * interpolated between samples and derived from the sample count, not the
+ * wall clock. Intervals outside the band are rejected; the rate is the
+ * mean of the last few accepted intervals.
+ *
+ * Memory is fixed and every addSample() is O(1).
+ */
+class BreathingEstimator {
+private:
+    static constexpr float LOW_CUTOFF_HZ = 0.1f;
+    static constexpr float HIGH_CUTOFF_HZ = 0.7f;
+    static constexpr float PROCESS_RATE_HZ = 10.0f;  // band rate after decimation
+    static constexpr float ENVELOPE_TIME_S = 10.0f;  // amplitude tracking time constant
+    static constexpr float HYSTERESIS = 0.3f;        // fraction of the envelope
+    static constexpr float MIN_INTERVAL_S = 1.0f / HIGH_CUTOFF_HZ;
+    static constexpr float MAX_INTERVAL_S = 1.0f / LOW_CUTOFF_HZ;
+    static const int INTERVAL_COUNT = 4;
+
+    float inputRate;
+    int decimation;
+    float processRate;
+    float accumulator;
+    int accumulated;
+    bool primed;
+
+    Utils::Biquad highPass;
+    Utils::Biquad lowPass;
+    Ewma envelope;
+    float filtered;
+
+    uint32_t processed;          // samples at processRate since configure()
+    bool armed;                  // signal dipped below -threshold since the last breath
+    double crossingTime;         // latest upward zero crossing, s
+    double lastBreathTime;       // s; negative until the first breath
+    MovingAverage<INTERVAL_COUNT> intervals;
+
+    float rate;
+    uint32_t breaths;
+    uint32_t rejected;
+
+    bool processSample(float value);
+    bool acceptCrossing(double time);
+
+public:
+    explicit BreathingEstimator(float sampleRate = PROCESS_RATE_HZ);
+
+    // Set the input rate and restart the estimate
+    void configure(float sampleRate);
+    void reset();
+
+    // Returns true when the sample completes a breath and updates the rate
+    bool addSample(float value);
+
+    // Breaths per minute, NAN until two breaths have been seen
+    float getRate() const { return rate; }
+
+    // Seconds of input since the last accepted breath
+    float getTimeSinceBreath() const;
+
+    // Longest interval accepted as a breath: the rate can go this long
+    // without an update and still be current
+    static constexpr float getMaxInterval() { return MAX_INTERVAL_S; }
+
+    float getFiltered() const { return filtered; }
+    float getEnvelope() const { return envelope.getValue(); }
+    float getInputRate() const { return inputRate; }
+    uint32_t getBreathCount() const { return breaths; }
+
+    // Crossings dropped because the interval fell outside the band
+    uint32_t getRejectedCount() const { return rejected; }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,113 @@
+#include "DhtReader.h"
+
+namespace Emopod {
+namespace Sensors {
+
+DhtReader::DhtReader(int pin, unsigned long intervalMs)
+    : pin(pin), intervalMs(intervalMs), state(IDLE), stateStartUs(0),
+      lastStartMs(0), started(false), edgeCount(0),
+      temperature(NAN), humidity(NAN), valueReady(false),
+      callback(nullptr), callbackContext(nullptr), stats() {}
+
+void DhtReader::begin() {
+    pinMode(pin, INPUT_PULLUP);
+    state = IDLE;
+    started = false;
+}
+
+void DhtReader::onValueReady(ReadyCallback cb, void* context) {
+    callback = cb;
+    callbackContext = context;
+}
+
+void IRAM_ATTR DhtReader::onFallingEdge(void* self) {
+    DhtReader* reader = static_cast<DhtReader*>(self);
+    int count = reader->edgeCount;
+    if (count < EDGE_COUNT) {
+        reader->edges[count] = micros();
+        reader->edgeCount = count + 1;
+    }
+}
+
+bool DhtReader::update() {
+    unsigned long nowUs = micros();
+
+    switch (state) {
+        case IDLE: {
+            unsigned long nowMs = millis();
+            if (started && nowMs - lastStartMs < intervalMs) {
+                return false;
+            }
+            // Host start pulse: hold the line low for at least 1 ms
+            lastStartMs = nowMs;
+            started = true;
+            pinMode(pin, OUTPUT);
+            digitalWrite(pin, LOW);
+            stateStartUs = nowUs;
+            state = START_SIGNAL;
+            return false;
+        }
+
+        case START_SIGNAL:
+            if (nowUs - stateStartUs < START_SIGNAL_US) {
+                return false;
+            }
+            // Arm edge capture, then release the line to the pull-up
+            edgeCount = 0;
+            attachInterruptArg(digitalPinToInterrupt(pin), onFallingEdge, this, FALLING);
+            pinMode(pin, INPUT_PULLUP);
+            stateStartUs = micros();
+            state = RECEIVING;
+            return false;
+
+        case RECEIVING:
+            if (edgeCount < EDGE_COUNT && nowUs - stateStartUs < RECEIVE_TIMEOUT_US) {
+                return false;
+            }
+            detachInterrupt(digitalPinToInterrupt(pin));
+            state = IDLE;
+
+            if (edgeCount < EDGE_COUNT) {
+                stats.timeouts++;
+                return false;
+            }
+            if (!decode()) {
+                stats.checksumErrors++;
+                return false;
+            }
+
+            stats.reads++;
+            valueReady = true;
+            if (callback != nullptr) {
+                callback(temperature, humidity, callbackContext);
+            }
+            return true;
+    }
+    return false;
+}
+
+bool DhtReader::decode() {
+    // Bit i spans falling edges i+1 .. i+2; a long span is a '1'
+    uint8_t data[5] = { 0, 0, 0, 0, 0 };
+    for (int i = 0; i < 40; i++) {
+        unsigned long width = edges[i + 2] - edges[i + 1];
+        data[i / 8] <<= 1;
+        if (width > ONE_BIT_THRESHOLD_US) {
+            data[i / 8] |= 1;
+        }
+    }
+
+    if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) {
+        return false;
+    }
+
+    humidity = (((uint16_t)data[0] << 8) | data[1]) * 0.1f;
+    temperature = ((((uint16_t)data[2] & 0x7F) << 8) | data[3]) * 0.1f;
+    if (data[2] & 0x80) {
+        temperature = -temperature;
+    }
+    return true;
+}
+
+} // namespace Sensors
+} // namespace Emopod
@@ -0,0 +1,85 @@
+#ifndef DHT_READER_H
+#define DHT_READER_H
+
+#include <Arduino.h>
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * DhtReader - Non-blocking DHT22 driver
+ *
+ * The stock DHT library bit-bangs the 40-bit frame with interrupts disabled
+ * for ~5 ms per read. Here the transaction is a state machine advanced by
+ * update(): drive the start pulse, release the line, let a pin interrupt
+ * timestamp the falling edges, and decode them on a later tick. No call
+ * waits on the sensor.
+ */
+class DhtReader {
+public:
+    typedef void (*ReadyCallback)(float temperature, float humidity, void* context);
+
+    struct Stats {
+        uint32_t reads;
+        uint32_t checksumErrors;
+        uint32_t timeouts;
+    };
+
+private:
+    enum State {
+        IDLE,
+        START_SIGNAL,
+        RECEIVING
+    };
+
+    // Response pulse + 40 data bits + trailing edge
+    static const int EDGE_COUNT = 42;
+    static const unsigned long START_SIGNAL_US = 1100;
+    static const unsigned long RECEIVE_TIMEOUT_US = 10000;
+    static const unsigned long ONE_BIT_THRESHOLD_US = 100; // 50 us low + 70 us high for a '1'
+
+    int pin;
+    unsigned long intervalMs;
+    State state;
+    unsigned long stateStartUs;
+    unsigned long lastStartMs;
+    bool started;
+
+    volatile unsigned long edges[EDGE_COUNT];
+    volatile int edgeCount;
+
+    float temperature;
+    float humidity;
+    bool valueReady;
+    ReadyCallback callback;
+    void* callbackContext;
+    Stats stats;
+
+    static void onFallingEdge(void* self);
+    bool decode();
+
+public:
+    // intervalMs: minimum time between transactions (the DHT22 needs >= 2 s)
+    explicit DhtReader(int pin, unsigned long intervalMs = 2000);
+
+    void begin();
+
+    // Advance the state machine; returns true on the tick a new reading lands
+    bool update();
+
+    // Latched until consumeValue()
+    bool isValueReady() const { return valueReady; }
+    void consumeValue() { valueReady = false; }
+
+    void onValueReady(ReadyCallback cb, void* context);
+
+    bool isBusy() const { return state != IDLE; }
+    float getTemperature() const { return temperature; }
+    float getHumidity() const { return humidity; }
+    const Stats& getStats() const { return stats; }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
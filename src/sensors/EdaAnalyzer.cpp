@@ -0,0 +1,160 @@
+#include "EdaAnalyzer.h"
+
+namespace Emopod {
+namespace Sensors {
+
+EdaAnalyzer::EdaAnalyzer(float sampleRate) {
+    configure(sampleRate);
+}
+
+void EdaAnalyzer::configure(float sampleRate) {
+    inputRate = sampleRate > 0 ? sampleRate : PROCESS_RATE_HZ;
+    decimation = (int)lroundf(inputRate / PROCESS_RATE_HZ);
+    if (decimation < 1) {
+        decimation = 1;
+    }
+    processRate = inputRate / decimation;
+    smoother = Utils::Biquad::lowPass(processRate, SMOOTH_CUTOFF_HZ);
+    tonic.setAlpha(Ewma::alphaFor(TONIC_TIME_S, processRate));
+    amplitudeAverage.setAlpha(AMPLITUDE_ALPHA);
+    reset();
+}
+
+void EdaAnalyzer::reset() {
+    accumulator = 0;
+    accumulated = 0;
+    smoother.reset();
+    tonic.reset();
+    amplitudeAverage.reset();
+    primed = false;
+    level = NAN;
+    previousLevel = NAN;
+    state = STATE_QUIET;
+    processed = 0;
+    onsetTime = 0;
+    onsetLevel = 0;
+    peakLevel = 0;
+    peakTime = 0;
+    responseBase = 0;
+    onsetIndex = 0;
+    onsetCount = 0;
+    responses = 0;
+
+    features.tonicLevel = NAN;
+    features.phasic = NAN;
+    features.scrRate = NAN;
+    features.lastAmplitude = NAN;
+    features.lastRiseTime = NAN;
+    features.meanAmplitude = NAN;
+}
+
+bool EdaAnalyzer::addSample(float conductance) {
+    if (isnan(conductance)) {
+        return false;
+    }
+    accumulator += conductance;
+    if (++accumulated < decimation) {
+        return false;
+    }
+    float mean = accumulator / decimation;
+    accumulator = 0;
+    accumulated = 0;
+
+    uint32_t before = responses;
+    processSample(mean);
+    return responses != before;
+}
+
+void EdaAnalyzer::processSample(float value) {
+    if (!primed) {
+        smoother.prime(value);
+        tonic.prime(value);
+        features.tonicLevel = value;
+        previousLevel = value;
+        primed = true;
+    }
+    level = smoother.process(value);
+    float slope = (level - previousLevel) * processRate;
+    float time = processed / processRate;
+    processed++;
+
+    switch (state) {
+        case STATE_QUIET:
+            if (slope > ONSET_SLOPE) {
+                state = STATE_RISING;
+                onsetTime = time;
+                onsetLevel = previousLevel;
+                responseBase = onsetLevel;
+                peakLevel = level;
+            } else {
+                // Lower envelope: slow upward drift, immediate drops
+                if (tonic.addValue(level) > level) {
+                    tonic.prime(level);
+                }
+                features.tonicLevel = tonic.getValue();
+            }
+            break;
+
+        case STATE_RISING:
+            peakLevel = max(peakLevel, level);
+            if (slope <= 0) {
+                acceptPeak(time);
+            } else if (time - onsetTime > MAX_RISE_S) {
+                // Too slow for a response: tonic drift
+                state = STATE_QUIET;
+            }
+            break;
+
+        case STATE_RECOVERING:
+            if (slope > ONSET_SLOPE) {
+                // Overlapping response, measured from where this one starts
+                state = STATE_RISING;
+                onsetTime = time;
+                onsetLevel = previousLevel;
+                peakLevel = level;
+            } else if (level <= responseBase + 0.5f * (peakLevel - responseBase) ||
+                       time - peakTime > RECOVERY_TIMEOUT_S) {
+                state = STATE_QUIET;
+            }
+            break;
+    }
+
+    features.phasic = max(0.0f, level - features.tonicLevel);
+    previousLevel = level;
+
+    // Responses per minute over the onsets still inside the window
+    int recent = 0;
+    for (int i = 0; i < onsetCount; i++) {
+        if (time - onsets[i] <= RATE_WINDOW_S) {
+            recent++;
+        }
+    }
+    float span = min(time, RATE_WINDOW_S);
+    features.scrRate = span > 0 ? recent * 60.0f / span : NAN;
+}
+
+void EdaAnalyzer::acceptPeak(float time) {
+    float amplitude = peakLevel - onsetLevel;
+    float riseTime = time - onsetTime;
+    peakTime = time;
+    if (amplitude < MIN_AMPLITUDE || riseTime < MIN_RISE_S) {
+        // Noise or a wiggle on a recovery; keep recovering toward the base
+        state = responseBase < onsetLevel ? STATE_RECOVERING : STATE_QUIET;
+        return;
+    }
+
+    state = STATE_RECOVERING;
+    responses++;
+    onsets[onsetIndex] = onsetTime;
+    onsetIndex = (onsetIndex + 1) % ONSET_HISTORY;
+    if (onsetCount < ONSET_HISTORY) {
+        onsetCount++;
+    }
+
+    features.lastAmplitude = amplitude;
+    features.lastRiseTime = riseTime;
+    features.meanAmplitude = amplitudeAverage.addValue(amplitude);
+}
+
+} // namespace Sensors
+} // namespace Emopod
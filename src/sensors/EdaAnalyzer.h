@@ -0,0 +1,109 @@
+#ifndef EDA_ANALYZER_H
+#define EDA_ANALYZER_H
+
+#include <Arduino.h>
+#include "utils/Biquad.h"
+#include "utils/Statistics.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * EdaAnalyzer - Streaming tonic/phasic split of skin conductance
+ *
+ * Input is conductance in microsiemens at any rate; it is boxcar-decimated
+ * to ~10 Hz and low-passed at 1 Hz. A small state machine then follows
+ * the slope:
+ *   QUIET       the tonic level (SCL) tracks the signal with a slow EMA,
+ *               never above it; a slope over ONSET_SLOPE marks an onset
+ *   RISING      until the slope turns negative: the peak. A rise of at
+ *               least MIN_AMPLITUDE within the allowed rise time is an
+ *               SCR with that amplitude and rise time
+ *   RECOVERING  the tonic level is held at the onset level until the
+ *               signal has recovered half the amplitude (or a timeout);
+ *               a new onset here starts an overlapping response
+ * The phasic component is the signal above the tonic level. Onset times
+ * of the last few SCRs give the response rate; all memory is fixed.
+ */
+class EdaAnalyzer {
+public:
+    struct Features {
+        float tonicLevel;      // SCL, uS
+        float phasic;          // uS above the tonic level
+        float scrRate;         // responses per minute
+        float lastAmplitude;   // uS
+        float lastRiseTime;    // s
+        float meanAmplitude;   // uS, recent responses
+    };
+
+private:
+    enum State {
+        STATE_QUIET,
+        STATE_RISING,
+        STATE_RECOVERING
+    };
+
+    static constexpr float PROCESS_RATE_HZ = 10.0f;
+    static constexpr float SMOOTH_CUTOFF_HZ = 1.0f;
+    static constexpr float TONIC_TIME_S = 20.0f;
+    static constexpr float ONSET_SLOPE = 0.02f;     // uS/s
+    static constexpr float MIN_AMPLITUDE = 0.03f;   // uS
+    static constexpr float MIN_RISE_S = 0.5f;
+    static constexpr float MAX_RISE_S = 5.0f;
+    static constexpr float RECOVERY_TIMEOUT_S = 15.0f;
+    static constexpr float RATE_WINDOW_S = 60.0f;
+    static constexpr float AMPLITUDE_ALPHA = 0.25f;
+    static const int ONSET_HISTORY = 16;
+
+    float inputRate;
+    int decimation;
+    float processRate;
+    float accumulator;
+    int accumulated;
+
+    Utils::Biquad smoother;
+    bool primed;
+    Ewma tonic;
+    float level;
+    float previousLevel;
+
+    State state;
+    uint32_t processed;        // samples at processRate
+    float onsetTime;           // s
+    float onsetLevel;
+    float peakLevel;
+    float peakTime;
+    float responseBase;        // level the current response recovers toward
+
+    float onsets[ONSET_HISTORY];
+    int onsetIndex;
+    int onsetCount;
+    uint32_t responses;
+    Ewma amplitudeAverage;
+
+    Features features;
+
+    void processSample(float value);
+    void acceptPeak(float time);
+
+public:
+    explicit EdaAnalyzer(float sampleRate = PROCESS_RATE_HZ);
+
+    void configure(float sampleRate);
+    void reset();
+
+    // Conductance in uS; NAN (no contact) is skipped. Returns true when a
+    // new SCR was accepted
+    bool addSample(float conductance);
+
+    const Features& getFeatures() const { return features; }
+    float getTonicLevel() const { return features.tonicLevel; }
+    float getInputRate() const { return inputRate; }
+    uint32_t getResponseCount() const { return responses; }
+    bool isResponding() const { return state != STATE_QUIET; }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,233 @@
+#include "HrvAnalyzer.h"
+#include "utils/CycleCounter.h"
+
+namespace Emopod {
+namespace Sensors {
+
+HrvAnalyzer::HrvAnalyzer() {
+    reset();
+}
+
+void HrvAnalyzer::reset() {
+    head = 0;
+    count = 0;
+    sumNn = 0;
+    sumNnSquared = 0;
+    sumDiffSquared = 0;
+    diffCount = 0;
+    nn50Count = 0;
+    reference.reset();
+    consecutiveRejects = 0;
+    lastBeatUs = 0;
+    hasLastBeat = false;
+    previousAccepted = false;
+    sinceSpectrum = 0;
+
+    metrics.meanNn = NAN;
+    metrics.sdnn = NAN;
+    metrics.rmssd = NAN;
+    metrics.pnn50 = NAN;
+    metrics.lfPower = NAN;
+    metrics.hfPower = NAN;
+    metrics.lfHfRatio = NAN;
+    stats = Stats();
+}
+
+bool HrvAnalyzer::addBeat(uint32_t timestampUs) {
+    stats.beats++;
+    uint32_t nnUs = timestampUs - lastBeatUs;
+    bool first = !hasLastBeat;
+    lastBeatUs = timestampUs;
+    hasLastBeat = true;
+    if (first) {
+        return false;
+    }
+
+    if (nnUs < MIN_INTERVAL_US || nnUs > MAX_INTERVAL_US || isEctopic(nnUs)) {
+        stats.rejected++;
+        previousAccepted = false;
+        // Persistent disagreement means the rhythm moved, not the beats
+        if (++consecutiveRejects >= MAX_CONSECUTIVE_REJECTS) {
+            reference.reset();
+            consecutiveRejects = 0;
+        }
+        return false;
+    }
+
+    consecutiveRejects = 0;
+    reference.addValue(nnUs);
+    push(timestampUs, nnUs);
+    stats.accepted++;
+    updateTimeDomain();
+
+    if (++sinceSpectrum >= SPECTRUM_INTERVAL) {
+        sinceSpectrum = 0;
+        updateSpectrum();
+    }
+    return true;
+}
+
+bool HrvAnalyzer::isEctopic(uint32_t nnUs) const {
+    if (reference.getCount() < 3) {
+        return false;
+    }
+
+    float median = reference.getMedian();
+    return fabsf((float)nnUs - median) > ECTOPIC_TOLERANCE * median;
+}
+
+void HrvAnalyzer::push(uint32_t beatUs, uint32_t nnUs) {
+    if (count == HISTORY) {
+        const Interval& oldest = intervals[head];
+        sumNn -= oldest.nnUs;
+        sumNnSquared -= (uint64_t)oldest.nnUs * oldest.nnUs;
+        if (oldest.hasDiff) {
+            sumDiffSquared -= (uint64_t)((int64_t)oldest.diffUs * oldest.diffUs);
+            diffCount--;
+            if (abs(oldest.diffUs) > NN50_US) {
+                nn50Count--;
+            }
+        }
+        head = (head + 1) % HISTORY;
+        count--;
+    }
+
+    Interval& entry = intervals[(head + count) % HISTORY];
+    entry.beatUs = beatUs;
+    entry.nnUs = nnUs;
+    entry.hasDiff = previousAccepted && count > 0;
+    if (entry.hasDiff) {
+        uint32_t previous = intervals[(head + count - 1) % HISTORY].nnUs;
+        entry.diffUs = (int32_t)(nnUs - previous);
+        sumDiffSquared += (uint64_t)((int64_t)entry.diffUs * entry.diffUs);
+        diffCount++;
+        if (abs(entry.diffUs) > NN50_US) {
+            nn50Count++;
+        }
+    } else {
+        entry.diffUs = 0;
+    }
+    count++;
+    previousAccepted = true;
+
+    sumNn += nnUs;
+    sumNnSquared += (uint64_t)nnUs * nnUs;
+}
+
+void HrvAnalyzer::updateTimeDomain() {
+    if (count < MIN_INTERVALS) {
+        return;
+    }
+
+    // Sums are exact integers; only the final division is floating point
+    double mean = (double)sumNn / count;
+    double variance = ((double)sumNnSquared - mean * (double)sumNn) / (count - 1);
+    metrics.meanNn = mean / 1000.0;
+    metrics.sdnn = sqrt(max(variance, 0.0)) / 1000.0;
+    if (diffCount > 0) {
+        metrics.rmssd = sqrt((double)sumDiffSquared / diffCount) / 1000.0;
+        metrics.pnn50 = 100.0f * nn50Count / diffCount;
+    }
+}
+
+void HrvAnalyzer::updateSpectrum() {
+    const Interval& oldest = intervals[head];
+    const Interval& newest = intervals[(head + count - 1) % HISTORY];
+    float span = (newest.beatUs - oldest.beatUs) * 1e-6f;
+    if (count < MIN_INTERVALS || span < SPECTRUM_MIN_SPAN_S) {
+        return;
+    }
+
+    uint32_t start = Utils::cycleCount();
+
+    for (int k = 0; k < SPECTRUM_BINS; k++) {
+        sumCos[k] = 0;
+        sumSin[k] = 0;
+        sumCosSquared[k] = 0;
+        sumCosSin[k] = 0;
+    }
+
+    const float omegaLow = 2.0f * (float)M_PI * LF_LOW_HZ;
+    const float omegaStep = 2.0f * (float)M_PI * SPECTRUM_STEP_HZ;
+    float mean = (float)sumNn / count;
+
+    // Per point: one sin/cos pair at the lowest frequency and one for the
+    // step, then a rotation per bin
+    for (int i = 0; i < count; i++) {
+        const Interval& entry = intervals[(head + i) % HISTORY];
+        float t = (entry.beatUs - oldest.beatUs) * 1e-6f;
+        float y = ((float)entry.nnUs - mean) * 1e-3f;   // ms
+
+        float c = cosf(omegaLow * t);
+        float s = sinf(omegaLow * t);
+        float stepCos = cosf(omegaStep * t);
+        float stepSin = sinf(omegaStep * t);
+        for (int k = 0; k < SPECTRUM_BINS; k++) {
+            sumCos[k] += y * c;
+            sumSin[k] += y * s;
+            sumCosSquared[k] += c * c;
+            sumCosSin[k] += c * s;
+            float nextCos = c * stepCos - s * stepSin;
+            s = s * stepCos + c * stepSin;
+            c = nextCos;
+        }
+    }
+
+    // Lomb-Scargle power with the time offset tau folded in analytically:
+    // tan(2 w tau) = 2 CS / (CC - SS)
+    float lf = 0;
+    float hf = 0;
+    for (int k = 0; k < SPECTRUM_BINS; k++) {
+        float cc = sumCosSquared[k];
+        float ss = count - cc;
+        float cs = sumCosSin[k];
+        float r = sqrtf((cc - ss) * (cc - ss) + 4.0f * cs * cs);
+        float cos2 = r > 0 ? (cc - ss) / r : 1.0f;
+        float cosTau = sqrtf(max(0.0f, 0.5f * (1.0f + cos2)));
+        float sinTau = sqrtf(max(0.0f, 0.5f * (1.0f - cos2)));
+        if (cs < 0) {
+            sinTau = -sinTau;
+        }
+
+        float yc = sumCos[k] * cosTau + sumSin[k] * sinTau;
+        float ys = sumSin[k] * cosTau - sumCos[k] * sinTau;
+        float ccTau = cosTau * cosTau * cc + 2.0f * cosTau * sinTau * cs + sinTau * sinTau * ss;
+        float ssTau = cosTau * cosTau * ss - 2.0f * cosTau * sinTau * cs + sinTau * sinTau * cc;
+        float power = 0;
+        if (ccTau > 1e-6f) {
+            power += yc * yc / ccTau;
+        }
+        if (ssTau > 1e-6f) {
+            power += ys * ys / ssTau;
+        }
+        power *= 0.5f;
+
+        // LF takes bins below the split, HF the split and above
+        float frequency = LF_LOW_HZ + k * SPECTRUM_STEP_HZ;
+        if (frequency < LF_HIGH_HZ - 0.5f * SPECTRUM_STEP_HZ) {
+            lf += power;
+        } else {
+            hf += power;
+        }
+    }
+
+    // Periodogram to one-sided density: a sinusoid of amplitude A peaks at
+    // N A^2 / 4 with a main lobe 1/span wide, and carries A^2 / 2 of variance
+    float scale = 2.0f * span / count * SPECTRUM_STEP_HZ;
+    metrics.lfPower = lf * scale;
+    metrics.hfPower = hf * scale;
+    metrics.lfHfRatio = metrics.hfPower > 0 ? metrics.lfPower / metrics.hfPower : NAN;
+
+    stats.spectra++;
+    stats.lastSpectrumCycles = Utils::cycleCount() - start;
+}
+
+float HrvAnalyzer::getLastInterval() const {
+    if (count == 0) {
+        return NAN;
+    }
+    return intervals[(head + count - 1) % HISTORY].nnUs / 1000.0f;
+}
+
+} // namespace Sensors
+} // namespace Emopod
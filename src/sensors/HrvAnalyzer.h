@@ -0,0 +1,145 @@
+#ifndef HRV_ANALYZER_H
+#define HRV_ANALYZER_H
+
+#include <Arduino.h>
+#include "utils/Statistics.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * HrvAnalyzer - Streaming heart-rate variability from beat timestamps
+ *
+ * Each beat yields one inter-beat interval. Intervals outside 300-2000 ms,
+ * or more than 20% away from the median of the last few accepted ones, are
+ * treated as ectopic or missed beats and rejected; a run of rejections
+ * resets that reference so a genuine change of rhythm is followed.
+ *
+ * Accepted (NN) intervals live in a fixed window of HISTORY entries. Sums
+ * of the intervals, their squares and their squared successive differences
+ * are kept in integer microseconds and updated as intervals enter and
+ * leave, so SDNN, RMSSD and pNN50 cost O(1) per beat and never drift.
+ * Successive differences are only taken between adjacent accepted
+ * intervals, never across a rejected beat.
+ *
+ * Every SPECTRUM_INTERVAL accepted beats, a Lomb-Scargle periodogram of the
+ * window (no resampling, so the uneven beat spacing is used as is) gives
+ * LF (0.04-0.15 Hz) and HF (0.15-0.4 Hz) power. Sines and cosines are
+ * rotated from one frequency to the next instead of recomputed; all
+ * scratch space is part of the object.
+ */
+class HrvAnalyzer {
+public:
+    static const int HISTORY = 128;            // NN intervals, about 2 min at 64 BPM
+    static const int MIN_INTERVALS = 16;       // before time-domain metrics are published
+    static const int SPECTRUM_INTERVAL = 16;   // accepted beats between periodograms
+    static constexpr float SPECTRUM_MIN_SPAN_S = 60.0f;
+
+    // JSON fields written by serialize()
+    static constexpr const char* RMSSD_KEY = "rmssd";
+    static constexpr const char* SDNN_KEY = "sdnn";
+    static constexpr const char* PNN50_KEY = "pnn50";
+    static constexpr const char* LF_HF_KEY = "lfHf";
+
+    struct Metrics {
+        float meanNn;       // ms
+        float sdnn;         // ms
+        float rmssd;        // ms
+        float pnn50;        // % of successive differences over 50 ms
+        float lfPower;      // ms^2
+        float hfPower;      // ms^2
+        float lfHfRatio;
+    };
+
+    struct Stats {
+        uint32_t beats;
+        uint32_t accepted;
+        uint32_t rejected;
+        uint32_t spectra;
+        uint32_t lastSpectrumCycles;
+    };
+
+private:
+    static const uint32_t MIN_INTERVAL_US = 300000;    // 200 BPM
+    static const uint32_t MAX_INTERVAL_US = 2000000;   // 30 BPM
+    static const int32_t NN50_US = 50000;
+    static constexpr float ECTOPIC_TOLERANCE = 0.2f;   // relative to the reference median
+    static const int REFERENCE_COUNT = 5;
+    static const int MAX_CONSECUTIVE_REJECTS = 5;
+
+    static constexpr float LF_LOW_HZ = 0.04f;
+    static constexpr float LF_HIGH_HZ = 0.15f;
+    static constexpr float HF_HIGH_HZ = 0.4f;
+    static constexpr float SPECTRUM_STEP_HZ = 0.005f;
+    static const int SPECTRUM_BINS = 73;   // LF_LOW_HZ..HF_HIGH_HZ inclusive
+
+    struct Interval {
+        uint32_t beatUs;    // timestamp of the beat that ends the interval
+        uint32_t nnUs;
+        int32_t diffUs;     // to the previous interval, when hasDiff
+        bool hasDiff;
+    };
+
+    Interval intervals[HISTORY];   // circular, oldest at head
+    int head;
+    int count;
+
+    uint64_t sumNn;
+    uint64_t sumNnSquared;
+    uint64_t sumDiffSquared;
+    int diffCount;
+    int nn50Count;
+
+    SlidingMedian<REFERENCE_COUNT, uint32_t> reference;
+    int consecutiveRejects;
+
+    uint32_t lastBeatUs;
+    bool hasLastBeat;
+    bool previousAccepted;
+    int sinceSpectrum;
+
+    // Periodogram accumulators, one per frequency bin
+    float sumCos[SPECTRUM_BINS];
+    float sumSin[SPECTRUM_BINS];
+    float sumCosSquared[SPECTRUM_BINS];
+    float sumCosSin[SPECTRUM_BINS];
+
+    Metrics metrics;
+    Stats stats;
+
+    bool isEctopic(uint32_t nnUs) const;
+    void push(uint32_t beatUs, uint32_t nnUs);
+    void updateTimeDomain();
+    void updateSpectrum();
+
+public:
+    HrvAnalyzer();
+
+    void reset();
+
+    // Timestamp of a detected beat, micros(); returns true when it closes an
+    // accepted NN interval
+    bool addBeat(uint32_t timestampUs);
+
+    // NAN until enough intervals (time domain) or span (LF/HF) are collected
+    const Metrics& getMetrics() const { return metrics; }
+    const Stats& getStats() const { return stats; }
+
+    int getIntervalCount() const { return count; }
+
+    // Most recent accepted NN interval, ms; NAN before the first
+    float getLastInterval() const;
+
+    template <typename Document>
+    void serialize(Document& doc) const {
+        doc[RMSSD_KEY] = metrics.rmssd;
+        doc[SDNN_KEY] = metrics.sdnn;
+        doc[PNN50_KEY] = metrics.pnn50;
+        doc[LF_HF_KEY] = metrics.lfHfRatio;
+    }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
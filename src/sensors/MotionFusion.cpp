@@ -0,0 +1,221 @@
+#include "MotionFusion.h"
+#include "utils/CycleCounter.h"
+
+namespace Emopod {
+namespace Sensors {
+
+MotionFusion::MotionFusion(float rate) {
+    configure(rate);
+}
+
+void MotionFusion::configure(float rate) {
+    sampleRate = rate > 0 ? rate : 100.0f;
+    dt = 1.0f / sampleRate;
+    fidget.setAlpha(Ewma::alphaFor(FIDGET_TIME_S, sampleRate));
+    stepInterval.setAlpha(STEP_ALPHA);
+    minStepSamples = (uint32_t)(MIN_STEP_S * sampleRate);
+    maxStepSamples = (uint32_t)(MAX_STEP_S * sampleRate);
+    Utils::Biquad smooth = Utils::Biquad::lowPass(sampleRate, JERK_CUTOFF_HZ);
+    Utils::Biquad step = Utils::Biquad::lowPass(sampleRate, STEP_CUTOFF_HZ);
+    filters.setChannel(FILTER_X, &smooth, 1);
+    filters.setChannel(FILTER_Y, &smooth, 1);
+    filters.setChannel(FILTER_Z, &smooth, 1);
+    filters.setChannel(FILTER_VERTICAL, &step, 1);
+    reset();
+}
+
+void MotionFusion::reset() {
+    primed = false;
+    q0 = 1;
+    q1 = q2 = q3 = 0;
+    filters.reset();
+    previousLinear[0] = previousLinear[1] = previousLinear[2] = 0;
+    vertical1 = vertical2 = 0;
+    sampleIndex = 0;
+    lastStepIndex = 0;
+    stepInterval.reset();
+    stepStreak = 0;
+    fidget.prime(0);
+
+    features.roll = NAN;
+    features.pitch = NAN;
+    for (int i = 0; i < 3; i++) {
+        features.linearRms[i] = NAN;
+    }
+    features.linearMagnitude = NAN;
+    features.jerk = NAN;
+    features.fidgetEnergy = 0;
+    features.cadence = 0;
+    features.steps = 0;
+    stats = Stats();
+}
+
+void MotionFusion::initialize(float ax, float ay, float az) {
+    // Shortest rotation taking the measured up axis to earth +Z
+    float norm = sqrtf(ax * ax + ay * ay + az * az);
+    if (norm <= 0) {
+        return;
+    }
+    ax /= norm;
+    ay /= norm;
+    az /= norm;
+    if (az > -0.999f) {
+        float w = sqrtf(0.5f * (1 + az));
+        q0 = w;
+        q1 = ay / (2 * w);
+        q2 = -ax / (2 * w);
+        q3 = 0;
+    } else {
+        q0 = 0;
+        q1 = 1;
+        q2 = q3 = 0;
+    }
+    primed = true;
+}
+
+void MotionFusion::updateOrientation(float ax, float ay, float az, float gx, float gy, float gz) {
+    // Rate of change of the quaternion from the gyro
+    float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qDot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qDot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qDot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    float norm = ax * ax + ay * ay + az * az;
+    if (norm > 0) {
+        float recip = 1.0f / sqrtf(norm);
+        ax *= recip;
+        ay *= recip;
+        az *= recip;
+
+        // Gradient descent step toward the measured gravity direction
+        float _2q0 = 2 * q0, _2q1 = 2 * q1, _2q2 = 2 * q2, _2q3 = 2 * q3;
+        float _4q0 = 4 * q0, _4q1 = 4 * q1, _4q2 = 4 * q2;
+        float _8q1 = 8 * q1, _8q2 = 8 * q2;
+        float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+        float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        float s1 = _4q1 * q3q3 - _2q3 * ax + 4 * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        float s2 = 4 * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        float s3 = 4 * q1q1 * q3 - _2q1 * ax + 4 * q2q2 * q3 - _2q2 * ay;
+        float sNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (sNorm > 0) {
+            float step = BETA / sqrtf(sNorm);
+            qDot0 -= step * s0;
+            qDot1 -= step * s1;
+            qDot2 -= step * s2;
+            qDot3 -= step * s3;
+        }
+    }
+
+    q0 += qDot0 * dt;
+    q1 += qDot1 * dt;
+    q2 += qDot2 * dt;
+    q3 += qDot3 * dt;
+    float recip = 1.0f / sqrtf(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q0 *= recip;
+    q1 *= recip;
+    q2 *= recip;
+    q3 *= recip;
+}
+
+void MotionFusion::processBatch(const float* ax, const float* ay, const float* az,
+                                const float* gx, const float* gy, const float* gz, int count) {
+    if (count <= 0) {
+        return;
+    }
+    uint32_t start = Utils::cycleCount();
+    if (!primed) {
+        initialize(ax[0], ay[0], az[0]);
+    }
+
+    float squares[3] = { 0, 0, 0 };
+    float jerkSquares = 0;
+    for (int i = 0; i < count; i++) {
+        updateOrientation(ax[i], ay[i], az[i], gx[i], gy[i], gz[i]);
+
+        // Earth's up axis expressed in the sensor frame
+        float upX = 2 * (q1 * q3 - q0 * q2);
+        float upY = 2 * (q0 * q1 + q2 * q3);
+        float upZ = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+
+        float linX = ax[i] - GRAVITY * upX;
+        float linY = ay[i] - GRAVITY * upY;
+        float linZ = az[i] - GRAVITY * upZ;
+        squares[0] += linX * linX;
+        squares[1] += linY * linY;
+        squares[2] += linZ * linZ;
+
+        float frame[FILTER_CHANNELS] = {
+            linX, linY, linZ, linX * upX + linY * upY + linZ * upZ
+        };
+        filters.process(frame);
+        float smoothedX = frame[FILTER_X];
+        float smoothedY = frame[FILTER_Y];
+        float smoothedZ = frame[FILTER_Z];
+        float dX = smoothedX - previousLinear[0];
+        float dY = smoothedY - previousLinear[1];
+        float dZ = smoothedZ - previousLinear[2];
+        jerkSquares += dX * dX + dY * dY + dZ * dZ;
+        previousLinear[0] = smoothedX;
+        previousLinear[1] = smoothedY;
+        previousLinear[2] = smoothedZ;
+
+        detectStep(frame[FILTER_VERTICAL]);
+        if (stepStreak == 0) {
+            float energy = smoothedX * smoothedX + smoothedY * smoothedY + smoothedZ * smoothedZ;
+            features.fidgetEnergy = fidget.addValue(energy);
+        }
+        sampleIndex++;
+    }
+
+    float recipCount = 1.0f / count;
+    for (int i = 0; i < 3; i++) {
+        features.linearRms[i] = sqrtf(squares[i] * recipCount);
+    }
+    features.linearMagnitude = sqrtf((squares[0] + squares[1] + squares[2]) * recipCount);
+    features.jerk = sqrtf(jerkSquares * recipCount) * sampleRate;
+
+    // Tilt angles, aerospace convention
+    features.roll = atan2f(2 * (q0 * q1 + q2 * q3), 1 - 2 * (q1 * q1 + q2 * q2)) * RAD_TO_DEG;
+    features.pitch = asinf(constrain(2 * (q0 * q2 - q3 * q1), -1.0f, 1.0f)) * RAD_TO_DEG;
+
+    uint32_t cycles = Utils::cycleCount() - start;
+    stats.samples += count;
+    stats.lastBatchCycles = cycles;
+    stats.totalCycles += cycles;
+    if (cycles > stats.maxBatchCycles) {
+        stats.maxBatchCycles = cycles;
+    }
+}
+
+void MotionFusion::detectStep(float filtered) {
+    // Local maximum of vertical acceleration at n - 1
+    if (vertical1 > STEP_THRESHOLD && vertical1 >= vertical2 && vertical1 > filtered) {
+        uint32_t peakIndex = sampleIndex - 1;
+        uint32_t interval = peakIndex - lastStepIndex;
+        if (stepStreak == 0 || interval >= minStepSamples) {
+            if (stepStreak > 0 && interval <= maxStepSamples) {
+                stepInterval.addValue(interval);
+                stepStreak++;
+            } else {
+                // First step of a new bout
+                stepInterval.reset();
+                stepStreak = 1;
+            }
+            lastStepIndex = peakIndex;
+            features.steps++;
+        }
+    }
+    vertical2 = vertical1;
+    vertical1 = filtered;
+
+    if (stepStreak > 0 && sampleIndex - lastStepIndex > maxStepSamples) {
+        stepStreak = 0;
+        stepInterval.reset();
+    }
+    // Two regular intervals before calling it walking
+    features.cadence = stepStreak >= 3 ? 60.0f * sampleRate / stepInterval.getValue() : 0.0f;
+}
+
+} // namespace Sensors
+} // namespace Emopod
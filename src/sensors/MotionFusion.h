@@ -0,0 +1,124 @@
+#ifndef MOTION_FUSION_H
+#define MOTION_FUSION_H
+
+#include <Arduino.h>
+#include "utils/Biquad.h"
+#include "utils/FilterBank.h"
+#include "utils/Statistics.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * MotionFusion - Orientation, gravity removal and activity features
+ *
+ * A Madgwick filter (6-axis IMU form) integrates the gyro into a
+ * quaternion and pulls it toward the accelerometer's gravity direction
+ * with gain BETA, so tilt stays right while gyro bias is trimmed out.
+ * The quaternion starts from the first accelerometer sample rather than
+ * converging from identity.
+ *
+ * Gravity along the estimated up axis is subtracted from every sample,
+ * which leaves linear acceleration in the sensor frame; its projection on
+ * the up axis is the vertical acceleration used for steps. On top of that:
+ *   jerk            RMS rate of change of linear acceleration (low-passed
+ *                   to JERK_CUTOFF_HZ so sensor noise is not differentiated)
+ *   fidget energy   mean squared linear acceleration over FIDGET_TIME_S,
+ *                   held from the first step of a bout so
+ *                   locomotion does not count
+ *   cadence         steps per minute from peaks of low-passed vertical
+ *                   acceleration; 0 once no step is seen for MAX_STEP_S
+ * Batch features cover the last processBatch() call; the rest run
+ * continuously. Input units are m/s^2 and rad/s.
+ */
+class MotionFusion {
+public:
+    struct Features {
+        float roll;               // degrees
+        float pitch;              // degrees
+        float linearRms[3];       // per sensor axis, m/s^2, last batch
+        float linearMagnitude;    // RMS |linear|, m/s^2, last batch
+        float jerk;               // RMS, m/s^3, last batch
+        float fidgetEnergy;       // (m/s^2)^2
+        float cadence;            // steps per minute
+        uint32_t steps;
+    };
+
+    struct Stats {
+        uint32_t samples;
+        uint32_t lastBatchCycles;
+        uint32_t maxBatchCycles;
+        uint64_t totalCycles;
+    };
+
+private:
+    static constexpr float GRAVITY = 9.80665f;
+    static constexpr float BETA = 0.05f;
+    static constexpr float JERK_CUTOFF_HZ = 5.0f;
+    static constexpr float STEP_CUTOFF_HZ = 3.0f;
+    static constexpr float STEP_THRESHOLD = 1.0f;   // m/s^2 vertical
+    static constexpr float MIN_STEP_S = 0.25f;      // 240 steps/min
+    static constexpr float MAX_STEP_S = 2.0f;
+    static constexpr float FIDGET_TIME_S = 5.0f;
+    static constexpr float STEP_ALPHA = 0.25f;
+
+    float sampleRate;
+    float dt;
+    uint32_t minStepSamples;
+    uint32_t maxStepSamples;
+
+    bool primed;
+    float q0, q1, q2, q3;
+
+    // Linear acceleration per axis for jerk and fidget, vertical for steps
+    enum FilterChannel {
+        FILTER_X,
+        FILTER_Y,
+        FILTER_Z,
+        FILTER_VERTICAL,
+        FILTER_CHANNELS
+    };
+
+    Utils::FilterBank<FILTER_CHANNELS> filters;
+    float previousLinear[3];
+    float vertical1;            // filtered vertical acceleration at n - 1
+    float vertical2;            // at n - 2
+
+    uint32_t sampleIndex;
+    uint32_t lastStepIndex;
+    Ewma stepInterval;          // samples, unprimed until two steps
+    Ewma fidget;
+    int stepStreak;
+
+    Features features;
+    Stats stats;
+
+    void initialize(float ax, float ay, float az);
+    void updateOrientation(float ax, float ay, float az, float gx, float gy, float gz);
+    void detectStep(float filtered);
+
+public:
+    explicit MotionFusion(float sampleRate = 100.0f);
+
+    void configure(float sampleRate);
+    void reset();
+
+    // One batch of samples, stored axis by axis
+    void processBatch(const float* ax, const float* ay, const float* az,
+                      const float* gx, const float* gy, const float* gz, int count);
+
+    const Features& getFeatures() const { return features; }
+    const Stats& getStats() const { return stats; }
+    float getSampleRate() const { return sampleRate; }
+    bool isWalking() const { return features.cadence > 0; }
+
+    // Orientation as a unit quaternion (w, x, y, z), sensor to earth
+    void getQuaternion(float q[4]) const {
+        q[0] = q0; q[1] = q1; q[2] = q2; q[3] = q3;
+    }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,95 @@
+#include "PpgBeatDetector.h"
+
+namespace Emopod {
+namespace Sensors {
+
+PpgBeatDetector::PpgBeatDetector(float sampleRate, float minSlope, bool inverted) {
+    configure(sampleRate, minSlope, inverted);
+}
+
+void PpgBeatDetector::configure(float rate, float floor, bool invert) {
+    sampleRate = rate > 0 ? rate : 100.0f;
+    minSlope = floor;
+    inverted = invert;
+    refractorySamples = (uint32_t)(REFRACTORY_S * sampleRate);
+    learningSamples = (uint32_t)(LEARNING_S * sampleRate);
+    envelopeDecay = expf(-1.0f / (ENVELOPE_TIME_S * sampleRate));
+    highPass = Utils::Biquad::highPass(sampleRate, LOW_CUTOFF_HZ);
+    lowPass = Utils::Biquad::lowPass(sampleRate, HIGH_CUTOFF_HZ);
+    reset();
+}
+
+void PpgBeatDetector::reset() {
+    highPass.reset();
+    lowPass.reset();
+    primed = false;
+    previous = 0;
+    slope1 = 0;
+    slope2 = 0;
+    envelope = 0;
+    sampleIndex = 0;
+    lastBeatIndex = 0;
+    intervalAverage = Ewma(INTERVAL_ALPHA);
+    hasBeat = false;
+    stats = Stats();
+}
+
+int PpgBeatDetector::processBlock(const uint32_t* samples, int count, Beat* beats, int maxBeats) {
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        float x = (float)samples[i];
+        if (!primed) {
+            // Start from the first sample's DC level so it does not ring
+            highPass.prime(x);
+            lowPass.prime(0);
+            primed = true;
+        }
+        float y = lowPass.process(highPass.process(x));
+        if (inverted) {
+            y = -y;
+        }
+        float slope = y - previous;
+        previous = y;
+        envelope *= envelopeDecay;
+
+        if (sampleIndex < learningSamples) {
+            envelope = max(envelope, slope);
+        } else if (slope1 > getThreshold() && slope1 >= slope2 && slope1 > slope) {
+            // Slope peak at n - 1
+            uint32_t peakIndex = sampleIndex - 1;
+            uint32_t interval = peakIndex - lastBeatIndex;
+            float refractory = refractorySamples;
+            if (intervalAverage.isPrimed()) {
+                refractory = max(refractory, REFRACTORY_FRACTION * intervalAverage.getValue());
+            }
+            if (hasBeat && interval < refractory) {
+                stats.refractoryRejects++;
+            } else {
+                if (hasBeat && interval < MAX_INTERVAL_S * sampleRate) {
+                    intervalAverage.addValue(interval);
+                }
+                float curvature = slope2 - 2.0f * slope1 + slope;
+                float delta = curvature < 0 ? 0.5f * (slope2 - slope) / curvature : 0.0f;
+                delta = constrain(delta, -0.5f, 0.5f);
+                if (found < maxBeats) {
+                    beats[found].offset = (i - 1) + delta;
+                    beats[found].slope = slope1;
+                    found++;
+                }
+                lastBeatIndex = peakIndex;
+                hasBeat = true;
+                envelope = max(envelope, slope1);
+                stats.beats++;
+            }
+        }
+
+        slope2 = slope1;
+        slope1 = slope;
+        sampleIndex++;
+    }
+    stats.samples += count;
+    return found;
+}
+
+} // namespace Sensors
+} // namespace Emopod
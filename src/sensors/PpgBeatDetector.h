@@ -0,0 +1,96 @@
+#ifndef PPG_BEAT_DETECTOR_H
+#define PPG_BEAT_DETECTOR_H
+
+#include <Arduino.h>
+#include "utils/Biquad.h"
+#include "utils/Statistics.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * PpgBeatDetector - Per-instance pulse detector for one PPG channel
+ *
+ * The beat source of PulseOximeterSensor (the MAX30100 in the sensor
+ * table) and of HeartRateSensor. Unlike SparkFun's checkForBeat(), its
+ * state is per instance and it takes whole buffers from any channel.
+ *
+ * Each call takes a whole buffer. Samples are band-passed to 0.5-3 Hz
+ * and the beat fiducial is the point of maximum systolic upstroke slope
+ * (reflected light falls as blood volume rises, so the channel is
+ * inverted by default). A slope peak counts as a beat when it exceeds a
+ * fraction of an envelope that jumps to each beat's slope and decays
+ * between beats, so the threshold adapts to perfusion and sags toward a
+ * missed beat. Peaks inside the refractory period after a beat are
+ * dropped; the period is half the running beat interval (never under
+ * 200 BPM), which also covers the dicrotic notch. The first LEARNING_S
+ * seconds only train the envelope.
+ *
+ * Beat positions are interpolated between samples (parabola through the
+ * slope peak) and reported in samples relative to the buffer's first
+ * sample, so callers with sample timestamps get sub-sample beat times.
+ */
+class PpgBeatDetector {
+public:
+    struct Beat {
+        float offset;       // samples from the first sample of the buffer
+        float slope;        // filtered counts per sample at the fiducial
+    };
+
+    struct Stats {
+        uint32_t samples;
+        uint32_t beats;
+        uint32_t refractoryRejects;
+    };
+
+private:
+    static constexpr float LOW_CUTOFF_HZ = 0.5f;
+    static constexpr float HIGH_CUTOFF_HZ = 3.0f;
+    static constexpr float REFRACTORY_S = 0.3f;        // 200 BPM
+    static constexpr float REFRACTORY_FRACTION = 0.5f; // of the running interval
+    static constexpr float MAX_INTERVAL_S = 2.0f;      // longer gaps do not train it
+    static constexpr float INTERVAL_ALPHA = 0.25f;
+    static constexpr float THRESHOLD_FRACTION = 0.5f;
+    static constexpr float ENVELOPE_TIME_S = 1.5f;
+    static constexpr float LEARNING_S = 1.5f;
+
+    float sampleRate;
+    float minSlope;
+    bool inverted;
+    uint32_t refractorySamples;
+    uint32_t learningSamples;
+    float envelopeDecay;
+
+    Utils::Biquad highPass;
+    Utils::Biquad lowPass;
+    bool primed;
+    float previous;     // filtered signal at n - 1
+    float slope1;       // slope at n - 1
+    float slope2;       // slope at n - 2
+    float envelope;
+
+    uint32_t sampleIndex;        // samples since reset()
+    uint32_t lastBeatIndex;
+    Ewma intervalAverage;        // samples, unprimed until two beats
+    bool hasBeat;
+    Stats stats;
+
+public:
+    // minSlope: absolute floor for the threshold, filtered counts per sample
+    explicit PpgBeatDetector(float sampleRate = 100.0f, float minSlope = 0.0f, bool inverted = true);
+
+    void configure(float sampleRate, float minSlope = 0.0f, bool inverted = true);
+    void reset();
+
+    // Returns the number of beats written to beats (at most maxBeats)
+    int processBlock(const uint32_t* samples, int count, Beat* beats, int maxBeats);
+
+    float getThreshold() const { return max(minSlope, THRESHOLD_FRACTION * envelope); }
+    float getSampleRate() const { return sampleRate; }
+    const Stats& getStats() const { return stats; }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef SENSOR_DRIVER_H
+#define SENSOR_DRIVER_H
+
+#include <Arduino.h>
+#include "utils/Statistics.h"
+#include "utils/OutlierFilter.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * SensorDriver - CRTP base shared by every sensor driver
+ *
+ * A driver derives as `class X : public SensorDriver<X, Window>` and provides:
+ *
+ *   static constexpr const char* NAME;        // log / health name
+ *   static constexpr const char* KEY;         // JSON field
+ *   static constexpr unsigned long PERIOD_MS; // native sampling period
+ *   static constexpr unsigned long COST_US;   // expected cost of one sample()
+ *   void beginDevice();
+ *   bool acquire(float& raw);                 // true when a new raw value exists
+ *
+ * and may shadow serialize() to add fields. The base owns the smoothing
+ * window and the change detection; all calls resolve at compile time.
+ *
+ * Raw values can be screened for artifacts before they reach the window
+ * (setOutlierLimits(); off by default). Rejected values are counted, not
+ * published. A driver that screens samples of its own shadows
+ * getCheckedCount() and getRejectedCount() to include them.
+ */
+template <typename Derived, size_t Window>
+class SensorDriver {
+public:
+    static const size_t OUTLIER_WINDOW = 7;
+
+private:
+    MovingAverage<Window> average;
+    Utils::OutlierFilter<OUTLIER_WINDOW> outliers;
+    unsigned long lastScreenMs;
+    float rawValue;
+    float value;
+    uint32_t sampleCount;
+
+    Derived& self() { return static_cast<Derived&>(*this); }
+    const Derived& self() const { return static_cast<const Derived&>(*this); }
+
+public:
+    SensorDriver() : lastScreenMs(0), rawValue(NAN), value(NAN), sampleCount(0) {}
+
+    void begin() {
+        self().beginDevice();
+    }
+
+    // Acquire and smooth; returns true when the published value changed
+    bool sample() {
+        float raw;
+        if (!self().acquire(raw) || isnan(raw)) {
+            return false;
+        }
+        if (outliers.isEnabled()) {
+            unsigned long now = millis();
+            float elapsed = outliers.getCheckedCount() > 0 ? (now - lastScreenMs) * 0.001f : 0.0f;
+            lastScreenMs = now;
+            if (!outliers.accept(raw, elapsed)) {
+                return false;
+            }
+        }
+        rawValue = raw;
+        sampleCount++;
+        float smoothed = average.addValue(raw);
+        if (smoothed == value) {
+            return false;
+        }
+        value = smoothed;
+        return true;
+    }
+
+    // Smoothed value, NAN until the first sample
+    float getValue() const { return value; }
+    float getAverage() const { return value; }
+    float getRawValue() const { return rawValue; }
+
+    // Raw values acquired so far, whether or not they moved the average
+    uint32_t getSampleCount() const { return sampleCount; }
+
+    void setOutlierLimits(const Utils::OutlierLimits& limits) { outliers.setLimits(limits); }
+    const Utils::OutlierFilter<OUTLIER_WINDOW>& getOutlierFilter() const { return outliers; }
+
+    // Values screened for artifacts, and how many of them were dropped
+    uint32_t getCheckedCount() const { return outliers.getCheckedCount(); }
+    uint32_t getRejectedCount() const { return outliers.getRejectedCount(); }
+
+    template <typename Document>
+    void serialize(Document& doc) const {
+        doc[Derived::KEY] = value;
+    }
+
+    static const char* getName() { return Derived::NAME; }
+    static unsigned long getPeriodMs() { return Derived::PERIOD_MS; }
+    static unsigned long getCostUs() { return Derived::COST_US; }
+
+protected:
+    void resetAverage() {
+        average.reset();
+        outliers.reset();
+        value = NAN;
+    }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
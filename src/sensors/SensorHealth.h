@@ -7,16 +7,26 @@
 namespace Emopod {
 namespace Sensors {
 
+// Tracks when each sensor last produced a value and how many of its raw
+// values were rejected as artifacts. A sensor is unhealthy when silent for
+// two check intervals; one rejecting most of its values in an interval is
+// reported as noisy but stays healthy.
 class SensorHealth {
 private:
     struct SensorStatus {
         unsigned long lastUpdateTime;
         float lastValue;
         bool isHealthy;
+        bool isNoisy;
+        uint32_t checkedSamples;
+        uint32_t rejectedSamples;
+        uint32_t intervalChecked;
+        uint32_t intervalRejected;
         const char* name;
     };
     
     static const int MAX_SENSORS = 10;
+    static constexpr float NOISY_SHARE = 0.5f;
     SensorStatus sensors[MAX_SENSORS];
     int sensorCount;
     unsigned long healthCheckInterval;
@@ -32,6 +42,11 @@ public:
                 .lastUpdateTime = 0,
                 .lastValue = 0.0f,
                 .isHealthy = true,
+                .isNoisy = false,
+                .checkedSamples = 0,
+                .rejectedSamples = 0,
+                .intervalChecked = 0,
+                .intervalRejected = 0,
                 .name = name
             };
             sensorCount++;
@@ -45,6 +60,16 @@ public:
         }
     }
     
+    // Artifact screening results since the last call for this sensor
+    void recordScreening(int index, uint32_t checked, uint32_t rejected) {
+        if (index >= 0 && index < sensorCount) {
+            sensors[index].checkedSamples += checked;
+            sensors[index].rejectedSamples += rejected;
+            sensors[index].intervalChecked += checked;
+            sensors[index].intervalRejected += rejected;
+        }
+    }
+    
     void checkHealth() {
         unsigned long currentTime = millis();
         if (currentTime - lastHealthCheck >= healthCheckInterval) {
@@ -55,10 +80,23 @@ public:
                 sensors[i].isHealthy = (currentTime - sensors[i].lastUpdateTime) <= healthCheckInterval * 2;
                 
                 if (wasHealthy && !sensors[i].isHealthy) {
-                    Emopod::Utils::Logger::warn("SENSOR", "Sensor %s is not responding", sensors[i].name);
+                    LOG_WARN(SENSOR, "Sensor %s is not responding", sensors[i].name);
                 } else if (!wasHealthy && sensors[i].isHealthy) {
-                    Emopod::Utils::Logger::info("SENSOR", "Sensor %s is back online", sensors[i].name);
+                    LOG_INFO(SENSOR, "Sensor %s is back online", sensors[i].name);
                 }
+                
+                SensorStatus& status = sensors[i];
+                bool wasNoisy = status.isNoisy;
+                status.isNoisy = status.intervalChecked > 0 &&
+                                 status.intervalRejected > NOISY_SHARE * status.intervalChecked;
+                if (status.isNoisy && !wasNoisy) {
+                    LOG_WARN(SENSOR, "Sensor %s rejected %u of %u samples as artifacts", status.name,
+                             (unsigned)status.intervalRejected, (unsigned)status.intervalChecked);
+                } else if (wasNoisy && !status.isNoisy) {
+                    LOG_INFO(SENSOR, "Sensor %s is no longer noisy", status.name);
+                }
+                status.intervalChecked = 0;
+                status.intervalRejected = 0;
             }
         }
     }
@@ -67,6 +105,22 @@ public:
         return (index >= 0 && index < sensorCount) ? sensors[index].isHealthy : false;
     }
     
+    bool isSensorNoisy(int index) const {
+        return (index >= 0 && index < sensorCount) ? sensors[index].isNoisy : false;
+    }
+    
+    uint32_t getRejectedCount(int index) const {
+        return (index >= 0 && index < sensorCount) ? sensors[index].rejectedSamples : 0;
+    }
+    
+    // Share of screened samples rejected since registration, 0..1
+    float getRejectionRate(int index) const {
+        if (index < 0 || index >= sensorCount || sensors[index].checkedSamples == 0) {
+            return 0.0f;
+        }
+        return (float)sensors[index].rejectedSamples / sensors[index].checkedSamples;
+    }
+    
     float getLastValue(int index) const {
         return (index >= 0 && index < sensorCount) ? sensors[index].lastValue : 0.0f;
     }
@@ -0,0 +1,92 @@
+#ifndef SENSOR_TABLE_H
+#define SENSOR_TABLE_H
+
+#include <tuple>
+#include <utility>
+#include "sensors/AcquisitionScheduler.h"
+#include "sensors/SensorHealth.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * SensorTable - Compile-time list of the drivers a build actually uses
+ *
+ * Drivers are stored by value in a tuple and visited with fold expressions,
+ * so every per-driver call is resolved statically. Scheduling, health and
+ * serialization are all derived from the one list; a driver that is not
+ * named here is never instantiated.
+ */
+template <typename... Drivers>
+class SensorTable {
+private:
+    std::tuple<Drivers...> drivers;
+
+    template <typename Driver, typename First, typename... Rest>
+    struct IndexOf {
+        static constexpr int value = 1 + IndexOf<Driver, Rest...>::value;
+    };
+
+    template <typename Driver, typename... Rest>
+    struct IndexOf<Driver, Driver, Rest...> {
+        static constexpr int value = 0;
+    };
+
+public:
+    explicit SensorTable(Drivers... instances) : drivers(std::move(instances)...) {}
+
+    static constexpr int size() {
+        return sizeof...(Drivers);
+    }
+
+    template <typename Driver>
+    static constexpr int indexOf() {
+        return IndexOf<Driver, Drivers...>::value;
+    }
+
+    template <typename Driver>
+    Driver& get() {
+        return std::get<Driver>(drivers);
+    }
+
+    template <typename Driver>
+    const Driver& get() const {
+        return std::get<Driver>(drivers);
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor&& visit) {
+        std::apply([&](Drivers&... driver) { (visit(driver), ...); }, drivers);
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor&& visit) const {
+        std::apply([&](const Drivers&... driver) { (visit(driver), ...); }, drivers);
+    }
+
+    void begin() {
+        forEach([](auto& driver) { driver.begin(); });
+    }
+
+    // Owner::sampleJob<Driver> is the scheduler entry point for each driver
+    template <typename Owner>
+    void registerJobs(AcquisitionScheduler& scheduler, Owner* owner) {
+        (scheduler.addJob(Drivers::getName(), Drivers::getPeriodMs(), Drivers::getCostUs(),
+                          &Owner::template sampleJob<Drivers>, owner), ...);
+    }
+
+    // Health slots are assigned in table order, matching indexOf<Driver>()
+    void registerHealth(SensorHealth& health) const {
+        (health.registerSensor(Drivers::getName()), ...);
+    }
+
+    template <typename Document>
+    void serialize(Document& doc) const {
+        forEach([&](const auto& driver) { driver.serialize(doc); });
+    }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
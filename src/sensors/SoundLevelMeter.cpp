@@ -0,0 +1,221 @@
+#include "SoundLevelMeter.h"
+
+namespace Emopod {
+namespace Sensors {
+
+// Uncalibrated default: full-scale RMS reads as 110 dB
+static const float DEFAULT_CALIBRATION_DB = 110.0f;
+
+SoundLevelMeter::SoundLevelMeter() : calibrationDb(DEFAULT_CALIBRATION_DB) {
+    configure(8000.0f);
+}
+
+void SoundLevelMeter::configure(float rate, bool aWeighting, float windowMs) {
+    sampleRate = rate > 0 ? rate : 8000.0f;
+    weighted = aWeighting;
+    windowLength = (uint32_t)(sampleRate * windowMs / 1000.0f);
+    if (windowLength < 1) {
+        windowLength = 1;
+    }
+    dcPole = 1.0f - 2.0f * (float)M_PI * DC_CUTOFF_HZ / sampleRate;
+#if EMOPOD_FIXED_POINT
+    inputScale = Utils::FixedScale::fromRatio(2147483648.0 / FULL_SCALE);
+    dcPoleQ31 = Utils::Q31::fromFloat(dcPole).getRaw();
+#endif
+    if (weighted) {
+        designAWeighting();
+    }
+    reset();
+}
+
+void SoundLevelMeter::designAWeighting() {
+    // A-weighting: s^4 / ((s + w1)^2 (s + w2)(s + w3)(s + w4)^2)
+    const double w1 = 2 * M_PI * 20.598997;
+    const double w2 = 2 * M_PI * 107.65265;
+    const double w3 = 2 * M_PI * 737.86223;
+    const double w4 = 2 * M_PI * 12194.217;
+
+    Utils::Biquad designs[SECTION_COUNT] = {
+        Utils::Biquad::bilinear(sampleRate, 1, 0, 0, 1, 2 * w1, w1 * w1),
+        Utils::Biquad::bilinear(sampleRate, 1, 0, 0, 1, w2 + w3, w2 * w3),
+        Utils::Biquad::bilinear(sampleRate, 0, 0, 1, 1, 2 * w4, w4 * w4)
+    };
+
+    float gain = 1.0f;
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        gain *= designs[i].magnitude(sampleRate, 1000.0f);
+    }
+    designs[SECTION_COUNT - 1].scale(1.0f / gain);
+
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        sections[i] = Utils::SampleBiquad(designs[i]);
+    }
+}
+
+void SoundLevelMeter::reset() {
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        sections[i].reset();
+    }
+    dcLastInput = 0;
+    dcLastOutput = 0;
+    primed = false;
+    windowSamples = 0;
+    windowEnergy = 0;
+    windowPeak = 0;
+    leqIndex = 0;
+    leqCount = 0;
+    latest = { 0, NAN, NAN, NAN };
+    windows = 0;
+    resetLoad();
+}
+
+void SoundLevelMeter::resetLoad() {
+    busyUs = 0;
+    samplesProcessed = 0;
+}
+
+float SoundLevelMeter::toDb(float meanSquare) const {
+    float ratio = meanSquare / (FULL_SCALE * FULL_SCALE);
+    if (ratio < ENERGY_FLOOR) {
+        ratio = ENERGY_FLOOR;
+    }
+    return 10.0f * log10f(ratio) + calibrationDb;
+}
+
+bool SoundLevelMeter::processBlock(const uint16_t* samples, int count) {
+    unsigned long start = micros();
+    bool completed = false;
+    while (count > 0) {
+        int chunk = count < MAX_BLOCK ? count : MAX_BLOCK;
+        processChunk(samples, chunk, completed);
+        samples += chunk;
+        count -= chunk;
+        samplesProcessed += chunk;
+    }
+    busyUs += micros() - start;
+    return completed;
+}
+
+void SoundLevelMeter::processChunk(const uint16_t* samples, int count, bool& completed) {
+#if EMOPOD_FIXED_POINT
+    const int32_t midScale = (int32_t)MID_SCALE;
+    if (!primed) {
+        dcLastInput = inputScale.apply(samples[0] - midScale);
+        primed = true;
+    }
+
+    // DC blocker: y[n] = x[n] - x[n-1] + p * y[n-1], Q31
+    int32_t x1 = dcLastInput;
+    int32_t y1 = dcLastOutput;
+    for (int i = 0; i < count; i++) {
+        int32_t x = inputScale.apply(samples[i] - midScale);
+        int64_t feedback = ((int64_t)dcPoleQ31 * y1 + (1 << 30)) >> 31;
+        y1 = Utils::Q31::saturate((int64_t)x - x1 + feedback);
+        x1 = x;
+        scratch[i] = y1;
+    }
+#else
+    if (!primed) {
+        dcLastInput = samples[0];
+        primed = true;
+    }
+
+    // DC blocker: y[n] = x[n] - x[n-1] + p * y[n-1]
+    float x1 = dcLastInput;
+    float y1 = dcLastOutput;
+    for (int i = 0; i < count; i++) {
+        float x = samples[i];
+        y1 = x - x1 + dcPole * y1;
+        x1 = x;
+        scratch[i] = y1;
+    }
+#endif
+    dcLastInput = x1;
+    dcLastOutput = y1;
+
+    if (weighted) {
+        for (int s = 0; s < SECTION_COUNT; s++) {
+            sections[s].processBlock(scratch, scratch, count);
+        }
+    }
+
+    int i = 0;
+    while (i < count) {
+        int end = count;
+        uint32_t remaining = windowLength - windowSamples;
+        if ((uint32_t)(end - i) > remaining) {
+            end = i + (int)remaining;
+        }
+#if EMOPOD_FIXED_POINT
+        int64_t energy = 0;
+        int32_t peak = windowPeak;
+        for (int j = i; j < end; j++) {
+            int32_t v = scratch[j] >> 15;              // Q16; squares need 64 bits
+            energy += (int64_t)v * v;
+            int32_t magnitude = v < 0 ? -v : v;
+            peak = magnitude > peak ? magnitude : peak;
+        }
+#else
+        float energy = 0;
+        float peak = windowPeak;
+        for (int j = i; j < end; j++) {
+            float v = scratch[j];
+            energy += v * v;
+            float magnitude = fabsf(v);
+            peak = magnitude > peak ? magnitude : peak;
+        }
+#endif
+        windowEnergy += energy;
+        windowPeak = peak;
+        windowSamples += end - i;
+        i = end;
+
+        if (windowSamples == windowLength) {
+            finishWindow();
+            completed = true;
+        }
+    }
+}
+
+void SoundLevelMeter::finishWindow() {
+#if EMOPOD_FIXED_POINT
+    // Q16 of FULL_SCALE back to ADC counts
+    const float countsPerUnit = FULL_SCALE / 65536.0f;
+    float meanSquare = (float)windowEnergy / windowLength * countsPerUnit * countsPerUnit;
+    float peak = windowPeak * countsPerUnit;
+#else
+    float meanSquare = windowEnergy / windowLength;
+    float peak = windowPeak;
+#endif
+
+    leqEnergy[leqIndex] = meanSquare;
+    leqIndex = (leqIndex + 1) % LEQ_WINDOWS;
+    if (leqCount < LEQ_WINDOWS) {
+        leqCount++;
+    }
+    float leqSum = 0;
+    for (int i = 0; i < leqCount; i++) {
+        leqSum += leqEnergy[i];
+    }
+
+    latest.rms = sqrtf(meanSquare);
+    latest.levelDb = toDb(meanSquare);
+    latest.peakDb = toDb(peak * peak);
+    latest.leqDb = toDb(leqSum / leqCount);
+    windows++;
+
+    windowSamples = 0;
+    windowEnergy = 0;
+    windowPeak = 0;
+}
+
+float SoundLevelMeter::getCpuLoad() const {
+    if (samplesProcessed == 0) {
+        return 0.0f;
+    }
+    float realTimeUs = samplesProcessed * 1e6f / sampleRate;
+    return busyUs / realTimeUs;
+}
+
+} // namespace Sensors
+} // namespace Emopod
@@ -0,0 +1,113 @@
+#ifndef SOUND_LEVEL_METER_H
+#define SOUND_LEVEL_METER_H
+
+#include <Arduino.h>
+#include "utils/Biquad.h"
+#include "utils/FixedPoint.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * SoundLevelMeter - Block RMS, peak and Leq of the microphone stream
+ *
+ * Raw 12-bit samples are DC-blocked and optionally A-weighted (IEC 61672
+ * poles mapped with the bilinear transform into three biquads, normalised
+ * to 0 dB at 1 kHz), then squared and summed over fixed windows. Each
+ * window yields its RMS level and peak; Leq is the energy mean of the last
+ * LEQ_WINDOWS windows. Levels are dBFS plus a calibration offset.
+ *
+ * Filtering runs section by section over the whole block with the state
+ * in registers, so the inner loops are branch-free multiply-adds. On
+ * targets without an FPU (EMOPOD_FIXED_POINT) samples are centred and
+ * scaled to Q31, the weighting runs on FixedBiquad sections and energy
+ * is summed in 64 bits; only the per-window results use float.
+ * Time spent in processBlock() is accounted against the real time the
+ * samples cover, giving the meter's share of one core.
+ */
+class SoundLevelMeter {
+public:
+    struct Window {
+        float rms;       // ADC counts, after DC removal and weighting
+        float levelDb;   // RMS level
+        float peakDb;    // largest |sample| in the window
+        float leqDb;     // equivalent level over the last LEQ_WINDOWS windows
+    };
+
+    static const int LEQ_WINDOWS = 8;
+    static const int MAX_BLOCK = 64;
+
+private:
+    static const int SECTION_COUNT = 3;
+    static constexpr float FULL_SCALE = 2048.0f;       // 12-bit amplitude about mid-scale
+    static constexpr float DC_CUTOFF_HZ = 10.0f;
+    static constexpr float ENERGY_FLOOR = 1e-12f;      // keeps silence finite in dB
+
+    float sampleRate;
+    bool weighted;
+    float calibrationDb;
+
+    Utils::SampleBiquad sections[SECTION_COUNT];
+    float dcPole;
+    Utils::Sample dcLastInput;
+    Utils::Sample dcLastOutput;
+    bool primed;
+    Utils::Sample scratch[MAX_BLOCK];
+
+    uint32_t windowLength;
+    uint32_t windowSamples;
+#if EMOPOD_FIXED_POINT
+    static constexpr float MID_SCALE = 2048.0f;        // counts mapped to 0
+    Utils::FixedScale inputScale;                      // counts to Q31 of FULL_SCALE
+    int32_t dcPoleQ31;
+    int64_t windowEnergy;                              // sum of Q16 squares
+    int32_t windowPeak;                                // Q16
+#else
+    float windowEnergy;
+    float windowPeak;
+#endif
+
+    float leqEnergy[LEQ_WINDOWS];
+    int leqIndex;
+    int leqCount;
+
+    Window latest;
+    uint32_t windows;
+
+    uint32_t busyUs;
+    uint64_t samplesProcessed;
+
+    void designAWeighting();
+    void processChunk(const uint16_t* samples, int count, bool& completed);
+    void finishWindow();
+    float toDb(float meanSquare) const;
+
+public:
+    SoundLevelMeter();
+
+    // windowMs: integration window for each RMS/peak result
+    void configure(float sampleRate, bool aWeighting = true, float windowMs = 125.0f);
+    void reset();
+
+    // Returns true if at least one window completed within the block
+    bool processBlock(const uint16_t* samples, int count);
+
+    const Window& getWindow() const { return latest; }
+    float getLeq() const { return latest.leqDb; }
+    uint32_t getWindowCount() const { return windows; }
+    bool isWeighted() const { return weighted; }
+    float getSampleRate() const { return sampleRate; }
+
+    // dB added to dBFS; set from a reading against a reference source
+    void setCalibrationOffset(float db) { calibrationDb = db; }
+    float getCalibrationOffset() const { return calibrationDb; }
+
+    // Fraction of real time spent in processBlock() since the last resetLoad()
+    float getCpuLoad() const;
+    void resetLoad();
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,180 @@
+#include "SpO2Estimator.h"
+
+namespace Emopod {
+namespace Sensors {
+
+SpO2Estimator::SpO2Estimator(float sampleRate, float fullScale)
+    : calibration({ -45.060f, 30.354f, 94.845f }) {
+    configure(sampleRate, fullScale);
+}
+
+void SpO2Estimator::configure(float rate, float scale) {
+    sampleRate = rate > 0 ? rate : 100.0f;
+    fullScale = scale;
+    dcAlpha = 1.0f / (DC_TIME_S * sampleRate);
+    Utils::Biquad band[2] = {
+        Utils::Biquad::highPass(sampleRate, PULSE_LOW_HZ),
+        Utils::Biquad::lowPass(sampleRate, PULSE_HIGH_HZ)
+    };
+    pulseFilters.setChannel(CHANNEL_RED, band, 2);
+    pulseFilters.setChannel(CHANNEL_IR, band, 2);
+    reset();
+}
+
+void SpO2Estimator::reset() {
+    pulseFilters.reset();
+    dcRed = 0;
+    dcIr = 0;
+    primed = false;
+    previousIr = 0;
+    threshold = 0;
+    armed = false;
+    inCycle = false;
+    previousCycleSamples = 0;
+    ratios.reset();
+    ratio = NAN;
+    perfusion = NAN;
+    quality = 0;
+    spo2 = NAN;
+    stats = Stats();
+    restartCycle();
+}
+
+void SpO2Estimator::restartCycle() {
+    maxRed = -INFINITY;
+    minRed = INFINITY;
+    maxIr = -INFINITY;
+    minIr = INFINITY;
+    clipped = false;
+    cycleSamples = 0;
+}
+
+int SpO2Estimator::processBatch(const uint32_t* red, const uint32_t* ir, int count) {
+    uint32_t before = stats.cycles;
+    for (int offset = 0; offset < count; offset += BLOCK_SIZE) {
+        processChunk(red + offset, ir + offset, min(BLOCK_SIZE, count - offset));
+    }
+    stats.samples += count;
+    return stats.cycles - before;
+}
+
+void SpO2Estimator::processChunk(const uint32_t* red, const uint32_t* ir, int count) {
+    if (!primed) {
+        dcRed = red[0];
+        dcIr = ir[0];
+        primed = true;
+    }
+
+    // Block means and peaks: straight loops with no carried state
+    uint32_t sumRed = 0;
+    uint32_t sumIr = 0;
+    uint32_t peak = 0;
+    for (int i = 0; i < count; i++) {
+        sumRed += red[i];
+        sumIr += ir[i];
+        peak = max(peak, max(red[i], ir[i]));
+    }
+
+    // DC moves toward the block mean, ramped so no step lands in the AC
+    float gain = min(1.0f, dcAlpha * count);
+    float redStep = gain * ((float)sumRed / count - dcRed) / count;
+    float irStep = gain * ((float)sumIr / count - dcIr) / count;
+    for (int i = 0; i < count; i++) {
+        ac[i][CHANNEL_RED] = (float)red[i] - (dcRed + redStep * (i + 1));
+        ac[i][CHANNEL_IR] = (float)ir[i] - (dcIr + irStep * (i + 1));
+    }
+    float startRed = dcRed;
+    float startIr = dcIr;
+    dcRed += redStep * count;
+    dcIr += irStep * count;
+
+    pulseFilters.processFrames(&ac[0][0], count);
+
+    if (dcIr < MIN_DC) {
+        // No finger: nothing in this block is a pulse
+        inCycle = false;
+        armed = false;
+        previousCycleSamples = 0;
+        quality = 0;
+        previousIr = ac[count - 1][CHANNEL_IR];
+        return;
+    }
+    if (peak >= CLIP_LEVEL * fullScale) {
+        clipped = true;
+    }
+
+    const uint32_t minSamples = (uint32_t)(MIN_CYCLE_S * sampleRate);
+    const uint32_t maxSamples = (uint32_t)(MAX_CYCLE_S * sampleRate);
+    for (int i = 0; i < count; i++) {
+        float r = ac[i][CHANNEL_RED];
+        float x = ac[i][CHANNEL_IR];
+        maxRed = max(maxRed, r);
+        minRed = min(minRed, r);
+        maxIr = max(maxIr, x);
+        minIr = min(minIr, x);
+        cycleSamples++;
+
+        if (x < -threshold) {
+            armed = true;
+        } else if (armed && previousIr < 0 && x >= 0 && (!inCycle || cycleSamples >= minSamples)) {
+            // Upward crossing; one closer than MIN_CYCLE_S is a notch, not a pulse
+            armed = false;
+            if (inCycle) {
+                // DC at this sample, from the ramp
+                closeCycle(startRed + redStep * (i + 1), startIr + irStep * (i + 1));
+            }
+            restartCycle();
+            inCycle = true;
+        }
+
+        if (inCycle && cycleSamples > maxSamples) {
+            // Pulse lost; wait for the next clean crossing
+            stats.rejectedCycles++;
+            inCycle = false;
+            previousCycleSamples = 0;
+            quality = 0;
+        }
+        previousIr = x;
+    }
+}
+
+bool SpO2Estimator::closeCycle(float redDc, float irDc) {
+    float ampRed = maxRed - minRed;
+    float ampIr = maxIr - minIr;
+    if (clipped || ampRed <= 0 || ampIr <= 0 || redDc <= 0) {
+        stats.rejectedCycles++;
+        quality = 0;
+        previousCycleSamples = cycleSamples;
+        return false;
+    }
+
+    perfusion = ampIr / irDc;
+    ratios.addValue((ampRed / redDc) / perfusion);
+    ratio = ratios.getMean();
+
+    float estimate = (calibration.a * ratio + calibration.b) * ratio + calibration.c;
+    spo2 = constrain(estimate, 0.0f, 100.0f);
+
+    // Quality: every factor 0..1, a single cycle cannot score above half
+    float perfusionQuality = constrain((perfusion - PERFUSION_MIN) / (PERFUSION_GOOD - PERFUSION_MIN),
+                                       0.0f, 1.0f);
+    float consistency = 0.5f;
+    if (ratios.getCount() > 1) {
+        float cv = ratios.getStdDev() / ratio;
+        consistency = constrain(1.0f - cv / RATIO_CV_LIMIT, 0.0f, 1.0f);
+    }
+    float rhythm = 0.5f;
+    if (previousCycleSamples > 0) {
+        float change = fabsf((float)cycleSamples - previousCycleSamples) / previousCycleSamples;
+        rhythm = constrain(1.0f - change / RHYTHM_LIMIT, 0.0f, 1.0f);
+    }
+    quality = perfusionQuality * consistency * rhythm;
+
+    threshold = HYSTERESIS * 0.5f * ampIr;
+    previousCycleSamples = cycleSamples;
+    stats.cycles++;
+    return true;
+}
+
+} // namespace Sensors
+} // namespace Emopod
@@ -0,0 +1,136 @@
+#ifndef SPO2_ESTIMATOR_H
+#define SPO2_ESTIMATOR_H
+
+#include <Arduino.h>
+#include "utils/Biquad.h"
+#include "utils/FilterBank.h"
+#include "utils/Statistics.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * SpO2Estimator - Ratio-of-ratios oxygen saturation from raw red/IR batches
+ *
+ * Samples are handled a block at a time. DC is tracked from block means and
+ * ramped linearly across each block, so the subtraction is a plain
+ * element-wise loop; the remaining AC is band-passed to the pulse band
+ * with identical filters on both channels (one filter bank, the channels
+ * interleaved), so R is unaffected.
+ * Pulse cycles are delimited by upward zero crossings of the IR AC (with
+ * hysteresis on the previous amplitude); each cycle gives the peak-to-peak
+ * AC of both channels and
+ *
+ *   R = (AC_red / DC_red) / (AC_ir / DC_ir)
+ *
+ * The mean R of the last few cycles goes through a quadratic calibration
+ * curve (Maxim's reference-design fit by default).
+ *
+ * The signal-quality index (0..1) multiplies perfusion (IR AC/DC), R
+ * consistency across cycles and rhythm regularity; it is zero while the
+ * finger is off or either channel clips. getSpO2() only reports values
+ * whose quality reaches QUALITY_THRESHOLD.
+ */
+class SpO2Estimator {
+public:
+    static const int BLOCK_SIZE = 32;
+    static constexpr float QUALITY_THRESHOLD = 0.5f;
+
+    // SpO2 = a R^2 + b R + c
+    struct Calibration {
+        float a;
+        float b;
+        float c;
+    };
+
+    struct Stats {
+        uint32_t samples;
+        uint32_t cycles;
+        uint32_t rejectedCycles;
+    };
+
+private:
+    static constexpr float DC_TIME_S = 1.5f;
+    static constexpr float PULSE_LOW_HZ = 0.5f;     // below: respiration and wander
+    static constexpr float PULSE_HIGH_HZ = 4.0f;
+    static constexpr float MIN_CYCLE_S = 0.3f;      // 200 BPM
+    static constexpr float MAX_CYCLE_S = 2.0f;      // 30 BPM
+    static constexpr float HYSTERESIS = 0.25f;      // of the previous half amplitude
+    static constexpr float MIN_DC = 50000.0f;       // IR counts with a finger on the sensor
+    static constexpr float CLIP_LEVEL = 0.98f;      // of full scale
+    static constexpr float PERFUSION_MIN = 0.0005f;
+    static constexpr float PERFUSION_GOOD = 0.002f;
+    static constexpr float RATIO_CV_LIMIT = 0.15f;
+    static constexpr float RHYTHM_LIMIT = 0.3f;     // relative change between cycles
+    static const int RATIO_COUNT = 4;
+
+    float sampleRate;
+    float fullScale;
+    float dcAlpha;
+    Calibration calibration;
+
+    enum PulseChannel {
+        CHANNEL_RED,
+        CHANNEL_IR,
+        PULSE_CHANNELS
+    };
+
+    Utils::FilterBank<PULSE_CHANNELS, 2> pulseFilters;    // high pass, low pass
+    float dcRed;
+    float dcIr;
+    bool primed;
+
+    float ac[BLOCK_SIZE][PULSE_CHANNELS];
+
+    // Current pulse cycle
+    float maxRed, minRed, maxIr, minIr;
+    float previousIr;
+    float threshold;
+    bool armed;
+    bool inCycle;
+    bool clipped;
+    uint32_t cycleSamples;
+    uint32_t previousCycleSamples;
+
+    MovingStats<RATIO_COUNT> ratios;
+
+    float ratio;
+    float perfusion;
+    float quality;
+    float spo2;
+    Stats stats;
+
+    void processChunk(const uint32_t* red, const uint32_t* ir, int count);
+    void restartCycle();
+    bool closeCycle(float redDc, float irDc);
+
+public:
+    explicit SpO2Estimator(float sampleRate = 100.0f, float fullScale = 262143.0f);
+
+    // fullScale: largest raw count (18-bit MAX3010x by default)
+    void configure(float sampleRate, float fullScale = 262143.0f);
+    void reset();
+
+    void setCalibration(const Calibration& curve) { calibration = curve; }
+    const Calibration& getCalibration() const { return calibration; }
+
+    // Returns the number of pulse cycles completed within the batch
+    int processBatch(const uint32_t* red, const uint32_t* ir, int count);
+
+    // %, NAN until a cycle of sufficient quality
+    float getSpO2() const { return quality >= QUALITY_THRESHOLD ? spo2 : NAN; }
+
+    // Last estimate whatever its quality, NAN before the first cycle
+    float getRawSpO2() const { return spo2; }
+
+    float getQuality() const { return quality; }
+    bool isValid() const { return quality >= QUALITY_THRESHOLD && !isnan(spo2); }
+    float getRatio() const { return ratio; }
+    float getPerfusionIndex() const { return perfusion; }
+    const Stats& getStats() const { return stats; }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,191 @@
+#include "SpectralAnalyzer.h"
+#include "utils/CycleCounter.h"
+
+namespace Emopod {
+namespace Sensors {
+
+constexpr float SpectralAnalyzer::BAND_EDGES_HZ[];
+
+SpectralAnalyzer::SpectralAnalyzer() {
+    for (int i = 0; i < FRAME_SIZE; i++) {
+        double hann = 0.5 - 0.5 * cos(2.0 * M_PI * i / FRAME_SIZE);
+        window[i] = (int16_t)lround(hann * 32767.0);
+    }
+    configure(8000.0f);
+}
+
+void SpectralAnalyzer::configure(float rate, int hopSamples) {
+    sampleRate = rate > 0 ? rate : 8000.0f;
+    hop = constrain(hopSamples, 1, FRAME_SIZE);
+    reset();
+}
+
+void SpectralAnalyzer::reset() {
+    for (int i = 0; i < FRAME_SIZE; i++) {
+        history[i] = 0;
+    }
+    historyIndex = 0;
+    filled = 0;
+    sinceFrame = 0;
+    dcLevel = 0;
+    primed = false;
+    pitchIndex = 0;
+    pitchCount = 0;
+    for (int b = 0; b < BAND_COUNT; b++) {
+        features.bandDb[b] = NAN;
+    }
+    features.centroidHz = NAN;
+    features.pitchHz = NAN;
+    features.pitchVariability = NAN;
+    features.voicedRatio = 0;
+    stats = Stats();
+}
+
+int SpectralAnalyzer::processBlock(const uint16_t* samples, int count) {
+    if (count <= 0) {
+        return 0;
+    }
+    if (!primed) {
+        dcLevel = samples[0];
+        primed = true;
+    }
+
+    int frames = 0;
+    for (int i = 0; i < count; i++) {
+        // Slow DC tracker (~3 Hz at 8 kHz); the window removes what is left
+        dcLevel += (samples[i] - dcLevel) * (1.0f / 512.0f);
+        int32_t centred = ((int32_t)samples[i] - (int32_t)dcLevel) << INPUT_SHIFT;
+        history[historyIndex] = (int16_t)constrain(centred, -32768, 32767);
+        historyIndex = (historyIndex + 1) % FRAME_SIZE;
+        if (filled < FRAME_SIZE) {
+            filled++;
+        }
+        if (++sinceFrame >= hop && filled == FRAME_SIZE) {
+            sinceFrame = 0;
+            analyzeFrame();
+            frames++;
+        }
+    }
+    return frames;
+}
+
+void SpectralAnalyzer::analyzeFrame() {
+    uint32_t start = Utils::cycleCount();
+
+    // Oldest sample first, windowed, imaginary part zero
+    for (int i = 0; i < FRAME_SIZE; i++) {
+        int16_t x = history[(historyIndex + i) % FRAME_SIZE];
+        buffer[2 * i] = (int16_t)(((int32_t)x * window[i]) >> 15);
+        buffer[2 * i + 1] = 0;
+    }
+    fft.transform(buffer);
+
+    float binHz = sampleRate / FRAME_SIZE;
+    int pitchLow = (int)ceilf(PITCH_MIN_HZ / binHz);
+    int pitchHigh = (int)floorf(PITCH_MAX_HZ / binHz);
+
+    float bandEnergy[BAND_COUNT] = { 0 };
+    float total = 0;
+    float weighted = 0;
+    float pitchSum = 0;
+    float peakPower = 0;
+    int peakBin = -1;
+    int band = 0;
+
+    // Skip DC; bins 1..N/2-1 carry the one-sided spectrum
+    for (int k = 1; k < FRAME_SIZE / 2; k++) {
+        int32_t re = buffer[2 * k];
+        int32_t im = buffer[2 * k + 1];
+        float power = (float)(re * re + im * im);
+        float frequency = k * binHz;
+
+        while (band < BAND_COUNT - 1 && frequency >= BAND_EDGES_HZ[band]) {
+            band++;
+        }
+        bandEnergy[band] += power;
+        total += power;
+        weighted += power * frequency;
+
+        if (k >= pitchLow && k <= pitchHigh) {
+            pitchSum += power;
+            if (power > peakPower) {
+                peakPower = power;
+                peakBin = k;
+            }
+        }
+    }
+
+    // Relative to a full-scale ADC sine: the 1/N FFT and the Hann window's
+    // 0.5 gain leave amplitude/4 in the peak bin, and its two neighbours
+    // carry half that again
+    const float amplitude = (float)(2048 << INPUT_SHIFT) / 4.0f;
+    const float fullScale = 1.5f * amplitude * amplitude;
+    for (int b = 0; b < BAND_COUNT; b++) {
+        features.bandDb[b] = 10.0f * log10f((bandEnergy[b] + 1.0f) / fullScale);
+    }
+    features.centroidHz = total > 0 ? weighted / total : NAN;
+
+    float pitch = NAN;
+    int pitchBins = pitchHigh - pitchLow + 1;
+    if (peakBin > 0 && pitchBins > 0 && peakPower > VOICING_RATIO * pitchSum / pitchBins &&
+        peakPower > MIN_PITCH_SHARE * total) {
+        // Parabolic interpolation on log power around the peak
+        auto logPower = [&](int k) {
+            int32_t re = buffer[2 * k];
+            int32_t im = buffer[2 * k + 1];
+            return logf((float)(re * re + im * im) + 1.0f);
+        };
+        float left = logPower(peakBin - 1);
+        float centre = logPower(peakBin);
+        float right = logPower(peakBin + 1);
+        float denominator = left - 2 * centre + right;
+        float offset = denominator != 0 ? 0.5f * (left - right) / denominator : 0;
+        pitch = (peakBin + constrain(offset, -0.5f, 0.5f)) * binHz;
+    }
+    features.pitchHz = pitch;
+    updatePitchStats(pitch);
+
+    uint32_t cycles = Utils::cycleCount() - start;
+    stats.frames++;
+    stats.lastFrameCycles = cycles;
+    stats.totalCycles += cycles;
+    if (cycles > stats.maxFrameCycles) {
+        stats.maxFrameCycles = cycles;
+    }
+}
+
+void SpectralAnalyzer::updatePitchStats(float pitch) {
+    pitchHistory[pitchIndex] = pitch;
+    voicedHistory[pitchIndex] = !isnan(pitch);
+    pitchIndex = (pitchIndex + 1) % PITCH_HISTORY;
+    if (pitchCount < PITCH_HISTORY) {
+        pitchCount++;
+    }
+
+    // Fixed 32-entry window: a direct two-pass sum is cheap and exact
+    int voiced = 0;
+    float sum = 0;
+    for (int i = 0; i < pitchCount; i++) {
+        if (voicedHistory[i]) {
+            voiced++;
+            sum += pitchHistory[i];
+        }
+    }
+    features.voicedRatio = (float)voiced / pitchCount;
+    if (voiced < 2) {
+        features.pitchVariability = NAN;
+        return;
+    }
+    float mean = sum / voiced;
+    float squares = 0;
+    for (int i = 0; i < pitchCount; i++) {
+        if (voicedHistory[i]) {
+            float d = pitchHistory[i] - mean;
+            squares += d * d;
+        }
+    }
+    features.pitchVariability = sqrtf(squares / (voiced - 1));
+}
+
+} // namespace Sensors
+} // namespace Emopod
@@ -0,0 +1,104 @@
+#ifndef SPECTRAL_ANALYZER_H
+#define SPECTRAL_ANALYZER_H
+
+#include <Arduino.h>
+#include "utils/FixedFft.h"
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * SpectralAnalyzer - Streaming spectral features of the microphone channel
+ *
+ * Every hop samples, the last FRAME_SIZE samples are Hann-windowed in Q15
+ * and transformed with FixedFft. Each frame yields:
+ *   - energy in four bands (low rumble, voice fundamental, formants, hiss)
+ *   - spectral centroid
+ *   - the strongest peak in the 80-400 Hz pitch range, interpolated
+ *     between bins, taken as the pitch when it stands out from that range
+ *     and carries a minimum share of the frame's power
+ * Pitch of voiced frames feeds a sliding window whose standard deviation
+ * is the pitch-variability cue, alongside the fraction of voiced frames.
+ *
+ * Cycles spent per frame are tracked so the cost can be read on target.
+ */
+class SpectralAnalyzer {
+public:
+    static const int FRAME_SIZE = 256;
+    static const int BAND_COUNT = 4;
+    static const int PITCH_HISTORY = 32;   // voiced frames in the variability window
+
+    struct Features {
+        float bandDb[BAND_COUNT];   // dBFS per band
+        float centroidHz;
+        float pitchHz;              // NAN when the frame is unvoiced
+        float pitchVariability;     // Hz, std dev of recent voiced pitch
+        float voicedRatio;          // 0..1 over the last PITCH_HISTORY frames
+    };
+
+    struct Stats {
+        uint32_t frames;
+        uint32_t lastFrameCycles;
+        uint32_t maxFrameCycles;
+        uint64_t totalCycles;
+    };
+
+private:
+    static constexpr float PITCH_MIN_HZ = 80.0f;
+    static constexpr float PITCH_MAX_HZ = 400.0f;
+    static constexpr float VOICING_RATIO = 4.0f;   // peak power vs the range's mean
+    static constexpr float MIN_PITCH_SHARE = 0.02f; // peak power vs the whole frame
+    static const int INPUT_SHIFT = 3;              // 12-bit counts to Q15 headroom
+
+    // Upper edge of each band, Hz; the last band runs to Nyquist
+    static constexpr float BAND_EDGES_HZ[BAND_COUNT - 1] = { 300.0f, 1000.0f, 2500.0f };
+
+    Utils::FixedFft<FRAME_SIZE> fft;
+    int16_t window[FRAME_SIZE];
+    int16_t history[FRAME_SIZE];   // circular, newest at historyIndex - 1
+    alignas(16) int16_t buffer[2 * FRAME_SIZE];   // the S3 sc16 kernel needs 16-byte alignment
+
+    float sampleRate;
+    int hop;
+    int historyIndex;
+    int filled;
+    int sinceFrame;
+    float dcLevel;
+    bool primed;
+
+    float pitchHistory[PITCH_HISTORY];
+    bool voicedHistory[PITCH_HISTORY];
+    int pitchIndex;
+    int pitchCount;
+
+    Features features;
+    Stats stats;
+
+    void analyzeFrame();
+    void updatePitchStats(float pitch);
+
+public:
+    SpectralAnalyzer();
+
+    // hop: samples between frames (1..FRAME_SIZE)
+    void configure(float sampleRate, int hop = FRAME_SIZE / 2);
+    void reset();
+
+    // Raw 12-bit samples; returns the number of frames analysed
+    int processBlock(const uint16_t* samples, int count);
+
+    const Features& getFeatures() const { return features; }
+    const Stats& getStats() const { return stats; }
+    float getSampleRate() const { return sampleRate; }
+    int getHop() const { return hop; }
+
+    // Static buffers and tables held by one analyzer, bytes
+    static constexpr int memoryBytes() {
+        return sizeof(SpectralAnalyzer);
+    }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef TIME_ALIGNER_H
+#define TIME_ALIGNER_H
+
+#include <Arduino.h>
+
+namespace Emopod {
+namespace Sensors {
+
+/*
+ * TimeAligner - Resample channels with their own update times onto one
+ * timeline
+ *
+ * Each channel keeps its last DEPTH (time, value) samples. valueAt(t)
+ * interpolates linearly between the samples around t (LINEAR) or holds
+ * the latest sample at or before t (HOLD); past the newest sample both
+ * hold, nothing is extrapolated. A channel whose latest sample at or
+ * before t is older than its maxAgeMs is stale and reads NAN, as does a
+ * channel with no sample yet. Asking for t a little in the past (at least
+ * the slowest LINEAR channel's period) gives those channels a sample on
+ * either side.
+ *
+ * The newest slot always holds the latest sample; it is kept once it is
+ * minSpacingMs past the sample before it and until then the next sample
+ * replaces it. However fast a channel updates, its history reaches back
+ * at least (DEPTH - 2) * minSpacingMs.
+ *
+ * Memory is fixed, and a lookup scans at most DEPTH samples, so a whole
+ * output frame costs the same however long the streams have run. Times
+ * are millis() values and wrap safely.
+ */
+template <int CHANNELS, int DEPTH = 4>
+class TimeAligner {
+    static_assert(DEPTH >= 2, "interpolation needs two samples per channel");
+
+public:
+    enum Interpolation {
+        HOLD,
+        LINEAR
+    };
+
+    static const uint32_t NO_SAMPLE = 0xFFFFFFFF;
+
+private:
+    struct Stream {
+        uint32_t times[DEPTH];
+        float values[DEPTH];
+        int newest;
+        int count;
+        Interpolation interpolation;
+        uint32_t maxAgeMs;
+    };
+
+    Stream streams[CHANNELS];
+    uint32_t minSpacingMs;
+
+    // Index of the sample `age` steps back from the newest
+    static int slot(const Stream& stream, int age) {
+        int index = stream.newest - age;
+        return index < 0 ? index + DEPTH : index;
+    }
+
+    // Samples back from the newest to the latest one at or before time; -1 if none
+    static int findAtOrBefore(const Stream& stream, uint32_t time) {
+        for (int age = 0; age < stream.count; age++) {
+            if ((int32_t)(time - stream.times[slot(stream, age)]) >= 0) {
+                return age;
+            }
+        }
+        return -1;
+    }
+
+public:
+    explicit TimeAligner(uint32_t minSpacing = 0) : minSpacingMs(minSpacing) {
+        for (int i = 0; i < CHANNELS; i++) {
+            streams[i].interpolation = HOLD;
+            streams[i].maxAgeMs = NO_SAMPLE;
+        }
+        reset();
+    }
+
+    void configureChannel(int channel, Interpolation interpolation, uint32_t maxAgeMs) {
+        if (channel >= 0 && channel < CHANNELS) {
+            streams[channel].interpolation = interpolation;
+            streams[channel].maxAgeMs = maxAgeMs;
+        }
+    }
+
+    // Samples older than the channel's newest are ignored. NAN is stored:
+    // the value is unknown from then on
+    void addSample(int channel, uint32_t time, float value) {
+        if (channel < 0 || channel >= CHANNELS) {
+            return;
+        }
+        Stream& stream = streams[channel];
+        if (stream.count > 0) {
+            if ((int32_t)(time - stream.times[stream.newest]) < 0) {
+                return;
+            }
+            bool crowded = stream.count > 1 &&
+                           stream.times[stream.newest] - stream.times[slot(stream, 1)] < minSpacingMs;
+            if (crowded || time == stream.times[stream.newest]) {
+                stream.times[stream.newest] = time;
+                stream.values[stream.newest] = value;
+                return;
+            }
+            stream.newest = stream.newest + 1 == DEPTH ? 0 : stream.newest + 1;
+        }
+        stream.times[stream.newest] = time;
+        stream.values[stream.newest] = value;
+        if (stream.count < DEPTH) {
+            stream.count++;
+        }
+    }
+
+    // Value at time, NAN when stale or not yet sampled; sampleAge gets the
+    // ms since the latest sample at or before time, or NO_SAMPLE
+    float valueAt(int channel, uint32_t time, uint32_t& sampleAge) const {
+        const Stream& stream = streams[channel];
+        int age = findAtOrBefore(stream, time);
+        if (age < 0) {
+            sampleAge = NO_SAMPLE;
+            return NAN;
+        }
+        int before = slot(stream, age);
+        sampleAge = time - stream.times[before];
+        if (sampleAge > stream.maxAgeMs) {
+            return NAN;
+        }
+        if (stream.interpolation == HOLD || age == 0) {
+            return stream.values[before];
+        }
+        int after = slot(stream, age - 1);
+        float span = (float)(stream.times[after] - stream.times[before]);
+        float fraction = (float)sampleAge / span;
+        return stream.values[before] + fraction * (stream.values[after] - stream.values[before]);
+    }
+
+    float valueAt(int channel, uint32_t time) const {
+        uint32_t sampleAge;
+        return valueAt(channel, time, sampleAge);
+    }
+
+    // One output frame: every channel at time
+    void resample(uint32_t time, float* values, uint32_t* ages) const {
+        for (int i = 0; i < CHANNELS; i++) {
+            values[i] = valueAt(i, time, ages[i]);
+        }
+    }
+
+    // Drops the samples; channel settings are kept
+    void reset() {
+        for (int i = 0; i < CHANNELS; i++) {
+            streams[i].newest = 0;
+            streams[i].count = 0;
+        }
+    }
+
+    static int getChannelCount() { return CHANNELS; }
+};
+
+} // namespace Sensors
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+#include <math.h>
+
+namespace Emopod {
+namespace Utils {
+
+/*
+ * Second-order IIR section, transposed direct form II
+ *
+ * Coefficients follow the RBJ audio-EQ cookbook and are normalised so
+ * a0 = 1. Sections are cascaded by feeding one's output into the next.
+ */
+class Biquad {
+private:
+    float b0, b1, b2;
+    float a1, a2;
+    float z1, z2;
+
+public:
+    Biquad() : b0(1), b1(0), b2(0), a1(0), a2(0), z1(0), z2(0) {}
+
+    Biquad(float b0, float b1, float b2, float a0, float a1, float a2)
+        : b0(b0 / a0), b1(b1 / a0), b2(b2 / a0), a1(a1 / a0), a2(a2 / a0), z1(0), z2(0) {}
+
+    static Biquad lowPass(float sampleRate, float cutoff, float q = 0.70710678f) {
+        float w0 = 2.0f * (float)M_PI * cutoff / sampleRate;
+        float cosW0 = cosf(w0);
+        float alpha = sinf(w0) / (2.0f * q);
+        return Biquad((1 - cosW0) / 2, 1 - cosW0, (1 - cosW0) / 2,
+                      1 + alpha, -2 * cosW0, 1 - alpha);
+    }
+
+    // Bilinear transform of (n2 s^2 + n1 s + n0) / (d2 s^2 + d1 s + d0)
+    static Biquad bilinear(float sampleRate, double n2, double n1, double n0,
+                           double d2, double d1, double d0) {
+        double k = 2.0 * sampleRate;
+        double k2 = k * k;
+        return Biquad((float)(n2 * k2 + n1 * k + n0), (float)(2 * n0 - 2 * n2 * k2),
+                      (float)(n2 * k2 - n1 * k + n0),
+                      (float)(d2 * k2 + d1 * k + d0), (float)(2 * d0 - 2 * d2 * k2),
+                      (float)(d2 * k2 - d1 * k + d0));
+    }
+
+    static Biquad highPass(float sampleRate, float cutoff, float q = 0.70710678f) {
+        float w0 = 2.0f * (float)M_PI * cutoff / sampleRate;
+        float cosW0 = cosf(w0);
+        float alpha = sinf(w0) / (2.0f * q);
+        return Biquad((1 + cosW0) / 2, -(1 + cosW0), (1 + cosW0) / 2,
+                      1 + alpha, -2 * cosW0, 1 - alpha);
+    }
+
+    float process(float x) {
+        float y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        return y;
+    }
+
+    // In-place friendly; state is held in registers across the block
+    void processBlock(const float* in, float* out, int count) {
+        float s1 = z1;
+        float s2 = z2;
+        for (int i = 0; i < count; i++) {
+            float x = in[i];
+            float y = b0 * x + s1;
+            s1 = b1 * x - a1 * y + s2;
+            s2 = b2 * x - a2 * y;
+            out[i] = y;
+        }
+        z1 = s1;
+        z2 = s2;
+    }
+
+    // |H| at frequency (Hz)
+    float magnitude(float sampleRate, float frequency) const {
+        float w = 2.0f * (float)M_PI * frequency / sampleRate;
+        float c1 = cosf(w), s1 = sinf(w);
+        float c2 = cosf(2 * w), s2 = sinf(2 * w);
+        float numRe = b0 + b1 * c1 + b2 * c2;
+        float numIm = -(b1 * s1 + b2 * s2);
+        float denRe = 1 + a1 * c1 + a2 * c2;
+        float denIm = -(a1 * s1 + a2 * s2);
+        return sqrtf((numRe * numRe + numIm * numIm) / (denRe * denRe + denIm * denIm));
+    }
+
+    // b0, b1, b2, a1, a2 (a0 = 1), e.g. for conversion to fixed point
+    void getCoefficients(float coefficients[5]) const {
+        coefficients[0] = b0;
+        coefficients[1] = b1;
+        coefficients[2] = b2;
+        coefficients[3] = a1;
+        coefficients[4] = a2;
+    }
+
+    // Multiply the section's gain by g
+    void scale(float g) {
+        b0 *= g;
+        b1 *= g;
+        b2 *= g;
+    }
+
+    // Gain at DC, i.e. for a constant input
+    float dcGain() const {
+        return (b0 + b1 + b2) / (1 + a1 + a2);
+    }
+
+    // Set the state as if x had been applied forever, so a DC offset at
+    // start-up does not ring through the filter
+    void prime(float x) {
+        float y = dcGain() * x;
+        z2 = b2 * x - a2 * y;
+        z1 = b1 * x - a1 * y + z2;
+    }
+
+    void reset() {
+        z1 = 0;
+        z2 = 0;
+    }
+};
+
+} // namespace Utils
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace Emopod {
+namespace Utils {
+
+// Free-running CPU cycle count for profiling hot loops. On targets without
+// a readable cycle counter it falls back to nanoseconds.
+inline uint32_t cycleCount() {
+#ifdef ARDUINO
+    return ESP.getCycleCount();
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+} // namespace Utils
+} // namespace Emopod
+
+#endif
@@ -33,7 +33,7 @@ public:
     
     bool addData(const JsonDocument& doc) {
         if (count >= MAX_ENTRIES) {
-            Logger::warn("BUFFER", "Buffer full, discarding oldest entry");
+            LOG_WARN(BUFFER, "Buffer full, discarding oldest entry");
             removeOldest();
         }
         
@@ -41,7 +41,7 @@ public:
         entries[tail].isUsed = true;
         
         if (serializeJson(doc, entries[tail].jsonData, JSON_SIZE) == 0) {
-            Logger::error("BUFFER", "Failed to serialize JSON");
+            LOG_ERROR(BUFFER, "Failed to serialize JSON");
             return false;
         }
         
@@ -57,7 +57,7 @@ public:
         
         DeserializationError error = deserializeJson(doc, entries[head].jsonData);
         if (error) {
-            Logger::error("BUFFER", "Failed to deserialize JSON: %s", error.c_str());
+            LOG_ERROR(BUFFER, "Failed to deserialize JSON: %s", error.c_str());
             removeOldest();
             return false;
         }
@@ -0,0 +1,250 @@
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <tuple>
+#include <type_traits>
+
+namespace Emopod {
+namespace Utils {
+
+/*
+ * Deferred log records
+ *
+ * A record keeps the format string pointer, the module, a timestamp and the
+ * call's arguments in their binary form. Formatting happens later, on the
+ * task that drains the ring, through a formatter instantiated for the call's
+ * exact argument types. Numbers are stored after the usual printf
+ * promotions; strings are copied (arguments are often c_str() of
+ * temporaries) and truncated to the space left in the record.
+ */
+struct LogRecord {
+    static const int PAYLOAD_SIZE = 48;
+
+    typedef int (*FormatFn)(char* out, size_t size, const LogRecord& record);
+
+    const char* format;
+    const char* module;
+    FormatFn formatter;
+    uint32_t timestamp;   // micros()
+    uint8_t level;
+    uint8_t payload[PAYLOAD_SIZE];
+};
+
+namespace LogArgs {
+
+// vsnprintf behind a C variadic, so a format with no arguments is still
+// interpreted (e.g. "%%") without tripping -Wformat-security
+inline int formatv(char* out, size_t size, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(out, size, format, args);
+    va_end(args);
+    return length;
+}
+
+// Types as printf receives them through '...'
+template <typename T, typename Enable = void>
+struct Stored {
+    typedef T type;
+};
+
+template <typename T>
+struct Stored<T, typename std::enable_if<std::is_integral<T>::value && (sizeof(T) < sizeof(int))>::type> {
+    typedef int type;
+};
+
+template <>
+struct Stored<float> {
+    typedef double type;
+};
+
+template <>
+struct Stored<char*> {
+    typedef const char* type;
+};
+
+template <typename T>
+using StoredType = typename Stored<typename std::decay<T>::type>::type;
+
+class Writer {
+private:
+    uint8_t* buffer;
+    size_t size;
+    size_t position;
+    bool overflow;
+
+public:
+    Writer(uint8_t* out, size_t bytes) : buffer(out), size(bytes), position(0), overflow(false) {}
+
+    template <typename T>
+    void write(T value) {
+        static_assert(std::is_arithmetic<T>::value || std::is_pointer<T>::value,
+                      "Deferred log arguments must be numbers, pointers or C strings");
+        if (position + sizeof(T) > size) {
+            overflow = true;
+            return;
+        }
+        memcpy(buffer + position, &value, sizeof(T));
+        position += sizeof(T);
+    }
+
+    void write(const char* text) {
+        if (text == nullptr) {
+            text = "(null)";
+        }
+        if (position >= size) {
+            overflow = true;
+            return;
+        }
+        size_t room = size - position - 1;
+        size_t length = strlen(text);
+        if (length > room) {
+            length = room;
+        }
+        memcpy(buffer + position, text, length);
+        buffer[position + length] = '\0';
+        position += length + 1;
+    }
+
+    bool overflowed() const { return overflow; }
+};
+
+class Reader {
+private:
+    const uint8_t* buffer;
+    size_t position;
+
+public:
+    explicit Reader(const uint8_t* in) : buffer(in), position(0) {}
+
+    template <typename T>
+    T read() {
+        T value;
+        memcpy(&value, buffer + position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+};
+
+template <>
+inline const char* Reader::read<const char*>() {
+    const char* text = reinterpret_cast<const char*>(buffer + position);
+    position += strlen(text) + 1;
+    return text;
+}
+
+// Unpacks the payload with the same types it was packed with
+template <typename... Args>
+int format(char* out, size_t size, const LogRecord& record) {
+    Reader reader(record.payload);
+    // Braced initialisation evaluates the reads left to right
+    std::tuple<StoredType<Args>...> values{ reader.template read<StoredType<Args>>()... };
+    return std::apply([&](auto... unpacked) {
+        return formatv(out, size, record.format, unpacked...);
+    }, values);
+}
+
+// Pre-formatted text in the payload
+inline int formatText(char* out, size_t size, const LogRecord& record) {
+    return formatv(out, size, "%s", reinterpret_cast<const char*>(record.payload));
+}
+
+// Returns false if the arguments did not fit; the payload is then undefined
+template <typename... Args>
+bool pack(LogRecord& record, Args... args) {
+    Writer writer(record.payload, LogRecord::PAYLOAD_SIZE);
+    (writer.write(static_cast<StoredType<Args>>(args)), ...);
+    record.formatter = &format<Args...>;
+    return !writer.overflowed();
+}
+
+} // namespace LogArgs
+
+/*
+ * Bounded multi-producer/single-consumer ring of LogRecords
+ *
+ * Any task or ISR may publish; producers claim a slot with one CAS on the
+ * enqueue index and publish it through the slot's sequence number, so no
+ * producer ever blocks another. A full ring drops the new record and counts
+ * it. Only the drain task consumes.
+ */
+template <int N>
+class LogRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "LogRing capacity must be a power of two");
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        LogRecord record;
+    };
+
+    static const uint32_t MASK = N - 1;
+
+    Slot slots[N];
+    alignas(64) std::atomic<uint32_t> enqueueIndex;
+    alignas(64) uint32_t dequeueIndex;   // consumer only
+    std::atomic<uint32_t> dropped;
+
+public:
+    LogRing() : enqueueIndex(0), dequeueIndex(0), dropped(0) {
+        for (int i = 0; i < N; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Claim a slot; returns nullptr (and counts a drop) when the ring is full.
+    // The caller fills the record and must then call publish() with the slot.
+    LogRecord* claim(uint32_t& ticket) {
+        uint32_t position = enqueueIndex.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[position & MASK];
+            int32_t diff = (int32_t)(slot.sequence.load(std::memory_order_acquire) - position);
+            if (diff == 0) {
+                if (enqueueIndex.compare_exchange_weak(position, position + 1,
+                                                       std::memory_order_relaxed)) {
+                    ticket = position;
+                    return &slot.record;
+                }
+            } else if (diff < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            } else {
+                position = enqueueIndex.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publish(uint32_t ticket) {
+        slots[ticket & MASK].sequence.store(ticket + 1, std::memory_order_release);
+    }
+
+    // Consumer side
+    bool pop(LogRecord& record) {
+        Slot& slot = slots[dequeueIndex & MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeueIndex + 1) {
+            return false;
+        }
+        record = slot.record;
+        slot.sequence.store(dequeueIndex + N, std::memory_order_release);
+        dequeueIndex++;
+        return true;
+    }
+
+    uint32_t getDropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    static constexpr int capacity() {
+        return N;
+    }
+};
+
+} // namespace Utils
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef FILTER_BANK_H
+#define FILTER_BANK_H
+
+#include "utils/Biquad.h"
+
+namespace Emopod {
+namespace Utils {
+
+/*
+ * FilterBank - Biquad cascades for several channels, struct of arrays
+ *
+ * Channels sampled on the same clock register their sections here and one
+ * call per tick filters all of them. Coefficients and state are stored
+ * stage by stage as arrays across channels, so the inner loop runs over
+ * channels with no dependency between iterations and compilers vectorize
+ * it wherever there is float SIMD. The ESP32-S3's vector unit only has
+ * integer lanes, so on the S3 the loop is unrolled four channels wide
+ * instead, keeping independent multiply-adds in the FPU pipeline.
+ *
+ * Unused channels and stages pass samples through unchanged, so every
+ * tick runs the same branch-free loop over all CHANNELS.
+ */
+template <int CHANNELS, int STAGES = 1>
+class FilterBank {
+    static_assert(CHANNELS > 0 && STAGES > 0, "a filter bank needs channels and stages");
+
+private:
+    alignas(16) float b0[STAGES][CHANNELS];
+    alignas(16) float b1[STAGES][CHANNELS];
+    alignas(16) float b2[STAGES][CHANNELS];
+    alignas(16) float a1[STAGES][CHANNELS];
+    alignas(16) float a2[STAGES][CHANNELS];
+    alignas(16) float z1[STAGES][CHANNELS];
+    alignas(16) float z2[STAGES][CHANNELS];
+    int channelCount;
+
+    void processStage(int stage, float* __restrict frame) {
+        const float* __restrict c0 = b0[stage];
+        const float* __restrict c1 = b1[stage];
+        const float* __restrict c2 = b2[stage];
+        const float* __restrict d1 = a1[stage];
+        const float* __restrict d2 = a2[stage];
+        float* __restrict s1 = z1[stage];
+        float* __restrict s2 = z2[stage];
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+#pragma GCC unroll 4
+#endif
+        for (int c = 0; c < CHANNELS; c++) {
+            float x = frame[c];
+            float y = c0[c] * x + s1[c];
+            s1[c] = c1[c] * x - d1[c] * y + s2[c];
+            s2[c] = c2[c] * x - d2[c] * y;
+            frame[c] = y;
+        }
+    }
+
+public:
+    FilterBank() : channelCount(0) {
+        for (int c = 0; c < CHANNELS; c++) {
+            setChannel(c, nullptr, 0);
+        }
+    }
+
+    // Register a channel filtered by `count` cascaded sections; returns its
+    // index in every frame, or -1 when the bank is full
+    int addChannel(const Biquad* sections, int count) {
+        if (channelCount == CHANNELS || count > STAGES) {
+            return -1;
+        }
+        setChannel(channelCount, sections, count);
+        return channelCount++;
+    }
+
+    // Replace a channel's sections (e.g. after a rate change); clears its state
+    void setChannel(int channel, const Biquad* sections, int count) {
+        for (int s = 0; s < STAGES; s++) {
+            float c[5] = { 1, 0, 0, 0, 0 };
+            if (s < count) {
+                sections[s].getCoefficients(c);
+            }
+            b0[s][channel] = c[0];
+            b1[s][channel] = c[1];
+            b2[s][channel] = c[2];
+            a1[s][channel] = c[3];
+            a2[s][channel] = c[4];
+            z1[s][channel] = 0;
+            z2[s][channel] = 0;
+        }
+    }
+
+    // One tick: frame[CHANNELS] is filtered in place
+    void process(float* frame) {
+        for (int s = 0; s < STAGES; s++) {
+            processStage(s, frame);
+        }
+    }
+
+    // count ticks of interleaved frames, CHANNELS floats each
+    void processFrames(float* frames, int count) {
+        for (int i = 0; i < count; i++) {
+            process(frames + i * CHANNELS);
+        }
+    }
+
+    // Set a channel's state as if x had been applied forever
+    void prime(int channel, float x) {
+        for (int s = 0; s < STAGES; s++) {
+            float gain = (b0[s][channel] + b1[s][channel] + b2[s][channel]) /
+                         (1 + a1[s][channel] + a2[s][channel]);
+            float y = gain * x;
+            z2[s][channel] = b2[s][channel] * x - a2[s][channel] * y;
+            z1[s][channel] = b1[s][channel] * x - a1[s][channel] * y + z2[s][channel];
+            x = y;
+        }
+    }
+
+    void reset() {
+        for (int s = 0; s < STAGES; s++) {
+            for (int c = 0; c < CHANNELS; c++) {
+                z1[s][c] = 0;
+                z2[s][c] = 0;
+            }
+        }
+    }
+
+    int getChannelCount() const { return channelCount; }
+};
+
+} // namespace Utils
+} // namespace Emopod
+
+#endif
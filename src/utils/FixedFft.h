@@ -0,0 +1,115 @@
+#ifndef FIXED_FFT_H
+#define FIXED_FFT_H
+
+#include <stdint.h>
+#include <math.h>
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && __has_include(<esp_dsp.h>)
+#include <esp_dsp.h>
+#define EMOPOD_FFT_ESP_DSP 1
+#endif
+
+namespace Emopod {
+namespace Utils {
+
+/*
+ * FixedFft - In-place radix-2 complex FFT on interleaved Q15 data
+ *
+ * data[2k] is the real and data[2k+1] the imaginary part of point k. Every
+ * stage halves its outputs, so the result is the DFT scaled by 1/N and can
+ * never overflow. On the ESP32-S3 with esp-dsp available the transform is
+ * the library's SIMD sc16 kernel (same layout and scaling), which needs
+ * data aligned to 16 bytes; elsewhere the portable loop below is used.
+ */
+template <int N>
+class FixedFft {
+    static_assert(N >= 4 && (N & (N - 1)) == 0, "FFT size must be a power of two");
+
+private:
+    // cos/sin of 2*pi*k/N for k < N/2, Q15
+    int16_t cosTable[N / 2];
+    int16_t sinTable[N / 2];
+
+    static int16_t toQ15(double v) {
+        long q = lround(v * 32767.0);
+        return (int16_t)(q > 32767 ? 32767 : (q < -32768 ? -32768 : q));
+    }
+
+    static void bitReverse(int16_t* data) {
+        for (int i = 1, j = 0; i < N; i++) {
+            int bit = N >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j) {
+                int16_t re = data[2 * i];
+                int16_t im = data[2 * i + 1];
+                data[2 * i] = data[2 * j];
+                data[2 * i + 1] = data[2 * j + 1];
+                data[2 * j] = re;
+                data[2 * j + 1] = im;
+            }
+        }
+    }
+
+    void transformPortable(int16_t* data) const {
+        bitReverse(data);
+        for (int size = 2; size <= N; size <<= 1) {
+            int half = size >> 1;
+            int step = N / size;
+            for (int start = 0; start < N; start += size) {
+                for (int j = 0; j < half; j++) {
+                    int32_t wr = cosTable[j * step];
+                    int32_t wi = -sinTable[j * step];
+                    int k = 2 * (start + j);
+                    int l = k + 2 * half;
+                    int32_t tr = (wr * data[l] - wi * data[l + 1]) >> 15;
+                    int32_t ti = (wr * data[l + 1] + wi * data[l]) >> 15;
+                    int32_t ur = data[k];
+                    int32_t ui = data[k + 1];
+                    data[k] = (int16_t)((ur + tr) >> 1);
+                    data[k + 1] = (int16_t)((ui + ti) >> 1);
+                    data[l] = (int16_t)((ur - tr) >> 1);
+                    data[l + 1] = (int16_t)((ui - ti) >> 1);
+                }
+            }
+        }
+    }
+
+public:
+    FixedFft() {
+        for (int k = 0; k < N / 2; k++) {
+            double angle = 2.0 * M_PI * k / N;
+            cosTable[k] = toQ15(cos(angle));
+            sinTable[k] = toQ15(sin(angle));
+        }
+#ifdef EMOPOD_FFT_ESP_DSP
+        dsps_fft2r_init_sc16(NULL, N);
+#endif
+    }
+
+    // data holds N interleaved complex Q15 points, 16-byte aligned
+    void transform(int16_t* data) const {
+#ifdef EMOPOD_FFT_ESP_DSP
+        dsps_fft2r_sc16(data, N);
+        dsps_bit_rev_sc16_ansi(data, N);
+#else
+        transformPortable(data);
+#endif
+    }
+
+    static constexpr int size() {
+        return N;
+    }
+
+    // Twiddle tables only; the data buffer belongs to the caller
+    static constexpr int tableBytes() {
+        return N * sizeof(int16_t);
+    }
+};
+
+} // namespace Utils
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include "utils/Biquad.h"
+
+// Targets without an FPU run the per-sample signal paths in fixed point;
+// define EMOPOD_FIXED_POINT to force it elsewhere (host tests)
+#if !defined(EMOPOD_FIXED_POINT) && \
+    (defined(CONFIG_IDF_TARGET_ESP32C2) || defined(CONFIG_IDF_TARGET_ESP32C3) || \
+     defined(CONFIG_IDF_TARGET_ESP32C6) || defined(CONFIG_IDF_TARGET_ESP32H2))
+#define EMOPOD_FIXED_POINT 1
+#endif
+
+namespace Emopod {
+namespace Utils {
+
+/*
+ * Fixed - Signed fixed-point number with FRAC fraction bits
+ *
+ * Storage holds the raw value and Wide the intermediate products. All
+ * arithmetic saturates at the range limits instead of wrapping, and
+ * multiplication rounds to nearest. Q15 and Q31 cover [-1, 1).
+ */
+template <int FRAC, typename Storage, typename Wide>
+class Fixed {
+    static_assert(FRAC > 0 && FRAC < 8 * (int)sizeof(Storage), "fraction bits must fit the storage");
+    static_assert(sizeof(Wide) >= 2 * sizeof(Storage), "products need a double-width type");
+
+private:
+    Storage raw;
+
+    static constexpr Wide MAX_RAW = ((Wide)1 << (8 * sizeof(Storage) - 1)) - 1;
+    static constexpr Wide MIN_RAW = -MAX_RAW - 1;
+    static constexpr float SCALE = (float)((Wide)1 << FRAC);
+
+public:
+    static constexpr int FRACTION_BITS = FRAC;
+
+    constexpr Fixed() : raw(0) {}
+
+    static constexpr Storage saturate(Wide value) {
+        return (Storage)(value > MAX_RAW ? MAX_RAW : (value < MIN_RAW ? MIN_RAW : value));
+    }
+
+    static constexpr Fixed fromRaw(Storage value) {
+        Fixed result;
+        result.raw = value;
+        return result;
+    }
+
+    static constexpr Fixed fromFloat(float value) {
+        return fromRaw(value * SCALE >= (float)MAX_RAW ? (Storage)MAX_RAW
+                       : value * SCALE <= (float)MIN_RAW ? (Storage)MIN_RAW
+                       : (Storage)(value * SCALE + (value >= 0 ? 0.5f : -0.5f)));
+    }
+
+    static constexpr Fixed max() { return fromRaw((Storage)MAX_RAW); }
+    static constexpr Fixed min() { return fromRaw((Storage)MIN_RAW); }
+
+    constexpr Storage getRaw() const { return raw; }
+    constexpr float toFloat() const { return raw / SCALE; }
+
+    Fixed operator+(Fixed other) const { return fromRaw(saturate((Wide)raw + other.raw)); }
+    Fixed operator-(Fixed other) const { return fromRaw(saturate((Wide)raw - other.raw)); }
+    Fixed operator-() const { return fromRaw(saturate(-(Wide)raw)); }
+
+    Fixed operator*(Fixed other) const {
+        Wide product = (Wide)raw * other.raw + ((Wide)1 << (FRAC - 1));
+        return fromRaw(saturate(product >> FRAC));
+    }
+
+    Fixed& operator+=(Fixed other) { return *this = *this + other; }
+    Fixed& operator-=(Fixed other) { return *this = *this - other; }
+    Fixed& operator*=(Fixed other) { return *this = *this * other; }
+
+    bool operator==(Fixed other) const { return raw == other.raw; }
+    bool operator!=(Fixed other) const { return raw != other.raw; }
+    bool operator<(Fixed other) const { return raw < other.raw; }
+    bool operator>(Fixed other) const { return raw > other.raw; }
+    bool operator<=(Fixed other) const { return raw <= other.raw; }
+    bool operator>=(Fixed other) const { return raw >= other.raw; }
+};
+
+typedef Fixed<15, int16_t, int32_t> Q15;
+typedef Fixed<31, int32_t, int64_t> Q31;
+
+/*
+ * FixedScale - Multiply integers by a constant ratio
+ *
+ * x * ratio is computed as (x * multiplier) >> shift with a 32-bit
+ * multiplier normalised for the most precision (relative error below
+ * 2^-30), rounded and saturated to int32.
+ */
+class FixedScale {
+private:
+    int32_t multiplier;
+    int shift;
+
+public:
+    FixedScale() : multiplier(0), shift(0) {}
+
+    static FixedScale fromRatio(double ratio) {
+        FixedScale scale;
+        if (ratio == 0) {
+            return scale;
+        }
+        int exponent;
+        double mantissa = frexp(ratio, &exponent);    // ratio = mantissa * 2^exponent
+        scale.shift = 31 - exponent;
+        if (scale.shift > 62) {
+            return FixedScale();                       // rounds to 0 for any int32
+        }
+        if (scale.shift < 0) {
+            scale.shift = 0;
+            scale.multiplier = ratio > 0 ? INT32_MAX : INT32_MIN;
+            return scale;
+        }
+        int64_t m = llround(mantissa * 2147483648.0);
+        scale.multiplier = (int32_t)(m > INT32_MAX ? INT32_MAX : (m < INT32_MIN ? INT32_MIN : m));
+        return scale;
+    }
+
+    int32_t apply(int32_t x) const {
+        int64_t product = (int64_t)x * multiplier;
+        if (shift > 0) {
+            product = (product + ((int64_t)1 << (shift - 1))) >> shift;
+        }
+        return Q31::saturate(product);
+    }
+
+    double getRatio() const { return ldexp((double)multiplier, -shift); }
+};
+
+/*
+ * FixedBiquad - Second-order IIR section on Q31 samples, direct form I
+ *
+ * Built from a float Biquad design. Coefficients are Q2.29 (|c| < 4), the
+ * five products are summed in 64 bits, and the bits dropped when the sum
+ * is shifted back to Q31 are carried into the next sample (first-order
+ * error feedback), which keeps low-frequency poles accurate. The output
+ * saturates instead of wrapping.
+ */
+class FixedBiquad {
+private:
+    static const int COEFFICIENT_BITS = 29;
+
+    int32_t b0, b1, b2;
+    int32_t a1, a2;
+    int32_t x1, x2;
+    int32_t y1, y2;
+    int64_t residual;
+    float dcGain;
+
+    static int32_t toCoefficient(float c) {
+        return Q31::saturate(llroundf(c * (float)(1 << COEFFICIENT_BITS)));
+    }
+
+public:
+    FixedBiquad() : b0(1 << COEFFICIENT_BITS), b1(0), b2(0), a1(0), a2(0), dcGain(1) { reset(); }
+
+    explicit FixedBiquad(const Biquad& design) {
+        float c[5];
+        design.getCoefficients(c);
+        b0 = toCoefficient(c[0]);
+        b1 = toCoefficient(c[1]);
+        b2 = toCoefficient(c[2]);
+        a1 = toCoefficient(c[3]);
+        a2 = toCoefficient(c[4]);
+        dcGain = design.dcGain();
+        reset();
+    }
+
+    int32_t process(int32_t x) {
+        int64_t acc = residual;
+        acc += (int64_t)b0 * x + (int64_t)b1 * x1 + (int64_t)b2 * x2;
+        acc -= (int64_t)a1 * y1 + (int64_t)a2 * y2;
+        int64_t y = acc >> COEFFICIENT_BITS;
+        residual = acc - (y << COEFFICIENT_BITS);
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = Q31::saturate(y);
+        return y1;
+    }
+
+    // In-place friendly
+    void processBlock(const int32_t* in, int32_t* out, int count) {
+        for (int i = 0; i < count; i++) {
+            out[i] = process(in[i]);
+        }
+    }
+
+    // Set the state as if x had been applied forever
+    void prime(int32_t x) {
+        x1 = x2 = x;
+        y1 = y2 = Q31::saturate(llroundf(dcGain * x));
+        residual = 0;
+    }
+
+    void reset() {
+        x1 = x2 = 0;
+        y1 = y2 = 0;
+        residual = 0;
+    }
+};
+
+/*
+ * FixedMovingAverage - Mean of the last N values of a Fixed type
+ *
+ * The sum is kept in 64 bits, so it is exact and never drifts.
+ */
+template <size_t N, typename Q>
+class FixedMovingAverage {
+private:
+    Q values[N];
+    size_t index;
+    size_t count;
+    int64_t sum;
+
+public:
+    FixedMovingAverage() { reset(); }
+
+    Q addValue(Q value) {
+        if (count == N) {
+            sum -= values[index].getRaw();
+        } else {
+            count++;
+        }
+        values[index] = value;
+        sum += value.getRaw();
+        index = (index + 1) % N;
+        return getAverage();
+    }
+
+    // Rounded to nearest; 0 before the first value
+    Q getAverage() const {
+        if (count == 0) {
+            return Q();
+        }
+        int64_t half = count / 2;
+        int64_t rounded = sum >= 0 ? (sum + half) / (int64_t)count : (sum - half) / (int64_t)count;
+        return Q::fromRaw(Q::saturate(rounded));
+    }
+
+    size_t getCount() const { return count; }
+    bool isBufferFull() const { return count == N; }
+
+    void reset() {
+        index = 0;
+        count = 0;
+        sum = 0;
+    }
+};
+
+// Sample type and filter section for per-sample signal paths on this target
+#if EMOPOD_FIXED_POINT
+typedef int32_t Sample;            // Q31
+typedef FixedBiquad SampleBiquad;
+#else
+typedef float Sample;
+typedef Biquad SampleBiquad;
+#endif
+
+} // namespace Utils
+} // namespace Emopod
+
+#endif
@@ -1,80 +1,327 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#ifdef ARDUINO
 #include <Arduino.h>
+#else
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#endif
+#include <atomic>
+#include "utils/DeferredLog.h"
+
+// Severity levels, lowest first
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+// Compile-time floor: sites below a module's level are compiled out, along
+// with their format strings and argument expressions. Override per module
+// with a build flag, e.g. -DLOG_LEVEL_NETWORK=LOG_LEVEL_DEBUG.
+#ifndef LOG_LEVEL_DEFAULT
+#ifdef DEBUG
+#define LOG_LEVEL_DEFAULT LOG_LEVEL_DEBUG
+#else
+#define LOG_LEVEL_DEFAULT LOG_LEVEL_INFO
+#endif
+#endif
+
+// Runtime threshold every module starts at; setModuleLevel() can move a
+// module anywhere down to its compile-time floor
+#ifndef LOG_RUNTIME_LEVEL_DEFAULT
+#define LOG_RUNTIME_LEVEL_DEFAULT LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef LOG_LEVEL_NETWORK
+#define LOG_LEVEL_NETWORK LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_BUFFER
+#define LOG_LEVEL_BUFFER LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_SCHED
+#define LOG_LEVEL_SCHED LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_ADC
+#define LOG_LEVEL_ADC LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_SENSOR
+#define LOG_LEVEL_SENSOR LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_DATA
+#define LOG_LEVEL_DATA LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_EMOTION
+#define LOG_LEVEL_EMOTION LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_PIPELINE
+#define LOG_LEVEL_PIPELINE LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_CALIBRATION
+#define LOG_LEVEL_CALIBRATION LOG_LEVEL_DEFAULT
+#endif
 
 namespace Emopod {
 namespace Utils {
 
+enum LogModuleId {
+    LOG_MODULE_NETWORK,
+    LOG_MODULE_BUFFER,
+    LOG_MODULE_SCHED,
+    LOG_MODULE_ADC,
+    LOG_MODULE_SENSOR,
+    LOG_MODULE_DATA,
+    LOG_MODULE_EMOTION,
+    LOG_MODULE_PIPELINE,
+    LOG_MODULE_CALIBRATION,
+    LOG_MODULE_COUNT
+};
+
+struct LogModule {
+    LogModuleId id;
+    const char* name;
+    int compiledLevel;
+};
+
+// Modules usable with the LOG_* macros
+namespace LogModules {
+    constexpr LogModule NETWORK = { LOG_MODULE_NETWORK, "NETWORK", LOG_LEVEL_NETWORK };
+    constexpr LogModule BUFFER = { LOG_MODULE_BUFFER, "BUFFER", LOG_LEVEL_BUFFER };
+    constexpr LogModule SCHED = { LOG_MODULE_SCHED, "SCHED", LOG_LEVEL_SCHED };
+    constexpr LogModule ADC = { LOG_MODULE_ADC, "ADC", LOG_LEVEL_ADC };
+    constexpr LogModule SENSOR = { LOG_MODULE_SENSOR, "SENSOR", LOG_LEVEL_SENSOR };
+    constexpr LogModule DATA = { LOG_MODULE_DATA, "DATA", LOG_LEVEL_DATA };
+    constexpr LogModule EMOTION = { LOG_MODULE_EMOTION, "EMOTION", LOG_LEVEL_EMOTION };
+    constexpr LogModule PIPELINE = { LOG_MODULE_PIPELINE, "PIPELINE", LOG_LEVEL_PIPELINE };
+    constexpr LogModule CALIBRATION = { LOG_MODULE_CALIBRATION, "CALIBRATION", LOG_LEVEL_CALIBRATION };
+
+    constexpr const LogModule* ALL[LOG_MODULE_COUNT] = {
+        &NETWORK, &BUFFER, &SCHED, &ADC, &SENSOR, &DATA, &EMOTION, &PIPELINE, &CALIBRATION
+    };
+}
+
+/*
+ * Logger - Module-tagged serial logging
+ *
+ * IMMEDIATE mode formats and prints on the calling task. DEFERRED mode only
+ * copies the format pointer, a timestamp and the binary arguments into a
+ * lock-free ring; drain() formats and prints them later from an idle task.
+ * Calls that cannot be deferred in binary form (arguments larger than a
+ * record) are formatted on the spot and truncated to the record payload.
+ *
+ * Code logs through the LOG_DEBUG/INFO/WARN/ERROR macros, which filter
+ * first against the module's compile-time floor (if constexpr, so a
+ * disabled site leaves nothing behind) and then against the module's
+ * runtime threshold. The info()/warn()/error() functions are unfiltered.
+ *
+ * Output goes to Serial on the device and to stdout on a host build.
+ */
 class Logger {
+public:
+    enum Mode {
+        IMMEDIATE,
+        DEFERRED
+    };
+
+    static const int RING_SIZE = 64;
+
 private:
+    static const int LINE_SIZE = 256;
+
+    struct State {
+        LogRing<RING_SIZE> ring;
+        std::atomic<int> mode;
+        std::atomic<uint32_t> truncated;
+        uint32_t reportedDrops;   // drain task only
+        std::atomic<int> moduleLevels[LOG_MODULE_COUNT];
+
+        State() : mode(IMMEDIATE), truncated(0), reportedDrops(0) {
+            for (int i = 0; i < LOG_MODULE_COUNT; i++) {
+                moduleLevels[i].store(LOG_RUNTIME_LEVEL_DEFAULT, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    static State& state() {
+        static State instance;
+        return instance;
+    }
+
     static const char* getLevelString(int level) {
         switch (level) {
-            case 0: return "[DEBUG]";
-            case 1: return "[INFO]";
-            case 2: return "[WARN]";
-            case 3: return "[ERROR]";
+            case LOG_LEVEL_DEBUG: return "[DEBUG]";
+            case LOG_LEVEL_INFO: return "[INFO]";
+            case LOG_LEVEL_WARN: return "[WARN]";
+            case LOG_LEVEL_ERROR: return "[ERROR]";
             default: return "[UNKNOWN]";
         }
     }
 
+    template <typename... Args>
+    static void print(const char* format, Args... args) {
+#ifdef ARDUINO
+        Serial.printf(format, args...);
+#else
+        printf(format, args...);
+#endif
+    }
+
+    static uint32_t timestampMicros() {
+#ifdef ARDUINO
+        return micros();
+#else
+        using namespace std::chrono;
+        return (uint32_t)duration_cast<microseconds>(
+            steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
 public:
-    static void log(int level, const char* module, const char* format, ...) {
+    // Backend of the LOG_* macros and the level functions; no filtering
+    template <typename... Args>
+    static void write(int level, const char* module, const char* format, Args... args) {
+        State& s = state();
+        if (s.mode.load(std::memory_order_relaxed) == IMMEDIATE) {
+            char buffer[LINE_SIZE];
+            LogArgs::formatv(buffer, sizeof(buffer), format, args...);
+            print("%s %s %s\n", getLevelString(level), module, buffer);
+            return;
+        }
+
+        uint32_t ticket;
+        LogRecord* record = s.ring.claim(ticket);
+        if (record == nullptr) {
+            return;
+        }
+        record->format = format;
+        record->module = module;
+        record->timestamp = timestampMicros();
+        record->level = (uint8_t)level;
+        if (!LogArgs::pack(*record, args...)) {
+            LogArgs::formatv(reinterpret_cast<char*>(record->payload), LogRecord::PAYLOAD_SIZE,
+                             format, args...);
+            record->formatter = &LogArgs::formatText;
+            s.truncated.fetch_add(1, std::memory_order_relaxed);
+        }
+        s.ring.publish(ticket);
+    }
+
+    // Runtime check used by the LOG_* macros after the compile-time one
+    static bool isEnabled(const LogModule& module, int level) {
+        return level >= state().moduleLevels[module.id].load(std::memory_order_relaxed);
+    }
+
+    // Change a module's runtime threshold without reflashing. Levels below
+    // the module's compile-time floor have no effect: those sites are gone.
+    static void setModuleLevel(const LogModule& module, int level) {
+        state().moduleLevels[module.id].store(level, std::memory_order_relaxed);
+    }
+
+    // By name, for serial or network commands; returns false if unknown
+    static bool setModuleLevel(const char* name, int level) {
+        for (int i = 0; i < LOG_MODULE_COUNT; i++) {
+            if (strcmp(LogModules::ALL[i]->name, name) == 0) {
+                setModuleLevel(*LogModules::ALL[i], level);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static int getModuleLevel(const LogModule& module) {
+        return state().moduleLevels[module.id].load(std::memory_order_relaxed);
+    }
+
+    static void setMode(Mode mode) {
+        state().mode.store(mode, std::memory_order_relaxed);
+    }
+
+    static Mode getMode() {
+        return (Mode)state().mode.load(std::memory_order_relaxed);
+    }
+
+    // Format and print up to maxRecords deferred messages; returns the number
+    // printed. Must only be called from one task.
+    static int drain(int maxRecords = RING_SIZE) {
+        State& s = state();
+        LogRecord record;
+        char buffer[LINE_SIZE];
+        int count = 0;
+        while (count < maxRecords && s.ring.pop(record)) {
+            record.formatter(buffer, sizeof(buffer), record);
+            print("%s %s %s (t=%lu ms)\n", getLevelString(record.level), record.module,
+                  buffer, (unsigned long)(record.timestamp / 1000));
+            count++;
+        }
+
+        uint32_t drops = s.ring.getDropped();
+        if (drops != s.reportedDrops) {
+            print("%s LOG %u messages dropped (ring full)\n", getLevelString(LOG_LEVEL_WARN),
+                  (unsigned)(drops - s.reportedDrops));
+            s.reportedDrops = drops;
+        }
+        return count;
+    }
+
+    // Deferred messages lost because the ring was full
+    static uint32_t getDroppedCount() {
+        return state().ring.getDropped();
+    }
+
+    // Deferred messages formatted at the call site because they did not fit
+    static uint32_t getTruncatedCount() {
+        return state().truncated.load(std::memory_order_relaxed);
+    }
+
+    template <typename... Args>
+    static void log(int level, const char* module, const char* format, Args... args) {
         #ifdef DEBUG
-        char buffer[256];
-        va_list args;
-        va_start(args, format);
-        vsnprintf(buffer, sizeof(buffer), format, args);
-        va_end(args);
-        
-        Serial.printf("%s %s %s\n", getLevelString(level), module, buffer);
+        write(level, module, format, args...);
         #endif
     }
-    
-    static void debug(const char* module, const char* format, ...) {
+
+    template <typename... Args>
+    static void debug(const char* module, const char* format, Args... args) {
         #ifdef DEBUG
-        char buffer[256];
-        va_list args;
-        va_start(args, format);
-        vsnprintf(buffer, sizeof(buffer), format, args);
-        va_end(args);
-        
-        Serial.printf("%s %s %s\n", getLevelString(0), module, buffer);
+        write(LOG_LEVEL_DEBUG, module, format, args...);
         #endif
     }
-    
-    static void info(const char* module, const char* format, ...) {
-        char buffer[256];
-        va_list args;
-        va_start(args, format);
-        vsnprintf(buffer, sizeof(buffer), format, args);
-        va_end(args);
-        
-        Serial.printf("%s %s %s\n", getLevelString(1), module, buffer);
-    }
-    
-    static void warn(const char* module, const char* format, ...) {
-        char buffer[256];
-        va_list args;
-        va_start(args, format);
-        vsnprintf(buffer, sizeof(buffer), format, args);
-        va_end(args);
-        
-        Serial.printf("%s %s %s\n", getLevelString(2), module, buffer);
-    }
-    
-    static void error(const char* module, const char* format, ...) {
-        char buffer[256];
-        va_list args;
-        va_start(args, format);
-        vsnprintf(buffer, sizeof(buffer), format, args);
-        va_end(args);
-        
-        Serial.printf("%s %s %s\n", getLevelString(3), module, buffer);
+
+    template <typename... Args>
+    static void info(const char* module, const char* format, Args... args) {
+        write(LOG_LEVEL_INFO, module, format, args...);
+    }
+
+    template <typename... Args>
+    static void warn(const char* module, const char* format, Args... args) {
+        write(LOG_LEVEL_WARN, module, format, args...);
+    }
+
+    template <typename... Args>
+    static void error(const char* module, const char* format, Args... args) {
+        write(LOG_LEVEL_ERROR, module, format, args...);
     }
 };
 
 } // namespace Utils
 } // namespace Emopod
 
-#endif 
\ No newline at end of file
+// module is a name from Emopod::Utils::LogModules, e.g. LOG_INFO(NETWORK, "...")
+#define EMOPOD_LOG(level, module, ...)                                                   \
+    do {                                                                                 \
+        if constexpr ((level) >= Emopod::Utils::LogModules::module.compiledLevel) {      \
+            if (Emopod::Utils::Logger::isEnabled(Emopod::Utils::LogModules::module, (level))) { \
+                Emopod::Utils::Logger::write((level), Emopod::Utils::LogModules::module.name, \
+                                             __VA_ARGS__);                               \
+            }                                                                            \
+        }                                                                                \
+    } while (0)
+
+#define LOG_DEBUG(module, ...) EMOPOD_LOG(LOG_LEVEL_DEBUG, module, __VA_ARGS__)
+#define LOG_INFO(module, ...) EMOPOD_LOG(LOG_LEVEL_INFO, module, __VA_ARGS__)
+#define LOG_WARN(module, ...) EMOPOD_LOG(LOG_LEVEL_WARN, module, __VA_ARGS__)
+#define LOG_ERROR(module, ...) EMOPOD_LOG(LOG_LEVEL_ERROR, module, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef OUTLIER_FILTER_H
+#define OUTLIER_FILTER_H
+
+#include <math.h>
+#include <stdint.h>
+#include "utils/Statistics.h"
+
+namespace Emopod {
+namespace Utils {
+
+struct OutlierLimits {
+    float threshold;      // Hampel: scaled MADs from the median; 0 disables
+    float minDeviation;   // floor on the Hampel distance, signal units
+    float maxRate;        // units/s from the last accepted value; 0 disables
+};
+
+/*
+ * OutlierFilter - Streaming artifact rejection for one channel
+ *
+ * Two tests, both against recent history:
+ *   Hampel      |x - median| over threshold * 1.4826 * MAD of the last N
+ *               values (never less than minDeviation) is an outlier. The
+ *               window holds every value, rejected or not, so a genuine
+ *               level shift is accepted once it fills half the window
+ *   rate        a change from the last accepted value faster than maxRate
+ *               is rejected; the allowance grows with the time since that
+ *               value, so a real step gets through after a while
+ * The median comes from a sorted window (O(log N) search per value) and
+ * the MAD from a walk outward from the median, N/2 steps.
+ */
+template <size_t N>
+class OutlierFilter {
+    static_assert(N >= 3, "a Hampel window needs at least three values");
+
+private:
+    static constexpr float MAD_SCALE = 1.4826f;     // MAD to sigma for Gaussian noise
+    static const size_t MIN_COUNT = N / 2 + 1;
+
+    SlidingMedian<N> window;
+    OutlierLimits limits;
+    float lastAccepted;
+    float sinceAccepted;        // s
+    uint32_t checked;
+    uint32_t outliers;
+    uint32_t rateLimited;
+
+    float medianAbsoluteDeviation(float median) const {
+        size_t count = window.getCount();
+        size_t below = (count - 1) / 2 + 1;     // window[below - 1] <= median
+        size_t above = below;                   // median <= window[above]
+        float previous = 0;
+        float current = 0;
+        for (size_t k = 0; k <= count / 2; k++) {
+            float low = below > 0 ? median - window.getOrdered(below - 1) : INFINITY;
+            float high = above < count ? window.getOrdered(above) - median : INFINITY;
+            previous = current;
+            if (low <= high) {
+                current = low;
+                below--;
+            } else {
+                current = high;
+                above++;
+            }
+        }
+        return count % 2 == 1 ? current : 0.5f * (previous + current);
+    }
+
+public:
+    OutlierFilter() : limits({ 0, 0, 0 }) {
+        reset();
+        resetCounters();
+    }
+
+    void setLimits(const OutlierLimits& values) { limits = values; }
+    const OutlierLimits& getLimits() const { return limits; }
+    bool isEnabled() const { return limits.threshold > 0 || limits.maxRate > 0; }
+
+    // elapsed: seconds since the previous call. Returns false for an
+    // artifact; NAN is never accepted and not counted
+    bool accept(float x, float elapsed) {
+        sinceAccepted += elapsed;
+        if (isnan(x)) {
+            return false;
+        }
+        checked++;
+
+        bool outlier = false;
+        if (limits.threshold > 0 && window.getCount() >= MIN_COUNT) {
+            float median = window.getMedian();
+            float distance = limits.threshold * MAD_SCALE * medianAbsoluteDeviation(median);
+            outlier = fabsf(x - median) > fmaxf(distance, limits.minDeviation);
+        }
+        if (limits.threshold > 0) {
+            window.addValue(x);
+        }
+        if (outlier) {
+            outliers++;
+            return false;
+        }
+
+        if (limits.maxRate > 0 && !isnan(lastAccepted) &&
+            fabsf(x - lastAccepted) > limits.maxRate * sinceAccepted) {
+            rateLimited++;
+            return false;
+        }
+        lastAccepted = x;
+        sinceAccepted = 0;
+        return true;
+    }
+
+    uint32_t getCheckedCount() const { return checked; }
+    uint32_t getRejectedCount() const { return outliers + rateLimited; }
+    uint32_t getOutlierCount() const { return outliers; }
+    uint32_t getRateLimitedCount() const { return rateLimited; }
+
+    // History only; counters keep running
+    void reset() {
+        window.reset();
+        lastAccepted = NAN;
+        sinceAccepted = 0;
+    }
+
+    void resetCounters() {
+        checked = 0;
+        outliers = 0;
+        rateLimited = 0;
+    }
+};
+
+} // namespace Utils
+} // namespace Emopod
+
+#endif
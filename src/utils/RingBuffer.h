@@ -0,0 +1,79 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+
+namespace Emopod {
+namespace Utils {
+
+/*
+ * Fixed-capacity FIFO of POD values. When full, push() overwrites the oldest
+ * entry so the buffer always holds the most recent N items; the caller can
+ * tell an overwrite happened from the return value.
+ */
+template <typename T, int N>
+class RingBuffer {
+private:
+    T items[N];
+    int head;
+    int tail;
+    int count;
+
+public:
+    RingBuffer() : head(0), tail(0), count(0) {}
+
+    // Returns false if the oldest entry had to be dropped to make room
+    bool push(const T& item) {
+        bool dropped = false;
+        if (count == N) {
+            head = (head + 1) % N;
+            count--;
+            dropped = true;
+        }
+        items[tail] = item;
+        tail = (tail + 1) % N;
+        count++;
+        return !dropped;
+    }
+
+    bool pop(T& item) {
+        if (count == 0) {
+            return false;
+        }
+        item = items[head];
+        head = (head + 1) % N;
+        count--;
+        return true;
+    }
+
+    const T& peek(int offset = 0) const {
+        return items[(head + offset) % N];
+    }
+
+    int size() const {
+        return count;
+    }
+
+    bool isEmpty() const {
+        return count == 0;
+    }
+
+    bool isFull() const {
+        return count == N;
+    }
+
+    static int capacity() {
+        return N;
+    }
+
+    void clear() {
+        head = 0;
+        tail = 0;
+        count = 0;
+    }
+};
+
+} // namespace Utils
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+namespace Emopod {
+namespace Utils {
+
+/*
+ * Wait-free single-producer/single-consumer queue
+ *
+ * Exactly one task may push and exactly one (other) task may pop. Each index
+ * is written by one side only and published with release/acquire ordering,
+ * so neither side ever locks, spins or retries. Only atomic loads and stores
+ * are used (no read-modify-write), which keeps it valid on cores without
+ * atomic instructions such as the ESP32-C3.
+ *
+ * When full, push() drops the new item: the producer cannot reclaim slots
+ * the consumer may be reading. Drops and the depth high watermark are kept
+ * for diagnostics.
+ */
+template <typename T, int N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+private:
+    static const uint32_t MASK = N - 1;
+
+    T slots[N];
+
+    // Free-running counters; kept on separate cache lines so the two cores
+    // do not invalidate each other's index on every operation
+    alignas(64) std::atomic<uint32_t> head;   // written by the consumer
+    alignas(64) std::atomic<uint32_t> tail;   // written by the producer
+    std::atomic<uint32_t> dropped;            // written by the producer
+    std::atomic<uint32_t> highWatermark;      // written by the producer
+
+public:
+    SpscQueue() : head(0), tail(0), dropped(0), highWatermark(0) {}
+
+    // Producer side; returns false (and counts a drop) when the queue is full
+    bool push(const T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        if (t - h >= (uint32_t)N) {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[t & MASK] = item;
+        tail.store(t + 1, std::memory_order_release);
+
+        uint32_t depth = t + 1 - h;
+        if (depth > highWatermark.load(std::memory_order_relaxed)) {
+            highWatermark.store(depth, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = slots[h & MASK];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Safe from either side; a snapshot that may be stale by one operation
+    int size() const {
+        uint32_t h = head.load(std::memory_order_acquire);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        return (int)(t - h);
+    }
+
+    bool isEmpty() const {
+        return size() == 0;
+    }
+
+    uint32_t getDropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    int getHighWatermark() const {
+        return (int)highWatermark.load(std::memory_order_relaxed);
+    }
+
+    static constexpr int capacity() {
+        return N;
+    }
+};
+
+} // namespace Utils
+} // namespace Emopod
+
+#endif
@@ -0,0 +1,289 @@
+#ifndef TASK_PIPELINE_H
+#define TASK_PIPELINE_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+#include <atomic>
+#include "utils/SpscQueue.h"
+#include "utils/Logger.h"
+
+namespace Emopod {
+namespace Utils {
+
+/*
+ * TaskPipeline - Producer and consumer tasks joined by an SpscQueue
+ *
+ * The producer (acquisition) and consumer (analysis/upload) each run in
+ * their own task, so a stalled consumer only fills the queue instead of
+ * delaying sampling. On ESP32 both are FreeRTOS tasks pinned to separate
+ * cores and the producer wakes the consumer with a task notification; the
+ * host build runs them as std::threads, with a condition variable standing
+ * in for the notification, so the pipeline can be exercised under load on
+ * a desktop.
+ *
+ *   produce(frame, ctx) -> true when it filled in a frame to enqueue
+ *   consume(frame, ctx) -> called once per dequeued frame
+ *   idle(ctx)           -> called after each drain, even with no frames
+ */
+template <typename Frame, int Depth>
+class TaskPipeline {
+public:
+    typedef bool (*ProduceFn)(Frame& frame, void* context);
+    typedef void (*ConsumeFn)(const Frame& frame, void* context);
+    typedef void (*IdleFn)(void* context);
+
+    struct Config {
+        int producerCore = 1;                 // APP_CPU, away from the WiFi stack
+        int consumerCore = 0;                 // PRO_CPU, alongside WiFi
+        // Bytes. The acquisition pass holds a SensorFrame, the ADC DMA frame,
+        // FIFO burst buffers and, while a log line is formatted in place,
+        // vsnprintf's float path (~1.5 KB on newlib); 4 KB left no margin.
+        // Stats report the high-water marks to size these against.
+        uint32_t producerStack = 8192;
+        uint32_t consumerStack = 8192;        // bytes; JSON + HTTP
+        unsigned int producerPriority = 3;
+        unsigned int consumerPriority = 1;
+        unsigned long producerPeriodMs = 1;   // sleep between produce() calls
+        unsigned long consumerWaitMs = 100;   // longest wait for a frame
+    };
+
+    struct Stats {
+        uint32_t produced;
+        uint32_t consumed;
+        uint32_t dropped;
+        int depth;
+        int maxDepth;
+        uint32_t producerStackFree;   // bytes never touched; 0 on the host
+        uint32_t consumerStackFree;
+    };
+
+private:
+    SpscQueue<Frame, Depth> queue;
+    Config config;
+    ProduceFn produce;
+    ConsumeFn consume;
+    IdleFn idle;
+    void* context;
+
+    std::atomic<bool> running;
+    std::atomic<int> activeTasks;
+    std::atomic<uint32_t> produced;
+    std::atomic<uint32_t> consumed;
+
+#ifdef ARDUINO
+    TaskHandle_t producerHandle;
+    TaskHandle_t consumerHandle;
+#else
+    std::thread producerThread;
+    std::thread consumerThread;
+    std::mutex wakeMutex;
+    std::condition_variable wakeSignal;
+    bool notified;
+#endif
+
+    void runProducer() {
+        Frame frame;
+        while (running.load(std::memory_order_acquire)) {
+            if (produce(frame, context)) {
+                produced.store(produced.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                if (queue.push(frame)) {
+                    wakeConsumer();
+                }
+            }
+            sleepMs(config.producerPeriodMs);
+        }
+    }
+
+    void runConsumer() {
+        Frame frame;
+        while (running.load(std::memory_order_acquire)) {
+            while (queue.pop(frame)) {
+                consume(frame, context);
+                consumed.store(consumed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+            if (idle != nullptr) {
+                idle(context);
+            }
+            waitForFrames(config.consumerWaitMs);
+        }
+    }
+
+#ifdef ARDUINO
+    static void producerEntry(void* self) {
+        TaskPipeline* pipeline = static_cast<TaskPipeline*>(self);
+        pipeline->runProducer();
+        pipeline->activeTasks--;
+        vTaskDelete(NULL);
+    }
+
+    static void consumerEntry(void* self) {
+        TaskPipeline* pipeline = static_cast<TaskPipeline*>(self);
+        pipeline->runConsumer();
+        pipeline->activeTasks--;
+        vTaskDelete(NULL);
+    }
+
+    void wakeConsumer() {
+        if (consumerHandle != NULL) {
+            xTaskNotifyGive(consumerHandle);
+        }
+    }
+
+    void waitForFrames(unsigned long timeoutMs) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs));
+    }
+
+    static void sleepMs(unsigned long ms) {
+        vTaskDelay(ms > 0 ? pdMS_TO_TICKS(ms) : 1);
+    }
+#else
+    // Same semantics as xTaskNotifyGive/ulTaskNotifyTake(pdTRUE): a wake
+    // before the wait is not lost, and taking it clears it
+    void wakeConsumer() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            notified = true;
+        }
+        wakeSignal.notify_one();
+    }
+
+    void waitForFrames(unsigned long timeoutMs) {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeSignal.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() {
+            return notified || !running.load(std::memory_order_acquire);
+        });
+        notified = false;
+    }
+
+    static void sleepMs(unsigned long ms) {
+        if (ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        } else {
+            std::this_thread::yield();
+        }
+    }
+#endif
+
+public:
+    TaskPipeline()
+        : produce(nullptr), consume(nullptr), idle(nullptr), context(nullptr),
+          running(false), activeTasks(0), produced(0), consumed(0)
+#ifdef ARDUINO
+          , producerHandle(NULL), consumerHandle(NULL)
+#else
+          , notified(false)
+#endif
+    {}
+
+    ~TaskPipeline() {
+        stop();
+    }
+
+    bool begin(ProduceFn producer, ConsumeFn consumer, IdleFn onIdle, void* ctx,
+               const Config& cfg = Config()) {
+        if (running.load() || producer == nullptr || consumer == nullptr) {
+            return false;
+        }
+        produce = producer;
+        consume = consumer;
+        idle = onIdle;
+        context = ctx;
+        config = cfg;
+        running.store(true, std::memory_order_release);
+
+#ifdef ARDUINO
+        // Consumer first so the producer's first notification has a target
+        activeTasks = 2;
+        if (xTaskCreatePinnedToCore(consumerEntry, "analysis", config.consumerStack, this,
+                                    config.consumerPriority, &consumerHandle,
+                                    config.consumerCore) != pdPASS) {
+            LOG_ERROR(PIPELINE, "Failed to start analysis task");
+            running.store(false);
+            activeTasks = 0;
+            return false;
+        }
+        if (xTaskCreatePinnedToCore(producerEntry, "acquisition", config.producerStack, this,
+                                    config.producerPriority, &producerHandle,
+                                    config.producerCore) != pdPASS) {
+            LOG_ERROR(PIPELINE, "Failed to start acquisition task");
+            activeTasks--;
+            stop();
+            return false;
+        }
+#else
+        activeTasks = 2;
+        consumerThread = std::thread([this]() { runConsumer(); activeTasks--; });
+        producerThread = std::thread([this]() { runProducer(); activeTasks--; });
+#endif
+        LOG_INFO(PIPELINE, "Acquisition on core %d, analysis on core %d, queue depth %d",
+                 config.producerCore, config.consumerCore, Depth);
+        return true;
+    }
+
+    // Signal both tasks and wait for them to finish their current iteration
+    void stop() {
+        running.store(false, std::memory_order_release);
+#ifdef ARDUINO
+        wakeConsumer();
+        while (activeTasks.load() > 0) {
+            vTaskDelay(1);
+        }
+        producerHandle = NULL;
+        consumerHandle = NULL;
+#else
+        wakeConsumer();
+        if (producerThread.joinable()) {
+            producerThread.join();
+        }
+        if (consumerThread.joinable()) {
+            consumerThread.join();
+        }
+#endif
+    }
+
+    bool isRunning() const {
+        return running.load(std::memory_order_acquire);
+    }
+
+    Stats getStats() const {
+        Stats stats;
+        stats.produced = produced.load(std::memory_order_relaxed);
+        stats.consumed = consumed.load(std::memory_order_relaxed);
+        stats.dropped = queue.getDropped();
+        stats.depth = queue.size();
+        stats.maxDepth = queue.getHighWatermark();
+#ifdef ARDUINO
+        // ESP-IDF counts stack in bytes
+        stats.producerStackFree = producerHandle != NULL ? uxTaskGetStackHighWaterMark(producerHandle) : 0;
+        stats.consumerStackFree = consumerHandle != NULL ? uxTaskGetStackHighWaterMark(consumerHandle) : 0;
+#else
+        stats.producerStackFree = 0;
+        stats.consumerStackFree = 0;
+#endif
+        return stats;
+    }
+
+    void logStats() const {
+        Stats stats = getStats();
+        LOG_INFO(PIPELINE, "produced=%u consumed=%u dropped=%u depth=%d/%d max=%d",
+                 (unsigned)stats.produced, (unsigned)stats.consumed, (unsigned)stats.dropped,
+                 stats.depth, Depth, stats.maxDepth);
+#ifdef ARDUINO
+        LOG_INFO(PIPELINE, "stack free: acquisition %u/%u, analysis %u/%u bytes",
+                 (unsigned)stats.producerStackFree, (unsigned)config.producerStack,
+                 (unsigned)stats.consumerStackFree, (unsigned)config.consumerStack);
+#endif
+    }
+};
+
+} // namespace Utils
+} // namespace Emopod
+
+#endif
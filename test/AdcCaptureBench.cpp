@@ -0,0 +1,156 @@
+// AdcCapture fed by FakeAdcSource: block contents, sample continuity and
+// decimation, the captured/dropped block counters, and conversions per
+// second through pushRaw().
+//
+//   g++ -std=gnu++17 -O2 -I src -I . test/AdcCaptureBench.cpp src/sensors/AdcCapture.cpp -o /tmp/adc_capture_bench && /tmp/adc_capture_bench
+//
+// The channel setup is SensorManager's: 8 kHz raw per channel, the mic
+// undecimated, GSR at 100 Hz, breathing at 50 Hz and the MQ135 at 32 Hz.
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include "sensors/AdcCapture.h"
+
+using namespace Emopod::Sensors;
+
+static const uint32_t RAW_RATE = 8000;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    printf("%-56s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        failures++;
+    }
+}
+
+static void configure(AdcChannelConfig configs[ADC_CHANNEL_COUNT]) {
+    configs[ADC_CHANNEL_MIC] = { 39, 1 };
+    configs[ADC_CHANNEL_GSR] = { 34, 80 };
+    configs[ADC_CHANNEL_BREATHING] = { 33, 160 };
+    configs[ADC_CHANNEL_AIR] = { 36, 250 };
+}
+
+int main() {
+    AdcChannelConfig configs[ADC_CHANNEL_COUNT];
+    configure(configs);
+
+    // Contents: a 1 kHz tone on the mic, a constant on GSR
+    {
+        AdcCapture capture;
+        check(capture.begin(configs, RAW_RATE), "begin() with four channels");
+        FakeAdcSource source;
+        source.setSampleRate(RAW_RATE);
+        source.setWaveform(ADC_CHANNEL_MIC, 1000, 1000, 2048);
+        source.setWaveform(ADC_CHANNEL_GSR, 0, 0, 1234);
+        source.setWaveform(ADC_CHANNEL_BREATHING, 0.25f, 200, 2000, 20);
+
+        // Read as fast as produced: one poll's worth at a time
+        int micBlocks = 0;
+        bool continuous = true, tone = true, gsrExact = true;
+        uint32_t expected = 0;
+        for (int i = 0; i < 100; i++) {
+            source.produce(capture, AdcBlock::SIZE);
+            AdcBlock block;
+            while (capture.readBlock(ADC_CHANNEL_MIC, block)) {
+                continuous &= block.firstSample == expected && block.count == AdcBlock::SIZE;
+                expected += block.count;
+                uint16_t low = 4095, high = 0;
+                for (int k = 0; k < block.count; k++) {
+                    low = block.samples[k] < low ? block.samples[k] : low;
+                    high = block.samples[k] > high ? block.samples[k] : high;
+                }
+                // 8 samples per cycle hit the peaks to within rounding
+                tone &= abs(high - 3048) <= 1 && abs(low - 1048) <= 1;
+                micBlocks++;
+            }
+            while (capture.readBlock(ADC_CHANNEL_GSR, block)) {
+                gsrExact &= block.sampleRate == 100 && fabsf(block.mean() - 1234) < 1e-3f;
+            }
+        }
+        check(micBlocks == 100 && continuous, "mic blocks contiguous, no gaps or repeats");
+        check(tone, "mic block peaks match the 1 kHz tone");
+        check(gsrExact, "GSR decimated to 100 Hz, constant preserved");
+        const AdcChannelStats& mic = capture.getStats(ADC_CHANNEL_MIC);
+        check(mic.samplesCaptured == 6400 && mic.blocksCaptured == 100 && mic.blocksDropped == 0,
+              "mic counters: 6400 samples, 100 blocks, 0 dropped");
+    }
+
+    // Counters: nobody reads the mic, so the ring of 8 overflows
+    {
+        AdcCapture capture;
+        capture.begin(configs, RAW_RATE);
+        FakeAdcSource source;
+        source.setSampleRate(RAW_RATE);
+        source.produce(capture, 20 * AdcBlock::SIZE);
+        const AdcChannelStats& mic = capture.getStats(ADC_CHANNEL_MIC);
+        printf("unread mic after 20 blocks: %u captured, %u dropped, %d queued\n",
+               (unsigned)mic.blocksCaptured, (unsigned)mic.blocksDropped,
+               capture.availableBlocks(ADC_CHANNEL_MIC));
+        check(mic.blocksCaptured == 8 && mic.blocksDropped == 12, "captured counts only blocks that found room");
+        check(capture.availableBlocks(ADC_CHANNEL_MIC) == 8, "ring keeps the newest 8 blocks");
+        AdcBlock block;
+        capture.readBlock(ADC_CHANNEL_MIC, block);
+        check(block.firstSample == 12 * AdcBlock::SIZE, "oldest queued block is block 12");
+    }
+
+    // A disabled channel produces nothing
+    {
+        AdcChannelConfig partial[ADC_CHANNEL_COUNT];
+        configure(partial);
+        partial[ADC_CHANNEL_AIR].pin = -1;
+        AdcCapture capture;
+        capture.begin(partial, RAW_RATE);
+        FakeAdcSource source;
+        source.setSampleRate(RAW_RATE);
+        source.produce(capture, 100000);
+        check(!capture.isChannelEnabled(ADC_CHANNEL_AIR) &&
+              capture.getStats(ADC_CHANNEL_AIR).samplesCaptured == 0, "disabled channel captures nothing");
+    }
+
+    // Throughput of the block path, waveform synthesis excluded: one scan
+    // frame of four conversions per iteration, blocks drained as they complete
+    {
+        AdcCapture capture;
+        capture.begin(configs, RAW_RATE);
+        const uint32_t frames = 20000000;
+        uint32_t sink = 0;
+        double best = 1e30;
+        for (int pass = 0; pass < 5; pass++) {
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t f = 0; f < frames; f++) {
+                uint16_t raw = (uint16_t)(f & 0xFFF);
+                capture.pushRaw(ADC_CHANNEL_MIC, raw);
+                capture.pushRaw(ADC_CHANNEL_GSR, raw);
+                capture.pushRaw(ADC_CHANNEL_BREATHING, raw);
+                capture.pushRaw(ADC_CHANNEL_AIR, raw);
+                if ((f & (AdcBlock::SIZE - 1)) == AdcBlock::SIZE - 1) {
+                    AdcBlock block;
+                    for (int c = 0; c < ADC_CHANNEL_COUNT; c++) {
+                        while (capture.readBlock((AdcChannel)c, block)) {
+                            sink += block.samples[0];
+                        }
+                    }
+                }
+            }
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        double conversions = 4.0 * frames / best;
+        printf("\npushRaw(): %.1f M conversions/s, %.1f ns each; 4 x 8 kHz is %.3f%% of a host core (%u)\n",
+               conversions / 1e6, 1e9 / conversions, 100 * 4 * RAW_RATE / conversions, sink & 1);
+        check(capture.getStats(ADC_CHANNEL_MIC).blocksDropped == 0, "no drops when drained every block");
+
+        FakeAdcSource source;
+        source.setSampleRate(RAW_RATE);
+        auto start = std::chrono::steady_clock::now();
+        source.produce(capture, 2000000);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("FakeAdcSource with synthesis: %.1f M scan frames/s (%.0fx real time)\n",
+               2000000 / seconds / 1e6, 2000000 / seconds / RAW_RATE);
+    }
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+// EmotionModel: analyze() one frame at a time against analyzeBatch() on
+// struct-of-arrays input, frames per second and agreement.
+//
+//   g++ -std=gnu++17 -O2 -I test/host -I src -I . test/EmotionModelBench.cpp -o /tmp/emotion_model_bench && /tmp/emotion_model_bench
+//
+// Frames are drawn uniformly over each sensor's plausible range, so every
+// state occurs, with 5% of the inputs NAN. Both paths run the same
+// per-frame code and must agree exactly: states between analyze() and
+// analyzeBatch(), and score bits between whole batches, batches whose tail
+// is not a full chunk, and one-frame batches.
+//
+// The network's cycles per inference are collected one frame at a time and
+// reported against NETWORK_BUDGET_CYCLES; the 99th percentile must be
+// within it. On x86 cycleCount() reads the TSC, so this bounds the host
+// build only; on target the budget is a monitoring threshold and overruns
+// are counted, not enforced.
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "models/EmotionModel.h"
+
+static const int FRAMES = 1 << 16;
+static const int FIELDS = 15;
+static const int REPEATS = 20;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    printf("%-56s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        failures++;
+    }
+}
+
+struct Frames {
+    std::vector<EmotionModel::SensorData> rows;
+    std::vector<float> columns[FIELDS];
+
+    Frames() : rows(FRAMES) {
+        for (std::vector<float>& column : columns) {
+            column.resize(FRAMES);
+        }
+    }
+
+    // Columns in SensorData order; SDNN and pNN50 are not scored
+    EmotionModel::SensorBatch batch(int start = 0) const {
+        return { &columns[0][start], &columns[1][start], &columns[2][start], &columns[3][start],
+                 &columns[4][start], &columns[5][start], &columns[6][start], &columns[7][start],
+                 &columns[8][start], &columns[9][start], &columns[12][start], &columns[13][start],
+                 &columns[14][start] };
+    }
+};
+
+static Frames makeFrames() {
+    Frames frames;
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> uniform(0, 1);
+    const float low[FIELDS] = { 50, 0, 35, 400, 8, 0, 0, 0, 30, 5, 10, 0, 0.2f, 0, 0 };
+    const float high[FIELDS] = { 140, 12, 39, 2500, 35, 4, 4, 4, 100, 80, 100, 60, 6, 15, 1.2f };
+    for (int i = 0; i < FRAMES; i++) {
+        float* row = reinterpret_cast<float*>(&frames.rows[i]);
+        for (int k = 0; k < FIELDS; k++) {
+            float x = low[k] + (high[k] - low[k]) * uniform(rng);
+            if (uniform(rng) < 0.05f) {
+                x = NAN;
+            }
+            row[k] = x;
+            frames.columns[k][i] = x;
+        }
+    }
+    return frames;
+}
+
+// Best of REPEATS passes, in frames per second
+template <typename Body>
+static double framesPerSecond(Body body) {
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return FRAMES / best;
+}
+
+static void compare(EmotionModel& model, const Frames& frames, const char* name) {
+    EmotionModel::SensorBatch batch = frames.batch();
+    std::vector<EmotionModel::EmotionState> scalar(FRAMES), batched(FRAMES), single(FRAMES), ragged(FRAMES);
+    std::vector<float> scores(FRAMES), singleScores(FRAMES), raggedScores(FRAMES);
+
+    double scalarRate = framesPerSecond([&] {
+        for (int i = 0; i < FRAMES; i++) {
+            scalar[i] = model.analyze(frames.rows[i]);
+        }
+    });
+    double batchRate = framesPerSecond([&] { model.analyzeBatch(batch, FRAMES, batched.data()); });
+    double scoredRate = framesPerSecond([&] {
+        model.analyzeBatch(batch, FRAMES, batched.data(), scores.data());
+    });
+
+    // One frame per call, and batches of 100 so each ends in a 36-frame tail
+    for (int i = 0; i < FRAMES; i++) {
+        model.analyzeBatch(frames.batch(i), 1, &single[i], &singleScores[i]);
+    }
+    for (int start = 0; start < FRAMES; start += 100) {
+        int count = std::min(100, FRAMES - start);
+        model.analyzeBatch(frames.batch(start), count, &ragged[start], &raggedScores[start]);
+    }
+
+    int histogram[EmotionModel::UNKNOWN] = {};
+    for (EmotionModel::EmotionState state : batched) {
+        histogram[state]++;
+    }
+    printf("\n%s: calm %d, mild %d, moderate %d, high %d\n", name, histogram[0], histogram[1],
+           histogram[2], histogram[3]);
+    printf("  analyze()              %6.1f M frames/s\n", scalarRate / 1e6);
+    printf("  analyzeBatch()         %6.1f M frames/s (%.1fx)\n", batchRate / 1e6, batchRate / scalarRate);
+    printf("  analyzeBatch(scores)   %6.1f M frames/s (%.1fx)\n", scoredRate / 1e6, scoredRate / scalarRate);
+
+    check(scalar == batched, "  analyze() and analyzeBatch() states identical");
+    check(single == batched && ragged == batched, "  chunk tails and one-frame batches give the same states");
+    check(memcmp(singleScores.data(), scores.data(), FRAMES * sizeof(float)) == 0 &&
+          memcmp(raggedScores.data(), scores.data(), FRAMES * sizeof(float)) == 0,
+          "  scores bit-identical however the batch is split");
+}
+
+int main() {
+    Frames frames = makeFrames();
+
+    EmotionModel model;
+    compare(model, frames, "weighted sum");
+
+    model.setClassifier(EmotionModel::NETWORK);
+    compare(model, frames, "network");
+
+    // Per-inference cost against the budget
+    {
+        std::vector<uint32_t> cycles(FRAMES);
+        model.resetNetworkStats();
+        for (int i = 0; i < FRAMES; i++) {
+            model.analyze(frames.rows[i]);
+            cycles[i] = model.getNetworkStats().lastCycles;
+        }
+        std::sort(cycles.begin(), cycles.end());
+        const Emopod::Models::StressNetwork::Stats& stats = model.getNetworkStats();
+        uint32_t budget = EmotionModel::getNetworkBudget();
+        uint32_t p99 = cycles[FRAMES * 99 / 100];
+        printf("  cycles per inference: median %u, p99 %u, max %u; budget %u, %lu of %lu over\n",
+               (unsigned)cycles[FRAMES / 2], (unsigned)p99, (unsigned)stats.maxCycles, (unsigned)budget,
+               (unsigned long)stats.overruns, (unsigned long)stats.inferences);
+        check(p99 <= budget, "  99th percentile inference within the cycle budget");
+    }
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// utils/FixedPoint.h: saturation edges, rounding and FixedScale error
+// bounds, FixedBiquad against a double-precision reference, and the cost of
+// the Q31 biquad next to the float one.
+//
+//   g++ -std=gnu++17 -O2 -I src -I . test/FixedPointTest.cpp -o /tmp/fixed_point_test && /tmp/fixed_point_test
+//
+// Biquad errors are given in LSBs of a 12-bit ADC (full scale 2048 counts
+// either side of zero), the resolution the signal paths start from.
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "utils/FixedPoint.h"
+
+using namespace Emopod::Utils;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    printf("%-56s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        failures++;
+    }
+}
+
+static double q31ToDouble(int32_t raw) {
+    return raw / 2147483648.0;
+}
+
+// Transposed direct form II in double, from the float design
+struct ReferenceBiquad {
+    double b0, b1, b2, a1, a2;
+    double z1 = 0, z2 = 0;
+
+    explicit ReferenceBiquad(const Biquad& design) {
+        float c[5];
+        design.getCoefficients(c);
+        b0 = c[0];
+        b1 = c[1];
+        b2 = c[2];
+        a1 = c[3];
+        a2 = c[4];
+    }
+
+    double process(double x) {
+        double y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        return y;
+    }
+};
+
+static void saturationEdges() {
+    check(Q15::max() + Q15::fromFloat(0.5f) == Q15::max(), "Q15 add saturates at max");
+    check(Q15::min() - Q15::fromFloat(0.5f) == Q15::min(), "Q15 subtract saturates at min");
+    check(-Q15::min() == Q15::max(), "Q15 -(-1) saturates to max");
+    check(Q15::min() * Q15::min() == Q15::max(), "Q15 -1 * -1 saturates to max");
+    check(Q15::max() * Q15::max() == Q15::fromRaw(32766), "Q15 max * max rounds to 32766");
+    check(Q31::min() * Q31::min() == Q31::max(), "Q31 -1 * -1 saturates to max");
+    check(Q31::max() + Q31::max() == Q31::max(), "Q31 add saturates at max");
+    check(Q31::min() + Q31::min() == Q31::min(), "Q31 add saturates at min");
+    check(Q31::fromFloat(2.0f) == Q31::max() && Q31::fromFloat(-3.0f) == Q31::min(),
+          "Q31 fromFloat clamps out-of-range input");
+    check(Q15::fromFloat(-1.0f) == Q15::min() && Q15::fromFloat(1.0f) == Q15::max(),
+          "Q15 fromFloat maps +-1 to the range limits");
+    check(Q15::fromRaw(1) * Q15::fromRaw(16384) == Q15::fromRaw(1),
+          "Q15 multiply rounds half up (1 * 0.5 LSB -> 1)");
+    check(Q15::fromRaw(-1) * Q15::fromRaw(16384) == Q15::fromRaw(0),
+          "Q15 multiply rounds half up (-1 * 0.5 LSB -> 0)");
+}
+
+static void roundingBounds(std::mt19937& rng) {
+    std::uniform_real_distribution<double> uniform(-0.999, 0.999);
+    double quantize15 = 0, multiply15 = 0, multiply31 = 0;
+    for (int i = 0; i < 1000000; i++) {
+        double a = uniform(rng), b = uniform(rng);
+        Q15 qa = Q15::fromFloat((float)a), qb = Q15::fromFloat((float)b);
+        Q31 ra = Q31::fromFloat((float)a), rb = Q31::fromFloat((float)b);
+        quantize15 = std::max(quantize15, fabs(qa.toFloat() - (double)(float)a));
+        multiply15 = std::max(multiply15, fabs((qa * qb).toFloat() - (double)qa.toFloat() * qb.toFloat()));
+        multiply31 = std::max(multiply31, fabs(q31ToDouble((ra * rb).getRaw()) -
+                                               q31ToDouble(ra.getRaw()) * q31ToDouble(rb.getRaw())));
+    }
+    printf("Q15 quantize %.2e, Q15 multiply %.2e, Q31 multiply %.2e (half LSB: %.2e, %.2e)\n",
+           quantize15, multiply15, multiply31, 0.5 / 32768, 0.5 / 2147483648.0);
+    check(quantize15 <= 0.5 / 32768 + 1e-9, "Q15 fromFloat within half an LSB");
+    check(multiply15 <= 0.5 / 32768 + 1e-9, "Q15 multiply within half an LSB");
+    check(multiply31 <= 0.5 / 2147483648.0 * 1.0001, "Q31 multiply within half an LSB");
+}
+
+static void scaleBounds(std::mt19937& rng) {
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    double worst = 0;
+    for (int i = 0; i < 100000; i++) {
+        double ratio = exp(uniform(rng) * 10);
+        FixedScale scale = FixedScale::fromRatio(ratio);
+        int32_t x = (int32_t)(uniform(rng) * 1e5);
+        double want = x * ratio;
+        if (fabs(want) > 2e9) {
+            continue;
+        }
+        // Beyond the half LSB of the final rounding, relative to the result
+        double error = fabs(scale.apply(x) - want) - 0.5;
+        worst = std::max(worst, error / std::max(1.0, fabs(want)));
+    }
+    printf("FixedScale worst error beyond rounding: %.2e relative (bound 2^-30 = %.2e)\n",
+           worst, ldexp(1.0, -30));
+    check(worst <= ldexp(1.0, -30), "FixedScale within 2^-30 plus rounding");
+
+    FixedScale millivolts = FixedScale::fromRatio(3300.0 / 4095);
+    check(millivolts.apply(4095) == 3300 && millivolts.apply(0) == 0, "FixedScale counts to mV end points");
+    check(FixedScale::fromRatio(1e-30).apply(INT32_MAX) == 0, "FixedScale tiny ratio rounds to 0");
+    check(FixedScale::fromRatio(8.0).apply(INT32_MAX) == INT32_MAX &&
+          FixedScale::fromRatio(8.0).apply(INT32_MIN) == INT32_MIN, "FixedScale saturates large products");
+    check(FixedScale::fromRatio(-0.5).apply(3) == -1, "FixedScale negative ratio rounds half up");
+}
+
+static void movingAverage(std::mt19937& rng) {
+    std::uniform_real_distribution<double> uniform(-0.5, 0.5);
+    FixedMovingAverage<10, Q15> average;
+    std::vector<double> window;
+    double worst = 0;
+    for (int i = 0; i < 100000; i++) {
+        Q15 q = Q15::fromFloat((float)uniform(rng));
+        average.addValue(q);
+        window.push_back(q.toFloat());
+        if (window.size() > 10) {
+            window.erase(window.begin());
+        }
+        double mean = 0;
+        for (double v : window) {
+            mean += v;
+        }
+        mean /= window.size();
+        worst = std::max(worst, fabs(average.getAverage().toFloat() - mean));
+    }
+    check(worst <= 0.5 / 32768 + 1e-9, "FixedMovingAverage within half an LSB, no drift");
+}
+
+static void biquads(std::mt19937& rng) {
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    struct Case {
+        const char* name;
+        float sampleRate;
+        Biquad design;
+        double amplitude;
+    };
+    // The A-weighting sections are the SoundLevelMeter's; the rest are the
+    // breathing, PPG and EDA band edges
+    const double w1 = 2 * M_PI * 20.598997, w2 = 2 * M_PI * 107.65265;
+    const double w3 = 2 * M_PI * 737.86223, w4 = 2 * M_PI * 12194.217;
+    const Case cases[] = {
+        { "low-pass 3 Hz @ 100", 100, Biquad::lowPass(100, 3), 0.5 },
+        { "high-pass 0.5 Hz @ 100", 100, Biquad::highPass(100, 0.5f), 0.5 },
+        { "low-pass 1 Hz @ 10", 10, Biquad::lowPass(10, 1), 0.5 },
+        { "A-weight 1 @ 8k", 8000, Biquad::bilinear(8000, 1, 0, 0, 1, 2 * w1, w1 * w1), 0.25 },
+        { "A-weight 2 @ 8k", 8000, Biquad::bilinear(8000, 1, 0, 0, 1, w2 + w3, w2 * w3), 0.5 },
+        { "A-weight 3 @ 8k", 8000, Biquad::bilinear(8000, 0, 0, 1, 1, 2 * w4, w4 * w4), 0.2 },
+    };
+    printf("\n%-24s %14s %14s\n", "max error vs double", "float (LSB)", "Q31 (LSB)");
+    double worstFixed = 0;
+    for (const Case& c : cases) {
+        ReferenceBiquad reference(c.design);
+        Biquad single = c.design;
+        FixedBiquad fixed(c.design);
+        double floatError = 0, fixedError = 0;
+        const int count = 200000;
+        for (int i = 0; i < count; i++) {
+            double t = i / c.sampleRate;
+            double x = c.amplitude * (0.6 * sin(2 * M_PI * 0.03 * c.sampleRate * t) +
+                                      0.3 * sin(2 * M_PI * c.sampleRate / 7 * t)) + 0.05 * uniform(rng);
+            x = round(x * 2048) / 2048;       // 12-bit input
+            double want = reference.process(x);
+            float single_ = single.process((float)x);
+            int32_t fixed_ = fixed.process((int32_t)llround(x * 2147483648.0));
+            if (i > count / 10) {
+                floatError = std::max(floatError, fabs(single_ - want));
+                fixedError = std::max(fixedError, fabs(q31ToDouble(fixed_) - want));
+            }
+        }
+        printf("%-24s %14.2e %14.2e\n", c.name, floatError * 2048, fixedError * 2048);
+        worstFixed = std::max(worstFixed, fixedError * 2048);
+    }
+    check(worstFixed < 0.05, "FixedBiquad within 0.05 LSB of double in every section");
+
+    // Saturation: a first-order low-pass with gain 2 at DC, driven at full
+    // scale, clips instead of wrapping
+    FixedBiquad loud(Biquad::bilinear(8000, 0, 0, 2000, 0, 1, 1000));
+    int32_t y = 0;
+    bool wrapped = false;
+    for (int i = 0; i < 2000; i++) {
+        y = loud.process(INT32_MAX);
+        wrapped |= y < 0;
+    }
+    check(!wrapped && y == INT32_MAX, "FixedBiquad saturates instead of wrapping");
+
+    // prime() starts the section at its DC steady state
+    FixedBiquad primed(Biquad::lowPass(100, 3));
+    int32_t level = (int32_t)(0.25 * 2147483648.0);
+    primed.prime(level);
+    check(abs(primed.process(level) - level) < 64, "FixedBiquad prime() holds a DC input");
+}
+
+static void throughput(std::mt19937& rng) {
+    std::uniform_real_distribution<double> uniform(-0.5, 0.5);
+    const int count = 4000000;
+    std::vector<float> floats(count);
+    std::vector<int32_t> fixed(count);
+    for (int i = 0; i < count; i++) {
+        floats[i] = (float)uniform(rng);
+        fixed[i] = (int32_t)(floats[i] * 2147483648.0);
+    }
+    Biquad single = Biquad::lowPass(8000, 1000);
+    FixedBiquad q31(single);
+
+    auto start = std::chrono::steady_clock::now();
+    single.processBlock(floats.data(), floats.data(), count);
+    double floatNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    start = std::chrono::steady_clock::now();
+    q31.processBlock(fixed.data(), fixed.data(), count);
+    double fixedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    printf("\nhost biquad: float %.2f ns/sample, Q31 %.2f ns/sample (checksum %g)\n", floatNs, fixedNs,
+           (double)floats[count - 1] + q31ToDouble(fixed[count - 1]));
+}
+
+int main() {
+    std::mt19937 rng(7);
+    saturationEdges();
+    roundingBounds(rng);
+    scaleBounds(rng);
+    movingAverage(rng);
+    biquads(rng);
+    throughput(rng);
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+// MotionFusion on a synthetic IMU trace: tilt error, gravity removal,
+// cadence and step count, and the cost per sample.
+//
+//   g++ -std=gnu++17 -O2 -I test/host -I src -I . test/MotionFusionBench.cpp src/sensors/MotionFusion.cpp -o /tmp/fusion_bench && /tmp/fusion_bench
+//
+// The trace is 100 s at 100 Hz with gyro bias and sensor noise, in four
+// phases: still and tilted (roll 30, pitch 10), rotating about all three
+// axes, walking at 108 steps/min, and fidgeting. True orientation is
+// integrated at 10x the sample rate; the estimate's up axis is compared
+// with it after every 10-sample batch.
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "sensors/MotionFusion.h"
+
+using Emopod::Sensors::MotionFusion;
+
+static const double SAMPLE_RATE = 100.0;
+static const int SAMPLES = 100 * 100;
+static const int BATCH = 10;
+static const int PHASES = 4;
+static const double PHASE_START[PHASES] = { 0, 20, 40, 70 };
+static const char* PHASE_NAMES[PHASES] = { "still, tilted", "rotating", "walking 108/min", "fidgeting" };
+
+struct Quaternion {
+    double w, x, y, z;
+};
+
+static Quaternion multiply(const Quaternion& a, const Quaternion& b) {
+    return { a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+             a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+             a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+             a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w };
+}
+
+// World vector into the sensor frame: q* v q
+static void toSensor(const Quaternion& q, const double v[3], double out[3]) {
+    Quaternion p = { 0, v[0], v[1], v[2] };
+    Quaternion conjugate = { q.w, -q.x, -q.y, -q.z };
+    Quaternion r = multiply(multiply(conjugate, p), q);
+    out[0] = r.x;
+    out[1] = r.y;
+    out[2] = r.z;
+}
+
+static int phaseOf(double t) {
+    return t < 20 ? 0 : (t < 40 ? 1 : (t < 70 ? 2 : 3));
+}
+
+struct Trace {
+    std::vector<float> ax, ay, az, gx, gy, gz;
+    std::vector<double> up;       // true up axis in the sensor frame, 3 per sample
+
+    Trace() : ax(SAMPLES), ay(SAMPLES), az(SAMPLES), gx(SAMPLES), gy(SAMPLES), gz(SAMPLES),
+              up(3 * SAMPLES) {}
+};
+
+static Trace makeTrace() {
+    Trace trace;
+    std::mt19937 rng(3);
+    std::normal_distribution<double> gaussian(0, 1);
+    const double roll = 30 * M_PI / 180;
+    const double pitch = 10 * M_PI / 180;
+    Quaternion q = { cos(roll / 2) * cos(pitch / 2), sin(roll / 2) * cos(pitch / 2),
+                     cos(roll / 2) * sin(pitch / 2), -sin(roll / 2) * sin(pitch / 2) };
+    const double bias[3] = { 0.01, -0.008, 0.005 };
+
+    for (int i = 0; i < SAMPLES; i++) {
+        double t = i / SAMPLE_RATE;
+        double w[3] = { 0, 0, 0 };
+        double a[3] = { 0, 0, 0 };
+        int phase = phaseOf(t);
+        if (phase == 1) {
+            w[0] = 0.8 * sin(2 * M_PI * 0.2 * t);
+            w[1] = 0.6 * sin(2 * M_PI * 0.13 * t + 1);
+            w[2] = 0.5 * sin(2 * M_PI * 0.07 * t);
+        } else if (phase == 2) {
+            a[2] = 2.5 * sin(2 * M_PI * 1.8 * t);
+            a[0] = 0.6 * sin(2 * M_PI * 0.9 * t);
+        } else if (phase == 3) {
+            a[0] = 0.5 * sin(2 * M_PI * 3 * t) * sin(2 * M_PI * 0.4 * t);
+            a[1] = 0.4 * cos(2 * M_PI * 2.3 * t);
+        }
+
+        const int substeps = 10;
+        for (int k = 0; k < substeps; k++) {
+            double h = 1 / SAMPLE_RATE / substeps;
+            q = multiply(q, { 1, 0.5 * w[0] * h, 0.5 * w[1] * h, 0.5 * w[2] * h });
+            double norm = sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+            q = { q.w / norm, q.x / norm, q.y / norm, q.z / norm };
+        }
+
+        double force[3] = { a[0], a[1], a[2] + 9.80665 };
+        double sensed[3];
+        toSensor(q, force, sensed);
+        const double worldUp[3] = { 0, 0, 1 };
+        toSensor(q, worldUp, &trace.up[3 * i]);
+
+        trace.ax[i] = (float)(sensed[0] + 0.05 * gaussian(rng));
+        trace.ay[i] = (float)(sensed[1] + 0.05 * gaussian(rng));
+        trace.az[i] = (float)(sensed[2] + 0.05 * gaussian(rng));
+        trace.gx[i] = (float)(w[0] + bias[0] + 0.005 * gaussian(rng));
+        trace.gy[i] = (float)(w[1] + bias[1] + 0.005 * gaussian(rng));
+        trace.gz[i] = (float)(w[2] + bias[2] + 0.005 * gaussian(rng));
+    }
+    return trace;
+}
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    printf("%-50s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        failures++;
+    }
+}
+
+int main() {
+    Trace trace = makeTrace();
+
+    MotionFusion fusion((float)SAMPLE_RATE);
+    double tiltSum[PHASES] = {}, tiltMax[PHASES] = {};
+    double linear[PHASES] = {}, raw[PHASES] = {}, cadence[PHASES] = {}, fidget[PHASES] = {};
+    int tiltCount[PHASES] = {}, featureCount[PHASES] = {};
+    uint32_t walkingSteps = 0;
+
+    for (int s = 0; s < SAMPLES; s += BATCH) {
+        uint32_t stepsBefore = fusion.getFeatures().steps;
+        fusion.processBatch(&trace.ax[s], &trace.ay[s], &trace.az[s],
+                            &trace.gx[s], &trace.gy[s], &trace.gz[s], BATCH);
+        int i = s + BATCH - 1;
+        double t = i / SAMPLE_RATE;
+        int phase = phaseOf(t);
+
+        float q[4];
+        fusion.getQuaternion(q);
+        double ux = 2 * (q[1] * q[3] - q[0] * q[2]);
+        double uy = 2 * (q[0] * q[1] + q[2] * q[3]);
+        double uz = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+        double dot = ux * trace.up[3 * i] + uy * trace.up[3 * i + 1] + uz * trace.up[3 * i + 2];
+        double error = acos(std::min(1.0, dot)) * 180 / M_PI;
+        if (t > 2) {
+            tiltSum[phase] += error;
+            tiltMax[phase] = std::max(tiltMax[phase], error);
+            tiltCount[phase]++;
+        }
+
+        const MotionFusion::Features& features = fusion.getFeatures();
+        if (phase == 2) {
+            walkingSteps += features.steps - stepsBefore;
+        }
+        // Features settle for 5 s into each phase
+        if (t - PHASE_START[phase] > 5) {
+            double magnitude = 0;
+            for (int k = s; k < s + BATCH; k++) {
+                magnitude += sqrt(trace.ax[k] * trace.ax[k] + trace.ay[k] * trace.ay[k] +
+                                  trace.az[k] * trace.az[k]);
+            }
+            linear[phase] += features.linearMagnitude;
+            raw[phase] += magnitude / BATCH;
+            cadence[phase] += features.cadence;
+            fidget[phase] += features.fidgetEnergy;
+            featureCount[phase]++;
+        }
+    }
+
+    printf("%-16s %9s %9s %9s %9s %9s %9s\n", "phase", "tilt avg", "tilt max", "|linear|",
+           "raw |a|", "cadence", "fidget");
+    for (int p = 0; p < PHASES; p++) {
+        printf("%-16s %9.2f %9.2f %9.3f %9.2f %9.1f %9.3f\n", PHASE_NAMES[p],
+               tiltSum[p] / tiltCount[p], tiltMax[p], linear[p] / featureCount[p],
+               raw[p] / featureCount[p], cadence[p] / featureCount[p], fidget[p] / featureCount[p]);
+    }
+    printf("steps while walking: %u (30 s at 1.8 Hz = 54)\n\n", (unsigned)walkingSteps);
+
+    double worstMean = 0, worstMax = 0;
+    for (int p = 0; p < PHASES; p++) {
+        worstMean = std::max(worstMean, tiltSum[p] / tiltCount[p]);
+        worstMax = std::max(worstMax, tiltMax[p]);
+    }
+    check(worstMean < 1.0, "tilt error under 1 deg mean in every phase");
+    check(worstMax < 3.0, "tilt error under 3 deg at worst");
+    check(linear[0] / featureCount[0] < 0.2, "gravity removed while still (< 0.2 m/s^2)");
+    check(fabs(cadence[2] / featureCount[2] - 108) < 3, "walking cadence within 3 of 108/min");
+    check(walkingSteps >= 52 && walkingSteps <= 56, "walking steps within 2 of 54");
+    check(cadence[3] / featureCount[3] == 0, "no cadence while fidgeting");
+    check(fidget[3] / featureCount[3] > 10 * fidget[0] / featureCount[0], "fidgeting raises fidget energy");
+
+    // Cost: the whole trace repeatedly, in FIFO-sized batches
+    MotionFusion timed((float)SAMPLE_RATE);
+    const int repeats = 200;
+    const int fifoBatch = 85;      // 1024-byte FIFO of 12-byte samples
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int s = 0; s < SAMPLES; s += fifoBatch) {
+            int count = std::min(fifoBatch, SAMPLES - s);
+            timed.processBatch(&trace.ax[s], &trace.ay[s], &trace.az[s],
+                               &trace.gx[s], &trace.gy[s], &trace.gz[s], count);
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    const MotionFusion::Stats& stats = timed.getStats();
+    printf("%.1f ns per sample, %.0f cycles per sample (cycleCount), %zu bytes of state\n",
+           ns / ((double)repeats * SAMPLES), (double)stats.totalCycles / stats.samples,
+           sizeof(MotionFusion));
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
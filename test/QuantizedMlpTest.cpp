@@ -0,0 +1,240 @@
+// models/QuantizedMlp.h: the integer run() against runReference() on
+// random networks and the stress network, the network classifier against
+// the weighted sum it transcribes, and the cost of an inference.
+//
+//   g++ -std=gnu++17 -O2 -I test/host -I src -I . test/QuantizedMlpTest.cpp -o /tmp/quantized_mlp_test && /tmp/quantized_mlp_test
+//
+// Random networks draw weights, biases, per-channel scales and zero points
+// afresh, so requantization ratios and offsets cover a wide range; their
+// outputs must match the double reference exactly, not within an LSB.
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "models/EmotionModel.h"
+
+using namespace Emopod::Models;
+
+static const uint32_t NO_BUDGET = 0xFFFFFFFFu;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    printf("%-56s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        failures++;
+    }
+}
+
+// Counts outputs, and outputs differing from runReference(), over `trials`
+// random inputs to one random network with two hidden layers
+template <int IN, int HIDDEN, int HIDDEN2, int OUT>
+static void randomNetwork(std::mt19937& rng, int trials, long& outputs, long& mismatches) {
+    static int8_t w1[HIDDEN][IN], w2[HIDDEN2][HIDDEN], w3[OUT][HIDDEN2];
+    static float s1[HIDDEN], s2[HIDDEN2], s3[OUT];
+    static int32_t b1[HIDDEN], b2[HIDDEN2], b3[OUT];
+    std::uniform_int_distribution<int> weight(-127, 127), zero(-20, 20), value(-128, 127);
+    std::uniform_real_distribution<float> uniform(0.2f, 1.0f);
+
+    Quantization in = { uniform(rng) * 0.1f, zero(rng) };
+    for (int o = 0; o < HIDDEN; o++) {
+        s1[o] = uniform(rng) * 0.01f;
+        b1[o] = weight(rng) * 40;
+        for (int i = 0; i < IN; i++) w1[o][i] = (int8_t)weight(rng);
+    }
+    for (int o = 0; o < HIDDEN2; o++) {
+        s2[o] = uniform(rng) * 0.01f;
+        b2[o] = weight(rng) * 40;
+        for (int i = 0; i < HIDDEN; i++) w2[o][i] = (int8_t)weight(rng);
+    }
+    for (int o = 0; o < OUT; o++) {
+        s3[o] = uniform(rng) * 0.01f;
+        b3[o] = weight(rng) * 40;
+        for (int i = 0; i < HIDDEN2; i++) w3[o][i] = (int8_t)weight(rng);
+    }
+    const DenseLayer layers[3] = {
+        { &w1[0][0], s1, b1, { uniform(rng) * 0.5f, -128 }, true },
+        { &w2[0][0], s2, b2, { uniform(rng) * 0.5f, -128 }, true },
+        { &w3[0][0], s3, b3, { uniform(rng) * 0.5f, zero(rng) }, false },
+    };
+    QuantizedMlp<IN, HIDDEN, HIDDEN2, OUT> deep(in, layers, NO_BUDGET);
+
+    for (int t = 0; t < trials; t++) {
+        int8_t x[IN], fast[OUT], reference[OUT];
+        for (int i = 0; i < IN; i++) {
+            x[i] = (int8_t)value(rng);
+        }
+        deep.run(x, fast);
+        deep.runReference(x, reference);
+        for (int o = 0; o < OUT; o++) {
+            mismatches += fast[o] != reference[o];
+        }
+        outputs += OUT;
+    }
+}
+
+// The same with one hidden layer
+template <int IN, int HIDDEN, int OUT>
+static void randomShallowNetwork(std::mt19937& rng, int trials, long& outputs, long& mismatches) {
+    static int8_t w1[HIDDEN][IN], w2[OUT][HIDDEN];
+    static float s1[HIDDEN], s2[OUT];
+    static int32_t b1[HIDDEN], b2[OUT];
+    std::uniform_int_distribution<int> weight(-127, 127), zero(-20, 20), value(-128, 127);
+    std::uniform_real_distribution<float> uniform(0.2f, 1.0f);
+
+    Quantization in = { uniform(rng) * 0.1f, zero(rng) };
+    for (int o = 0; o < HIDDEN; o++) {
+        s1[o] = uniform(rng) * 0.01f;
+        b1[o] = weight(rng) * 40;
+        for (int i = 0; i < IN; i++) w1[o][i] = (int8_t)weight(rng);
+    }
+    for (int o = 0; o < OUT; o++) {
+        s2[o] = uniform(rng) * 0.01f;
+        b2[o] = weight(rng) * 40;
+        for (int i = 0; i < HIDDEN; i++) w2[o][i] = (int8_t)weight(rng);
+    }
+    const DenseLayer layers[2] = {
+        { &w1[0][0], s1, b1, { uniform(rng) * 0.5f, -128 }, true },
+        { &w2[0][0], s2, b2, { uniform(rng) * 0.5f, zero(rng) }, false },
+    };
+    QuantizedMlp<IN, HIDDEN, OUT> net(in, layers, NO_BUDGET);
+
+    for (int t = 0; t < trials; t++) {
+        int8_t x[IN], fast[OUT], reference[OUT];
+        for (int i = 0; i < IN; i++) {
+            x[i] = (int8_t)value(rng);
+        }
+        net.run(x, fast);
+        net.runReference(x, reference);
+        for (int o = 0; o < OUT; o++) {
+            mismatches += fast[o] != reference[o];
+        }
+        outputs += OUT;
+    }
+}
+
+int main() {
+    std::mt19937 rng(7);
+
+    // Random networks
+    {
+        long outputs = 0, mismatches = 0;
+        for (int n = 0; n < 200; n++) {
+            randomShallowNetwork<16, 32, 8>(rng, 500, outputs, mismatches);
+            randomShallowNetwork<11, 11, 3>(rng, 500, outputs, mismatches);
+            randomNetwork<12, 24, 16, 4>(rng, 250, outputs, mismatches);
+        }
+        printf("random networks: %ld of %ld outputs differ from runReference()\n", mismatches, outputs);
+        check(mismatches == 0, "run() bit-exact with runReference(), random networks");
+    }
+
+    // The stress network on every kind of input, including the int8 extremes
+    {
+        StressNetwork network(STRESS_INPUT, STRESS_LAYERS, NO_BUDGET);
+        std::uniform_int_distribution<int> value(-128, 127);
+        long outputs = 0, mismatches = 0;
+        for (int t = 0; t < 200000; t++) {
+            int8_t x[StressNetwork::INPUTS], fast[StressNetwork::OUTPUTS], reference[StressNetwork::OUTPUTS];
+            for (int i = 0; i < StressNetwork::INPUTS; i++) {
+                x[i] = (int8_t)(t < 2 ? (t == 0 ? -128 : 127) : value(rng));
+            }
+            network.run(x, fast);
+            network.runReference(x, reference);
+            for (int o = 0; o < StressNetwork::OUTPUTS; o++) {
+                mismatches += fast[o] != reference[o];
+            }
+            outputs += StressNetwork::OUTPUTS;
+        }
+        printf("stress network: %ld of %ld logits differ from runReference()\n", mismatches, outputs);
+        check(mismatches == 0, "run() bit-exact with runReference(), stress network");
+    }
+
+    // The network classifier against the weighted sum it transcribes
+    const int FRAMES = 200000;
+    std::vector<EmotionModel::SensorData> frames(FRAMES);
+    EmotionModel weighted;
+    EmotionModel network;
+    network.setClassifier(EmotionModel::NETWORK);
+    {
+        std::uniform_real_distribution<float> uniform(0, 1);
+        auto sometimesMissing = [&](float v) { return uniform(rng) < 0.05f ? NAN : v; };
+        long agree = 0;
+        int confusion[4][4] = {};
+        for (EmotionModel::SensorData& d : frames) {
+            d = { sometimesMissing(60 + uniform(rng) * 80), sometimesMissing(uniform(rng) * 15),
+                  sometimesMissing(36 + uniform(rng) * 2.5f), sometimesMissing(400 + uniform(rng) * 2000),
+                  sometimesMissing(10 + uniform(rng) * 25), sometimesMissing(uniform(rng) * 4),
+                  sometimesMissing(uniform(rng) * 3), sometimesMissing(uniform(rng) * 3),
+                  sometimesMissing(40 + uniform(rng) * 60), sometimesMissing(5 + uniform(rng) * 60),
+                  NAN, NAN, sometimesMissing(uniform(rng) * 5), sometimesMissing(uniform(rng) * 12),
+                  sometimesMissing(uniform(rng) * 1.2f) };
+            int a = weighted.analyze(d);
+            int b = network.analyze(d);
+            agree += a == b;
+            confusion[a][b]++;
+        }
+        printf("\nweighted sum (rows) vs network (columns), %d frames:\n", FRAMES);
+        for (int a = 0; a < 4; a++) {
+            printf("  %8d %8d %8d %8d\n", confusion[a][0], confusion[a][1], confusion[a][2], confusion[a][3]);
+        }
+        double share = (double)agree / FRAMES;
+        printf("agreement %.2f%%; the rest sit within a quantization step of a cutoff\n", 100 * share);
+        check(share > 0.98, "network agrees with the weighted sum on > 98% of frames");
+        bool adjacent = true;
+        for (int a = 0; a < 4; a++) {
+            for (int b = 0; b < 4; b++) {
+                adjacent &= abs(a - b) <= 1 || confusion[a][b] == 0;
+            }
+        }
+        check(adjacent, "disagreements are one state apart");
+    }
+
+    // Cost: run() on int8 input, infer() with quantization, and the
+    // classifiers end to end, best of nine
+    {
+        StressNetwork timed(STRESS_INPUT, STRESS_LAYERS, NO_BUDGET);
+        int8_t x[StressNetwork::INPUTS] = { 3, -5, 40, 2, -100, 7, 9, 11, -3, 60, 1 };
+        float f[StressNetwork::INPUTS];
+        for (int i = 0; i < StressNetwork::INPUTS; i++) {
+            f[i] = x[i] * 0.03f;
+        }
+        int8_t out[StressNetwork::OUTPUTS];
+        const int N = 1000000;
+        int sink = 0;
+        double runNs = 1e30, inferNs = 1e30, networkNs = 1e30, weightedNs = 1e30;
+        for (int r = 0; r < 9; r++) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < N; i++) {
+                x[i % StressNetwork::INPUTS] ^= 1;
+                timed.run(x, out);
+                sink += out[0];
+            }
+            auto middle = std::chrono::steady_clock::now();
+            for (int i = 0; i < N; i++) {
+                f[i % StressNetwork::INPUTS] += 1e-3f;
+                timed.infer(f, out);
+                sink += out[0];
+            }
+            auto end = std::chrono::steady_clock::now();
+            runNs = std::min(runNs, std::chrono::duration<double, std::nano>(middle - start).count() / N);
+            inferNs = std::min(inferNs, std::chrono::duration<double, std::nano>(end - middle).count() / N);
+
+            start = std::chrono::steady_clock::now();
+            for (const EmotionModel::SensorData& d : frames) sink += network.analyze(d);
+            middle = std::chrono::steady_clock::now();
+            for (const EmotionModel::SensorData& d : frames) sink += weighted.analyze(d);
+            end = std::chrono::steady_clock::now();
+            networkNs = std::min(networkNs, std::chrono::duration<double, std::nano>(middle - start).count() / FRAMES);
+            weightedNs = std::min(weightedNs, std::chrono::duration<double, std::nano>(end - middle).count() / FRAMES);
+        }
+        printf("\nrun() %.1f ns, infer() %.1f ns, %d MACs per inference\n",
+               runNs, inferNs, StressNetwork::MAC_COUNT);
+        printf("analyze(): network %.1f ns/frame, weighted sum %.1f ns/frame (%d)\n",
+               networkNs, weightedNs, sink & 1);
+    }
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+// SpO2Estimator accuracy and signal-quality index on synthetic red/IR
+// traces, and its cost per sample.
+//
+//   g++ -std=gnu++17 -O2 -I test/host -I src -I . test/SpO2EstimatorBench.cpp src/sensors/SpO2Estimator.cpp -o /tmp/spo2_bench && /tmp/spo2_bench
+//
+// Each trace is 60 s at 100 Hz: a pulse with a dicrotic notch at 72 BPM
+// +-5%, 1% IR perfusion, 1% baseline wander at 0.1 Hz and Gaussian noise
+// on both channels. The red pulse is scaled by the R that Maxim's curve
+// maps to the target saturation, so the estimator should return the target.
+// Estimates after the first 10 s are scored, in 25-sample batches as the
+// MAX3010x FIFO delivers them. At the highest noise the SQI is expected to
+// hold back part of the estimates, so only their error is bounded there.
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "sensors/SpO2Estimator.h"
+#include "utils/CycleCounter.h"
+
+using Emopod::Sensors::SpO2Estimator;
+
+static const float SAMPLE_RATE = 100.0f;
+static const int TRACE_SECONDS = 60;
+static const int SETTLE_SECONDS = 10;
+static const int BATCH = 25;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    printf("%-56s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        failures++;
+    }
+}
+
+struct Trace {
+    std::vector<uint32_t> red;
+    std::vector<uint32_t> ir;
+};
+
+struct Result {
+    int estimates;          // batches ending with a valid estimate
+    int scored;             // batches after the settling time
+    double meanError;
+    float quality;
+    uint64_t cycles;
+};
+
+// Systolic peak and dicrotic wave, phase in [0, 1)
+static double pulse(double phase) {
+    return exp(-pow((phase - 0.2) / 0.08, 2)) + 0.35 * exp(-pow((phase - 0.45) / 0.07, 2));
+}
+
+// R for a target saturation, from the default calibration curve
+static double ratioFor(double target) {
+    const double a = -45.060, b = 30.354, c = 94.845 - target;
+    return (-b - sqrt(b * b - 4 * a * c)) / (2 * a);
+}
+
+static Trace makeTrace(double target, double noise, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> gaussian(0, 1);
+    const double dcIr = 120000, dcRed = 90000, perfusion = 0.01;
+    double ratio = ratioFor(target);
+    int count = (int)(SAMPLE_RATE * TRACE_SECONDS);
+    Trace trace;
+    trace.red.resize(count);
+    trace.ir.resize(count);
+    double phase = 0;
+    for (int i = 0; i < count; i++) {
+        double t = i / SAMPLE_RATE;
+        phase += 1.2 * (1 + 0.05 * sin(2 * M_PI * 0.25 * t)) / SAMPLE_RATE;
+        double p = pulse(phase - floor(phase));
+        double wander = 1 + 0.01 * sin(2 * M_PI * 0.1 * t);
+        trace.ir[i] = (uint32_t)(dcIr * wander * (1 - perfusion * p) + noise * gaussian(rng));
+        trace.red[i] = (uint32_t)(dcRed * wander * (1 - perfusion * ratio * p) + noise * gaussian(rng));
+    }
+    return trace;
+}
+
+static Result score(const Trace& trace, double target) {
+    SpO2Estimator estimator(SAMPLE_RATE);
+    Result result = { 0, 0, 0, 0, 0 };
+    double errorSum = 0;
+    int count = (int)trace.ir.size();
+    for (int i = 0; i < count; i += BATCH) {
+        uint32_t start = Emopod::Utils::cycleCount();
+        estimator.processBatch(&trace.red[i], &trace.ir[i], BATCH);
+        result.cycles += Emopod::Utils::cycleCount() - start;
+        if (i >= SETTLE_SECONDS * SAMPLE_RATE) {
+            result.scored++;
+            if (estimator.isValid()) {
+                errorSum += fabs(estimator.getSpO2() - target);
+                result.estimates++;
+            }
+        }
+    }
+    result.meanError = result.estimates > 0 ? errorSum / result.estimates : NAN;
+    result.quality = estimator.getQuality();
+    return result;
+}
+
+int main() {
+    const double targets[] = { 98, 95, 90, 85, 80 };
+    // Noise in counts; the MAE bound for each level
+    const double noises[] = { 0, 20, 80 };
+    const double maxError[] = { 0.2, 0.6, 1.5 };
+
+    uint64_t cycles = 0;
+    long samples = 0;
+    double worstError[3] = {};
+    float lowestQuality[3] = { 1, 1, 1 };
+    int fewestEstimates[3] = { 1 << 30, 1 << 30, 1 << 30 }, scored = 0;
+    uint32_t seed = 1;
+
+    printf("%6s %6s %10s %8s %6s\n", "SpO2", "noise", "estimates", "MAE", "SQI");
+    for (double target : targets) {
+        for (int n = 0; n < 3; n++) {
+            Trace trace = makeTrace(target, noises[n], seed++);
+            Result result = score(trace, target);
+            printf("%6.0f %6.0f %6d/%-3d %8.2f %6.2f\n", target, noises[n], result.estimates,
+                   result.scored, result.meanError, result.quality);
+            worstError[n] = std::max(worstError[n], isnan(result.meanError) ? INFINITY : result.meanError);
+            lowestQuality[n] = std::min(lowestQuality[n], result.quality);
+            fewestEstimates[n] = std::min(fewestEstimates[n], result.estimates);
+            scored = result.scored;
+            cycles += result.cycles;
+            samples += (long)trace.ir.size();
+        }
+    }
+    printf("\n");
+    check(worstError[0] < maxError[0], "MAE < 0.2 points without noise");
+    check(worstError[1] < maxError[1], "MAE < 0.6 points at 20 counts of noise");
+    check(worstError[2] < maxError[2], "MAE < 1.5 points at 80 counts of noise");
+    check(fewestEstimates[1] * 10 >= scored * 9, "valid in >= 90% of batches after 10 s, 20 counts");
+    check(fewestEstimates[2] > 0, "still some valid estimates at 80 counts");
+    check(lowestQuality[0] >= 0.8f, "SQI >= 0.8 on clean traces");
+    check(lowestQuality[2] < lowestQuality[0], "SQI falls as noise rises");
+
+    // No finger: a dark, flat IR level
+    {
+        SpO2Estimator estimator(SAMPLE_RATE);
+        std::vector<uint32_t> dark(500, 1000);
+        estimator.processBatch(dark.data(), dark.data(), (int)dark.size());
+        check(!estimator.isValid() && estimator.getQuality() == 0 && isnan(estimator.getSpO2()),
+              "no finger: SQI 0, no estimate");
+    }
+
+    // A clipping red channel zeroes the quality of every cycle it touches
+    {
+        Trace trace = makeTrace(95, 20, 99);
+        std::fill(trace.red.begin() + 3000, trace.red.end(), 262143u);
+        SpO2Estimator estimator(SAMPLE_RATE);
+        estimator.processBatch(trace.red.data(), trace.ir.data(), (int)trace.ir.size());
+        check(estimator.getQuality() == 0 && !estimator.isValid(), "clipped channel: SQI 0, no estimate");
+    }
+
+    printf("\n%.1f cycles per sample, %zu bytes of state\n", (double)cycles / samples, sizeof(SpO2Estimator));
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
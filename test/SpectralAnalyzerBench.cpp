@@ -0,0 +1,140 @@
+// SpectralAnalyzer cost per frame and memory, with sanity checks on its
+// features and on FixedFft against a double-precision DFT.
+//
+//   g++ -std=gnu++17 -O2 -I test/host -I src -I . test/SpectralAnalyzerBench.cpp src/sensors/SpectralAnalyzer.cpp -o /tmp/spectral_bench && /tmp/spectral_bench
+//
+// Cycles come from Utils::cycleCount() (the TSC on x86), the same counter
+// the analyzer's Stats use on target, so the figures compare directly with
+// getStats() read from the device.
+
+#include <stdio.h>
+#include <math.h>
+#include <complex>
+#include <chrono>
+#include "sensors/SpectralAnalyzer.h"
+
+using Emopod::Sensors::SpectralAnalyzer;
+
+static const float SAMPLE_RATE = 8000.0f;
+static const int BLOCK = 64;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    printf("%-52s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        failures++;
+    }
+}
+
+// Six-harmonic voice-like source with a 150 Hz fundamental wobbling by 30 Hz
+struct VoiceSource {
+    long n = 0;
+    double phase = 0;
+
+    void fill(uint16_t* block) {
+        for (int i = 0; i < BLOCK; i++, n++) {
+            double t = n / (double)SAMPLE_RATE;
+            double f0 = 150 + 30 * sin(2 * M_PI * 0.5 * t);
+            phase += 2 * M_PI * f0 / SAMPLE_RATE;
+            double v = 0;
+            for (int h = 1; h <= 6; h++) {
+                v += sin(h * phase) / h;
+            }
+            block[i] = (uint16_t)lround(2048 + 400 * v + ((n * 7919) % 21 - 10));
+        }
+    }
+};
+
+// Largest error of the Q15 FFT against a double DFT of the same input, in
+// units of the 1/N-scaled output
+static double fftError() {
+    const int N = SpectralAnalyzer::FRAME_SIZE;
+    static Emopod::Utils::FixedFft<N> fft;
+    alignas(16) int16_t data[2 * N];
+    std::complex<double> input[N];
+    for (int k = 0; k < N; k++) {
+        double re = 12000 * sin(2 * M_PI * 13 * k / N) + 6000 * cos(2 * M_PI * 70 * k / N) + ((k * 7919) % 401 - 200);
+        input[k] = std::complex<double>(lround(re), 0);
+        data[2 * k] = (int16_t)lround(re);
+        data[2 * k + 1] = 0;
+    }
+    fft.transform(data);
+    double worst = 0;
+    for (int f = 0; f < N; f++) {
+        std::complex<double> sum = 0;
+        for (int k = 0; k < N; k++) {
+            sum += input[k] * std::polar(1.0, -2 * M_PI * f * k / N);
+        }
+        sum /= N;
+        worst = fmax(worst, fabs(sum.real() - data[2 * f]));
+        worst = fmax(worst, fabs(sum.imag() - data[2 * f + 1]));
+    }
+    return worst;
+}
+
+int main() {
+    uint16_t block[BLOCK];
+
+    // Cost: ten seconds of voice at hop 128 (62.5 frames/s)
+    static SpectralAnalyzer analyzer;
+    analyzer.configure(SAMPLE_RATE, SpectralAnalyzer::FRAME_SIZE / 2);
+    VoiceSource voice;
+    double analyzeNs = 0;
+    for (int b = 0; b < (int)(SAMPLE_RATE * 10) / BLOCK; b++) {
+        voice.fill(block);
+        auto start = std::chrono::steady_clock::now();
+        analyzer.processBlock(block, BLOCK);
+        analyzeNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    const SpectralAnalyzer::Stats& stats = analyzer.getStats();
+    const SpectralAnalyzer::Features& features = analyzer.getFeatures();
+    printf("frames %u: %.0f cycles/frame mean, %u max, %.0f ns/frame incl. buffering\n",
+           (unsigned)stats.frames, (double)stats.totalCycles / stats.frames,
+           (unsigned)stats.maxFrameCycles, analyzeNs / stats.frames);
+    printf("memory %d bytes per analyzer, alignof %zu\n", SpectralAnalyzer::memoryBytes(),
+           alignof(SpectralAnalyzer));
+    printf("voice: bands %.1f %.1f %.1f %.1f dBFS, centroid %.0f Hz, pitch %.1f Hz, "
+           "variability %.1f Hz, voiced %.2f\n\n",
+           features.bandDb[0], features.bandDb[1], features.bandDb[2], features.bandDb[3],
+           features.centroidHz, features.pitchHz, features.pitchVariability, features.voicedRatio);
+
+    check(alignof(SpectralAnalyzer) >= 16, "frame buffer is 16-byte aligned");
+    check(stats.frames == (unsigned)(SAMPLE_RATE * 10 / 128) - 1, "one frame per hop once the window is full");
+    check(features.pitchHz >= 110 && features.pitchHz <= 190, "voice pitch within 10 Hz of the 120-180 Hz sweep");
+    check(features.voicedRatio > 0.9f, "voice is voiced");
+    check(features.pitchVariability > 5 && features.pitchVariability < 40, "pitch variability reflects the wobble");
+
+    // A 1 kHz tone lands in the formant band with its centroid on the tone
+    SpectralAnalyzer tone;
+    long n = 0;
+    for (int b = 0; b < 100; b++) {
+        for (int i = 0; i < BLOCK; i++, n++) {
+            block[i] = (uint16_t)lround(2048 + 2000 * sin(2 * M_PI * 1000 * n / SAMPLE_RATE));
+        }
+        tone.processBlock(block, BLOCK);
+    }
+    const SpectralAnalyzer::Features& toneFeatures = tone.getFeatures();
+    check(fabsf(toneFeatures.centroidHz - 1000) < 50, "1 kHz tone centroid within 50 Hz");
+    check(toneFeatures.bandDb[2] > toneFeatures.bandDb[0] + 20 &&
+          toneFeatures.bandDb[2] > toneFeatures.bandDb[3] + 20, "1 kHz tone energy in the 1-2.5 kHz band");
+    check(isnan(toneFeatures.pitchHz), "1 kHz tone has no pitch in 80-400 Hz");
+
+    // Silence: no pitch, nothing voiced
+    SpectralAnalyzer silence;
+    for (int i = 0; i < BLOCK; i++) {
+        block[i] = 2048;
+    }
+    for (int b = 0; b < 20; b++) {
+        silence.processBlock(block, BLOCK);
+    }
+    check(isnan(silence.getFeatures().pitchHz) && silence.getFeatures().voicedRatio == 0,
+          "silence is unvoiced");
+
+    double error = fftError();
+    printf("FixedFft<%d> worst error vs double DFT: %.2f LSB\n", SpectralAnalyzer::FRAME_SIZE, error);
+    check(error <= 8, "FixedFft within 8 LSB of the scaled DFT");
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
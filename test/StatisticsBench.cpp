@@ -0,0 +1,277 @@
+// utils/Statistics.h: correctness against exact window recomputation,
+// accumulated drift of the running mean, and cost per sample against the
+// loops it replaced.
+//
+//   g++ -std=gnu++17 -O2 -I src -I . test/StatisticsBench.cpp -o /tmp/statistics_bench && /tmp/statistics_bench
+//
+// PreviousMovingAverage is the running-sum average that utils/MovingAverage.h
+// held before the library: it never re-sums, so float rounding accumulates.
+// The "loop" columns are the per-sample re-scans the drivers used to do.
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "utils/Statistics.h"
+
+template <size_t N>
+class PreviousMovingAverage {
+private:
+    float values[N];
+    size_t index;
+    float sum;
+    bool isFull;
+
+public:
+    PreviousMovingAverage() : values(), index(0), sum(0), isFull(false) {}
+
+    float addValue(float value) {
+        if (isnan(value)) {
+            return getAverage();
+        }
+        sum -= values[index];
+        values[index] = value;
+        sum += value;
+        index = (index + 1) % N;
+        if (index == 0) {
+            isFull = true;
+        }
+        return getAverage();
+    }
+
+    float getAverage() const {
+        if (isFull) {
+            return sum / N;
+        }
+        return index > 0 ? sum / index : 0;
+    }
+};
+
+static volatile float sink;
+
+template <typename Body>
+static double nsPerSample(Body body, size_t count) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+}
+
+template <size_t N>
+static void benchmark(const std::vector<float>& x) {
+    size_t n = x.size();
+    double mean = nsPerSample([&] {
+        MovingAverage<N> m;
+        float s = 0;
+        for (float v : x) s += m.addValue(v);
+        sink = s;
+    }, n);
+    double previousMean = nsPerSample([&] {
+        PreviousMovingAverage<N> m;
+        float s = 0;
+        for (float v : x) s += m.addValue(v);
+        sink = s;
+    }, n);
+    double meanLoop = nsPerSample([&] {
+        float buffer[N] = {};
+        size_t index = 0, count = 0;
+        float s = 0;
+        for (float v : x) {
+            buffer[index] = v;
+            index = (index + 1) % N;
+            count = std::min(count + 1, N);
+            float sum = 0;
+            for (size_t i = 0; i < count; i++) sum += buffer[i];
+            s += sum / count;
+        }
+        sink = s;
+    }, n);
+    double variance = nsPerSample([&] {
+        MovingStats<N> m;
+        float s = 0;
+        for (float v : x) {
+            m.addValue(v);
+            s += m.getVariance();
+        }
+        sink = s;
+    }, n);
+    double varianceLoop = nsPerSample([&] {
+        float buffer[N] = {};
+        size_t index = 0, count = 0;
+        float s = 0;
+        for (float v : x) {
+            buffer[index] = v;
+            index = (index + 1) % N;
+            count = std::min(count + 1, N);
+            float sum = 0;
+            for (size_t i = 0; i < count; i++) sum += buffer[i];
+            float mu = sum / count, q = 0;
+            for (size_t i = 0; i < count; i++) q += (buffer[i] - mu) * (buffer[i] - mu);
+            s += count > 1 ? q / (count - 1) : 0;
+        }
+        sink = s;
+    }, n);
+    double minMax = nsPerSample([&] {
+        SlidingMinMax<N> m;
+        float s = 0;
+        for (float v : x) {
+            m.addValue(v);
+            s += m.getRange();
+        }
+        sink = s;
+    }, n);
+    double minMaxScan = nsPerSample([&] {
+        float buffer[N] = {};
+        size_t index = 0, count = 0;
+        float s = 0;
+        for (float v : x) {
+            buffer[index] = v;
+            index = (index + 1) % N;
+            count = std::min(count + 1, N);
+            float low = buffer[0], high = buffer[0];
+            for (size_t i = 1; i < count; i++) {
+                low = std::min(low, buffer[i]);
+                high = std::max(high, buffer[i]);
+            }
+            s += high - low;
+        }
+        sink = s;
+    }, n);
+    double median = nsPerSample([&] {
+        SlidingMedian<N> m;
+        float s = 0;
+        for (float v : x) {
+            m.addValue(v);
+            s += m.getMedian();
+        }
+        sink = s;
+    }, n);
+    double medianSelect = nsPerSample([&] {
+        float buffer[N] = {}, scratch[N];
+        size_t index = 0, count = 0;
+        float s = 0;
+        for (float v : x) {
+            buffer[index] = v;
+            index = (index + 1) % N;
+            count = std::min(count + 1, N);
+            std::copy(buffer, buffer + count, scratch);
+            std::nth_element(scratch, scratch + count / 2, scratch + count);
+            s += scratch[count / 2];
+        }
+        sink = s;
+    }, n);
+    printf("%5zu %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f\n", N, mean, previousMean,
+           meanLoop, variance, varianceLoop, minMax, minMaxScan, median, medianSelect);
+}
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    printf("%-52s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        failures++;
+    }
+}
+
+int main() {
+    std::mt19937 rng(1);
+    std::normal_distribution<float> gaussian(0, 1);
+
+    // Every window against an exact double recomputation, on data with outliers
+    {
+        const size_t N = 31;
+        std::vector<float> x(20000);
+        for (float& v : x) {
+            v = 1000 + gaussian(rng) * (rng() % 7 == 0 ? 4 : 1);
+        }
+        MovingAverage<N> average;
+        MovingStats<N> stats;
+        SlidingMinMax<N> minMax;
+        SlidingMedian<N> median;
+        double meanError = 0, varianceError = 0, minMaxError = 0, medianError = 0;
+        for (size_t i = 0; i < x.size(); i++) {
+            average.addValue(x[i]);
+            stats.addValue(x[i]);
+            minMax.addValue(x[i]);
+            median.addValue(x[i]);
+
+            size_t count = std::min(i + 1, N);
+            std::vector<double> window(x.begin() + (i + 1 - count), x.begin() + (i + 1));
+            double mu = 0;
+            for (double v : window) mu += v;
+            mu /= count;
+            double q = 0;
+            for (double v : window) q += (v - mu) * (v - mu);
+            double var = count > 1 ? q / (count - 1) : 0;
+            std::sort(window.begin(), window.end());
+            double mid = count % 2 ? window[count / 2] : (window[count / 2 - 1] + window[count / 2]) / 2;
+
+            meanError = std::max(meanError, fabs(average.getAverage() - mu));
+            varianceError = std::max(varianceError, fabs(stats.getVariance() - var) / std::max(var, 1e-9));
+            minMaxError = std::max(minMaxError, fabs(minMax.getMin() - window.front()) +
+                                                fabs(minMax.getMax() - window.back()));
+            medianError = std::max(medianError, fabs(median.getMedian() - mid));
+        }
+        printf("worst error, N=31: mean %.2e, variance %.2e (relative), min/max %.2e, median %.2e\n",
+               meanError, varianceError, minMaxError, medianError);
+        check(meanError < 1e-3, "moving mean within 1e-3 of exact");
+        check(varianceError < 1e-2, "moving variance within 1% of exact");
+        check(minMaxError == 0, "sliding min/max exact");
+        check(medianError < 1e-4, "sliding median exact up to float rounding");
+    }
+
+    // Integer medians, as HrvAnalyzer keeps intervals in us
+    {
+        SlidingMedian<5, uint32_t> median;
+        const uint32_t intervals[] = { 800000, 810000, 790000, 1200000, 805000, 800000 };
+        for (uint32_t v : intervals) {
+            median.addValue(v);
+        }
+        check(median.getMedian() == 805000, "uint32_t median ignores the ectopic interval");
+    }
+
+    // Drift: 1e7 samples around 1000, N=64
+    {
+        const size_t N = 64;
+        std::vector<float> x(10000000);
+        for (float& v : x) {
+            v = 1000.0f + 100 * gaussian(rng);
+        }
+        PreviousMovingAverage<N> previous;
+        MovingAverage<N> current;
+        for (float v : x) {
+            previous.addValue(v);
+            current.addValue(v);
+        }
+        double exact = 0;
+        for (size_t i = x.size() - N; i < x.size(); i++) {
+            exact += x[i];
+        }
+        exact /= N;
+        double previousDrift = fabs(previous.getAverage() - exact);
+        double currentDrift = fabs(current.getAverage() - exact);
+        printf("drift after 1e7 samples, N=64: running sum %.2e, re-summed on wrap %.2e\n",
+               previousDrift, currentDrift);
+        check(currentDrift < 1e-4, "re-summed mean does not drift");
+    }
+
+    printf("\nns per sample\n%5s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n", "N", "mean", "prev",
+           "re-sum", "var", "var loop", "minmax", "scan", "median", "nth_elem");
+    std::vector<float> x(2000000);
+    for (float& v : x) {
+        v = gaussian(rng);
+    }
+    benchmark<5>(x);
+    benchmark<10>(x);
+    benchmark<32>(x);
+    benchmark<64>(x);
+    benchmark<256>(x);
+    printf("sizes: MovingAverage<10> %zu, MovingStats<32> %zu, SlidingMinMax<32> %zu, "
+           "SlidingMedian<31> %zu, Ewma %zu\n",
+           sizeof(MovingAverage<10>), sizeof(MovingStats<32>), sizeof(SlidingMinMax<32>),
+           sizeof(SlidingMedian<31>), sizeof(Ewma));
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+// Host stress test for TaskPipeline and SpscQueue under std::thread.
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc -I. test/TaskPipelineStress.cpp -o /tmp/pipeline_stress && /tmp/pipeline_stress
+//
+// Each scenario runs the producer flat out against a consumer of a given
+// speed and checks that every frame arrives intact, in order, at most once,
+// and that produced == consumed + dropped + left in the queue, and that the
+// share of frames dropped is what the consumer's speed implies: a consumer
+// woken by the producer's notification keeps up, a stalled one sheds most of
+// the load. Build it with -fsanitize=thread as well to check the queue's
+// memory ordering.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "utils/TaskPipeline.h"
+
+using Emopod::Utils::TaskPipeline;
+
+struct Frame {
+    uint32_t sequence;
+    uint32_t payload[15];      // filled from sequence so a torn copy shows
+};
+
+static const int DEPTH = 64;
+
+struct Scenario {
+    const char* name;
+    unsigned long producerPeriodMs;
+    int consumerSpinUs;        // work per consumed frame
+    int runMs;
+    float minDropShare;        // of frames produced
+    float maxDropShare;
+};
+
+struct Context {
+    uint32_t nextSequence;             // producer only
+    uint32_t lastSeen;                 // consumer only
+    bool seenAny;
+    uint32_t gaps;                     // frames skipped between consecutive pops;
+                                       // drops after the last pop are not gaps
+    uint32_t outOfOrder;
+    uint32_t torn;
+    std::atomic<uint32_t> idleCalls;
+    int consumerSpinUs;
+};
+
+static uint32_t mix(uint32_t sequence, int i) {
+    return sequence * 2654435761u + (uint32_t)i;
+}
+
+static bool produce(Frame& frame, void* context) {
+    Context* ctx = static_cast<Context*>(context);
+    frame.sequence = ctx->nextSequence++;
+    for (int i = 0; i < 15; i++) {
+        frame.payload[i] = mix(frame.sequence, i);
+    }
+    return true;
+}
+
+static void consume(const Frame& frame, void* context) {
+    Context* ctx = static_cast<Context*>(context);
+    for (int i = 0; i < 15; i++) {
+        if (frame.payload[i] != mix(frame.sequence, i)) {
+            ctx->torn++;
+            break;
+        }
+    }
+    if (ctx->seenAny) {
+        if (frame.sequence <= ctx->lastSeen) {
+            ctx->outOfOrder++;
+        } else {
+            ctx->gaps += frame.sequence - ctx->lastSeen - 1;
+        }
+    }
+    ctx->lastSeen = frame.sequence;
+    ctx->seenAny = true;
+
+    if (ctx->consumerSpinUs > 0) {
+        auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(ctx->consumerSpinUs);
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }
+}
+
+static void idle(void* context) {
+    static_cast<Context*>(context)->idleCalls++;
+}
+
+static bool runScenario(const Scenario& scenario) {
+    Context ctx;
+    ctx.nextSequence = 0;
+    ctx.lastSeen = 0;
+    ctx.seenAny = false;
+    ctx.gaps = 0;
+    ctx.outOfOrder = 0;
+    ctx.torn = 0;
+    ctx.idleCalls = 0;
+    ctx.consumerSpinUs = scenario.consumerSpinUs;
+
+    TaskPipeline<Frame, DEPTH> pipeline;
+    TaskPipeline<Frame, DEPTH>::Config config;
+    config.producerPeriodMs = scenario.producerPeriodMs;
+    // Long enough that only the producer's notification wakes the consumer
+    // in time to keep up
+    config.consumerWaitMs = 100;
+
+    if (!pipeline.begin(produce, consume, idle, &ctx, config)) {
+        printf("%-22s FAIL begin()\n", scenario.name);
+        return false;
+    }
+    // A second begin() while running must be refused
+    bool doubleBegin = pipeline.begin(produce, consume, idle, &ctx, config);
+    std::this_thread::sleep_for(std::chrono::milliseconds(scenario.runMs));
+    pipeline.stop();
+
+    TaskPipeline<Frame, DEPTH>::Stats stats = pipeline.getStats();
+    uint32_t accounted = stats.consumed + stats.dropped + (uint32_t)stats.depth;
+    float dropShare = stats.produced > 0 ? (float)stats.dropped / stats.produced : 0;
+    bool ok = !doubleBegin && !pipeline.isRunning() &&
+              stats.produced == ctx.nextSequence &&
+              accounted == stats.produced &&
+              ctx.gaps <= stats.dropped &&
+              ctx.outOfOrder == 0 && ctx.torn == 0 &&
+              stats.maxDepth <= DEPTH && ctx.idleCalls.load() > 0 &&
+              dropShare >= scenario.minDropShare && dropShare <= scenario.maxDropShare;
+
+    printf("%-22s %s produced=%u consumed=%u dropped=%u (%.1f%%) left=%d maxDepth=%d idle=%u\n",
+           scenario.name, ok ? "ok  " : "FAIL", (unsigned)stats.produced,
+           (unsigned)stats.consumed, (unsigned)stats.dropped, 100 * dropShare, stats.depth,
+           stats.maxDepth, (unsigned)ctx.idleCalls.load());
+    if (!ok) {
+        printf("    gaps=%u outOfOrder=%u torn=%u doubleBegin=%d\n", (unsigned)ctx.gaps,
+               (unsigned)ctx.outOfOrder, (unsigned)ctx.torn, doubleBegin);
+    }
+    return ok;
+}
+
+int main() {
+    // Logger output from begin() would interleave with the results
+    Emopod::Utils::Logger::setModuleLevel(Emopod::Utils::LogModules::PIPELINE, LOG_LEVEL_NONE);
+
+    const Scenario scenarios[] = {
+        // How much a 50 us consumer drops depends on how many cores the
+        // producer gets to itself, so only the ends are bounded
+        { "fast consumer",     0,    0, 500, 0.0f,  0.01f },
+        { "paced producer",    1,    0, 300, 0.0f,  0.0f },
+        { "slow consumer",     0,   50, 500, 0.0f,  1.0f },
+        { "stalled consumer",  0, 2000, 300, 0.25f, 1.0f },
+    };
+
+    int failures = 0;
+    for (const Scenario& scenario : scenarios) {
+        if (!runScenario(scenario)) {
+            failures++;
+        }
+    }
+
+    // Restart after stop() on the same object
+    TaskPipeline<Frame, DEPTH> pipeline;
+    Context ctx = {};
+    bool restarted = true;
+    for (int round = 0; round < 20 && restarted; round++) {
+        restarted = pipeline.begin(produce, consume, nullptr, &ctx);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        pipeline.stop();
+    }
+    printf("%-22s %s\n", "restart x20", restarted ? "ok" : "FAIL");
+    if (!restarted) {
+        failures++;
+    }
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+// sensors/TimeAligner.h: HOLD and LINEAR lookups, maxAge staleness, the
+// minimum spacing that keeps history for fast channels, and millis() wrap.
+//
+//   g++ -std=gnu++17 -O2 -I test/host -I src -I . test/TimeAlignerTest.cpp -o /tmp/time_aligner_test && /tmp/time_aligner_test
+//
+// The last case replays SensorManager's breathing field: a rate that only
+// changes on a breath, read ALIGNMENT_DELAY in the past, must stay current
+// through the longest breath the estimator accepts.
+
+#include <stdio.h>
+#include <math.h>
+#include "sensors/TimeAligner.h"
+#include "sensors/BreathingEstimator.h"
+
+using namespace Emopod::Sensors;
+
+typedef TimeAligner<2, 4> Aligner;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    printf("%-56s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        failures++;
+    }
+}
+
+static bool near(float a, float b) {
+    return fabsf(a - b) < 1e-4f;
+}
+
+int main() {
+    // HOLD and LINEAR on the same samples
+    {
+        Aligner aligner;
+        aligner.configureChannel(0, Aligner::HOLD, 1000);
+        aligner.configureChannel(1, Aligner::LINEAR, 1000);
+        for (int c = 0; c < 2; c++) {
+            aligner.addSample(c, 100, 10);
+            aligner.addSample(c, 200, 20);
+            aligner.addSample(c, 300, 40);
+        }
+        check(near(aligner.valueAt(0, 150), 10) && near(aligner.valueAt(0, 299), 20),
+              "HOLD returns the latest sample at or before t");
+        check(near(aligner.valueAt(1, 150), 15) && near(aligner.valueAt(1, 275), 35),
+              "LINEAR interpolates between the samples around t");
+        check(near(aligner.valueAt(1, 200), 20), "LINEAR on a sample time returns the sample");
+        check(near(aligner.valueAt(0, 500), 40) && near(aligner.valueAt(1, 500), 40),
+              "past the newest sample both hold, no extrapolation");
+        uint32_t age;
+        check(isnan(aligner.valueAt(1, 50, age)) && age == Aligner::NO_SAMPLE,
+              "before the first sample: NAN, age NO_SAMPLE");
+    }
+
+    // maxAge: stale channels read NAN, the age is still reported
+    {
+        Aligner aligner;
+        aligner.configureChannel(0, Aligner::HOLD, 500);
+        aligner.configureChannel(1, Aligner::LINEAR, 500);
+        aligner.addSample(0, 1000, 1);
+        aligner.addSample(1, 1000, 1);
+        aligner.addSample(1, 2000, 3);
+        uint32_t age;
+        check(near(aligner.valueAt(0, 1500, age), 1) && age == 500, "fresh at exactly maxAge");
+        check(isnan(aligner.valueAt(0, 1501, age)) && age == 501, "stale one ms past maxAge, age reported");
+        // The sample before t is 1000 ms old although the one after is close
+        check(isnan(aligner.valueAt(1, 1900)), "LINEAR goes stale on the sample before t");
+        check(near(aligner.valueAt(1, 2100), 3), "a newer sample makes the channel fresh again");
+        aligner.addSample(0, 3000, NAN);
+        check(isnan(aligner.valueAt(0, 3000)), "a NAN sample reads as unknown");
+    }
+
+    // Out-of-order and repeated times
+    {
+        Aligner aligner;
+        aligner.configureChannel(0, Aligner::HOLD, 1000);
+        aligner.addSample(0, 100, 1);
+        aligner.addSample(0, 50, 2);
+        aligner.addSample(0, 100, 3);
+        check(near(aligner.valueAt(0, 100), 3), "older samples ignored, same time replaces");
+    }
+
+    // Spacing: a channel updated every ms still reaches back (DEPTH - 2) * spacing
+    {
+        Aligner aligner(100);
+        aligner.configureChannel(0, Aligner::LINEAR, 1000);
+        for (uint32_t t = 0; t <= 1000; t++) {
+            aligner.addSample(0, t, (float)t);
+        }
+        float back = aligner.valueAt(0, 800);
+        check(!isnan(back) && fabsf(back - 800) <= 100, "fast channel keeps history back 2 * spacing");
+        check(near(aligner.valueAt(0, 1000), 1000), "newest slot tracks the latest sample");
+    }
+
+    // millis() wrap between samples
+    {
+        Aligner aligner;
+        aligner.configureChannel(0, Aligner::LINEAR, 1000);
+        aligner.addSample(0, 0xFFFFFF00u, 0);
+        aligner.addSample(0, 0x00000100u, 512);
+        check(near(aligner.valueAt(0, 0), 256), "interpolates across the millis() wrap");
+    }
+
+    // Breathing as SensorManager aligns it: one sample per breath, read 2 s back
+    {
+        const uint32_t delay = 2000;
+        const uint32_t interval = (uint32_t)(BreathingEstimator::getMaxInterval() * 1000);
+        const uint32_t maxAge = interval + delay + 3000;
+        Aligner aligner(delay / 2);
+        aligner.configureChannel(0, Aligner::LINEAR, maxAge);
+        bool current = true;
+        uint32_t now = 0;
+        for (int breath = 0; breath < 10; breath++) {
+            aligner.addSample(0, now, 6.0f);
+            for (uint32_t t = now + 100; t < now + interval; t += 100) {
+                if (t >= 2 * interval) {
+                    current &= !isnan(aligner.valueAt(0, t - delay));
+                }
+            }
+            now += interval;
+        }
+        printf("breathing maxAge %u ms for breaths %u ms apart\n", (unsigned)maxAge, (unsigned)interval);
+        check(current, "6 BPM breathing never reads stale");
+    }
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Minimal stand-in for the Arduino core so the hardware-independent headers
+// under src/ (estimators, filters, models) build into the host harnesses in
+// test/. Timing comes from steady_clock; Serial prints to stdout. Drivers
+// that talk to devices are not meant to build against this.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using std::isnan;
+using std::isinf;
+using std::min;
+using std::max;
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define IRAM_ATTR
+
+inline unsigned long micros() {
+    using namespace std::chrono;
+    return (unsigned long)duration_cast<microseconds>(
+        steady_clock::now().time_since_epoch()).count();
+}
+
+inline unsigned long millis() {
+    return micros() / 1000;
+}
+
+struct HostSerial {
+    int printf(const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        int length = vprintf(format, args);
+        va_end(args);
+        return length;
+    }
+    void print(const char* text) { fputs(text, stdout); }
+    void println(const char* text = "") { puts(text); }
+};
+
+inline HostSerial Serial;
+
+#endif
@@ -0,0 +1,393 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Streaming statistics, header-only and sized at compile time
+ *
+ *   MovingAverage<N>      mean of the last N values, O(1)
+ *   MovingStats<N>        mean and sample variance of the last N values, O(1)
+ *   SlidingMinMax<N, T>   min and max of the last N values, O(1) amortized
+ *                         (monotonic deques)
+ *   SlidingMedian<N, T>   median of the last N values; the window is kept
+ *                         sorted, O(log N) search plus an O(N) shift, so
+ *                         meant for small N
+ *   Ewma                  exponentially weighted mean
+ *   RunningStats          Welford mean/variance over everything seen
+ *
+ * A running float sum drifts as values enter and leave it; the windowed
+ * sums are recomputed exactly each time their buffer wraps, one extra
+ * pass per N samples. NAN inputs are ignored throughout.
+ */
+
+template <size_t N>
+class MovingAverage {
+private:
+    float values[N];
+    size_t index;
+    size_t count;
+    float sum;
+
+public:
+    MovingAverage() { reset(); }
+
+    float addValue(float value) {
+        if (isnan(value)) {
+            return getAverage();
+        }
+
+        if (count == N) {
+            sum -= values[index];
+        } else {
+            count++;
+        }
+        values[index] = value;
+        sum += value;
+
+        if (++index == N) {
+            index = 0;
+            sum = 0;
+            for (size_t i = 0; i < N; i++) {
+                sum += values[i];
+            }
+        }
+        return getAverage();
+    }
+
+    // 0 before the first value
+    float getAverage() const {
+        return count > 0 ? sum / count : 0;
+    }
+
+    size_t getCount() const { return count; }
+    bool isBufferFull() const { return count == N; }
+
+    void reset() {
+        index = 0;
+        count = 0;
+        sum = 0;
+        for (size_t i = 0; i < N; i++) {
+            values[i] = 0;
+        }
+    }
+};
+
+template <size_t N>
+class MovingStats {
+private:
+    float values[N];
+    size_t index;
+    size_t count;
+    float mean;
+    float m2;       // sum of squared deviations from the mean
+
+    void recompute() {
+        float sum = 0;
+        for (size_t i = 0; i < count; i++) {
+            sum += values[i];
+        }
+        mean = sum / count;
+        m2 = 0;
+        for (size_t i = 0; i < count; i++) {
+            float d = values[i] - mean;
+            m2 += d * d;
+        }
+    }
+
+public:
+    MovingStats() { reset(); }
+
+    void addValue(float value) {
+        if (isnan(value)) {
+            return;
+        }
+
+        if (count < N) {
+            // Welford while filling
+            count++;
+            float delta = value - mean;
+            mean += delta / count;
+            m2 += delta * (value - mean);
+        } else {
+            // Replace the oldest value in place
+            float old = values[index];
+            float newMean = mean + (value - old) / N;
+            m2 += (value - old) * (value - newMean + old - mean);
+            mean = newMean;
+            if (m2 < 0) {
+                m2 = 0;
+            }
+        }
+        values[index] = value;
+
+        if (++index == N) {
+            index = 0;
+            recompute();
+        }
+    }
+
+    // NAN before the first value
+    float getMean() const { return count > 0 ? mean : NAN; }
+
+    // Sample variance (n - 1); 0 below two values
+    float getVariance() const { return count > 1 ? m2 / (count - 1) : 0; }
+    float getStdDev() const { return sqrtf(getVariance()); }
+
+    size_t getCount() const { return count; }
+    bool isBufferFull() const { return count == N; }
+
+    void reset() {
+        index = 0;
+        count = 0;
+        mean = 0;
+        m2 = 0;
+    }
+};
+
+template <size_t N, typename T = float>
+class SlidingMinMax {
+private:
+    struct Entry {
+        T value;
+        uint32_t position;
+    };
+
+    // Ring-buffer deque: minimum candidates ascend from the front, maximum
+    // candidates descend, so the front is always the answer
+    struct Deque {
+        Entry entries[N];
+        size_t head;
+        size_t size;
+
+        // i < 2N always, so a compare replaces the modulo
+        static size_t wrap(size_t i) { return i >= N ? i - N : i; }
+
+        Entry& front() { return entries[head]; }
+        const Entry& front() const { return entries[head]; }
+        Entry& back() { return entries[wrap(head + size - 1)]; }
+        void popFront() { head = wrap(head + 1); size--; }
+        void popBack() { size--; }
+        void pushBack(const Entry& entry) { entries[wrap(head + size)] = entry; size++; }
+    };
+
+    Deque minimum;
+    Deque maximum;
+    uint32_t position;
+
+public:
+    SlidingMinMax() { reset(); }
+
+    void addValue(T value) {
+        if (value != value) {
+            return;
+        }
+
+        // Drop entries that left the window
+        if (minimum.size > 0 && position - minimum.front().position >= N) {
+            minimum.popFront();
+        }
+        if (maximum.size > 0 && position - maximum.front().position >= N) {
+            maximum.popFront();
+        }
+        while (minimum.size > 0 && !(minimum.back().value < value)) {
+            minimum.popBack();
+        }
+        while (maximum.size > 0 && !(maximum.back().value > value)) {
+            maximum.popBack();
+        }
+        Entry entry = { value, position };
+        minimum.pushBack(entry);
+        maximum.pushBack(entry);
+        position++;
+    }
+
+    // T() before the first value
+    T getMin() const { return minimum.size > 0 ? minimum.front().value : T(); }
+    T getMax() const { return maximum.size > 0 ? maximum.front().value : T(); }
+    T getRange() const { return getMax() - getMin(); }
+
+    size_t getCount() const { return position < N ? position : N; }
+    bool isBufferFull() const { return position >= N; }
+
+    void reset() {
+        minimum.head = minimum.size = 0;
+        maximum.head = maximum.size = 0;
+        position = 0;
+    }
+};
+
+template <size_t N, typename T = float>
+class SlidingMedian {
+private:
+    T values[N];        // arrival order
+    T sorted[N];
+    size_t index;
+    size_t count;
+
+    // First slot in sorted[0, count) not less than value
+    size_t lowerBound(T value) const {
+        size_t low = 0;
+        size_t high = count;
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            if (sorted[mid] < value) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+public:
+    SlidingMedian() { reset(); }
+
+    void addValue(T value) {
+        if (value != value) {
+            return;
+        }
+
+        if (count == N) {
+            size_t slot = lowerBound(values[index]);
+            for (size_t i = slot; i + 1 < count; i++) {
+                sorted[i] = sorted[i + 1];
+            }
+            count--;
+        }
+        size_t slot = lowerBound(value);
+        for (size_t i = count; i > slot; i--) {
+            sorted[i] = sorted[i - 1];
+        }
+        sorted[slot] = value;
+        count++;
+
+        values[index] = value;
+        index = (index + 1) % N;
+    }
+
+    // Mean of the middle pair for an even count; T() before the first value
+    T getMedian() const {
+        if (count == 0) {
+            return T();
+        }
+        if (count % 2 == 1) {
+            return sorted[count / 2];
+        }
+        return sorted[count / 2 - 1] + (sorted[count / 2] - sorted[count / 2 - 1]) / 2;
+    }
+
+    // k-th smallest value in the window, 0-based
+    T getOrdered(size_t k) const { return sorted[k]; }
+
+    size_t getCount() const { return count; }
+    bool isBufferFull() const { return count == N; }
+
+    void reset() {
+        index = 0;
+        count = 0;
+    }
+};
+
+class Ewma {
+private:
+    float alpha;
+    float value;
+    bool primed;
+
+public:
+    // alpha: weight of each new value, 0..1
+    explicit Ewma(float weight = 1.0f) : alpha(weight), value(0), primed(false) {}
+
+    // Alpha giving a time constant of `seconds` at `sampleRate`
+    static float alphaFor(float seconds, float sampleRate) {
+        return 1.0f - expf(-1.0f / (seconds * sampleRate));
+    }
+
+    // The first value primes the average
+    float addValue(float x) {
+        if (isnan(x)) {
+            return getValue();
+        }
+        if (!primed) {
+            value = x;
+            primed = true;
+        } else {
+            value += alpha * (x - value);
+        }
+        return value;
+    }
+
+    // Overwrite the average, e.g. to clamp it or start from a known value
+    void prime(float x) {
+        value = x;
+        primed = true;
+    }
+
+    // NAN before the first value
+    float getValue() const { return primed ? value : NAN; }
+    bool isPrimed() const { return primed; }
+
+    void setAlpha(float weight) { alpha = weight; }
+    float getAlpha() const { return alpha; }
+
+    void reset() {
+        value = 0;
+        primed = false;
+    }
+};
+
+// Welford's online mean/variance: O(1) per sample, no sample storage, and
+// numerically stable where sum/sum-of-squares would cancel
+class RunningStats {
+private:
+    unsigned long count;
+    double mean;
+    double m2;
+
+public:
+    RunningStats() : count(0), mean(0), m2(0) {}
+
+    void addValue(float value) {
+        if (isnan(value)) {
+            return;
+        }
+
+        count++;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+    }
+
+    unsigned long getCount() const {
+        return count;
+    }
+
+    float getMean() const {
+        return mean;
+    }
+
+    // Sample variance (n - 1)
+    float getVariance() const {
+        return count > 1 ? m2 / (count - 1) : 0;
+    }
+
+    float getStdDev() const {
+        return sqrt(getVariance());
+    }
+
+    // Standard error of the mean
+    float getStdError() const {
+        return count > 1 ? sqrt(getVariance() / count) : INFINITY;
+    }
+
+    void reset() {
+        count = 0;
+        mean = 0;
+        m2 = 0;
+    }
+};
+
+#endif